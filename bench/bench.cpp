@@ -0,0 +1,377 @@
+#include "corpus.hpp"
+#include "aliasmanager.hpp"
+#include "aliasscanner.hpp"
+#include "aliassearch.hpp"
+#include "aliasstore.hpp"
+#include "backupmanager.hpp"
+#include "configfilehandler.hpp"
+#include "historyusage.hpp"
+#include "mappedfile.hpp"
+#include "parsecache.hpp"
+#include "pathindex.hpp"
+#include "suggestionminer.hpp"
+#include "syntaxchecker.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// alia-can-bench [--sizes 1000,10000,100000] [--rounds N] [--filter TEXT] [--json FILE]
+//                [--baseline FILE] [--tolerance 0.15]
+// Runs every case against a generated rc file of each size and prints the median, min and max per case. With
+// --json the results are also written one case per line, and with --baseline they are compared to an earlier
+// --json file: a case whose median got slower by more than the tolerance is reported and the exit status is 1.
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); }
+
+// The line parser the scanner replaced, kept verbatim as the baseline for `scan`: first-quote matching, one
+// definition per line, 5-character keyword prefix.
+static AliasView legacyParse(std::string_view line) {
+    AliasView result;
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string_view::npos || line.substr(start, 5) != "alias") return result;
+    size_t eqPos = line.find('=', start + 5);
+    if (eqPos == std::string_view::npos) return result;
+    std::string_view namePart = line.substr(start + 5, eqPos - start - 5);
+    size_t nameStart = namePart.find_first_not_of(" \t");
+    size_t nameEnd = namePart.find_last_not_of(" \t");
+    if (nameStart == std::string_view::npos) return result;
+    result.name = namePart.substr(nameStart, nameEnd - nameStart + 1);
+    std::string_view commandPart = line.substr(eqPos + 1);
+    size_t cmdStart = commandPart.find_first_not_of(" \t");
+    if (cmdStart == std::string_view::npos) return result;
+    if (commandPart[cmdStart] == '\'' || commandPart[cmdStart] == '"') {
+        char quote = commandPart[cmdStart];
+        size_t endQuote = commandPart.find(quote, cmdStart + 1);
+        result.command = endQuote != std::string_view::npos ? commandPart.substr(cmdStart + 1, endQuote - cmdStart - 1) : commandPart.substr(cmdStart + 1);
+    } else {
+        size_t commentPos = commandPart.find('#');
+        std::string_view command = commandPart.substr(cmdStart, commentPos == std::string_view::npos ? std::string_view::npos : commentPos - cmdStart);
+        size_t end = command.find_last_not_of(" \t");
+        result.command = end != std::string_view::npos ? command.substr(0, end + 1) : command;
+    }
+    return result;
+}
+static size_t legacyScan(std::string_view buffer, size_t& bytes) {
+    const char* const begin = buffer.data();
+    const char* const end = begin + buffer.size();
+    const char* cursor = begin;
+    const char* counted = begin;
+    size_t lineNumber = 1;
+    size_t found = 0;
+    while (cursor < end) {
+        auto* hit = static_cast<const char*>(memmem(cursor, end - cursor, "alias", 5));
+        if (hit == nullptr) break;
+        const char* lineStart = hit;
+        while (lineStart > begin && lineStart[-1] != '\n') --lineStart;
+        auto* newline = static_cast<const char*>(std::memchr(hit, '\n', end - hit));
+        const char* lineEnd = newline != nullptr ? newline : end;
+        cursor = newline != nullptr ? newline + 1 : end;
+        if (!std::all_of(lineStart, hit, [](char c) { return c == ' ' || c == '\t'; })) continue;
+        lineNumber += std::count(counted, lineStart, '\n');
+        counted = lineStart;
+        AliasView view = legacyParse(std::string_view(lineStart, lineEnd - lineStart));
+        if (view.name.empty()) continue;
+        bytes += view.name.size() + view.command.size() + lineNumber;
+        ++found;
+    }
+    return found;
+}
+
+struct Options {
+    std::vector<size_t> sizes{1000, 10000, 100000};
+    int rounds = 7;
+    std::string filter;
+    std::string jsonPath;
+    std::string baselinePath;
+    double tolerance = 0.15;
+};
+struct Result {
+    std::string name;
+    size_t lines = 0;
+    size_t items = 0;
+    int rounds = 0;
+    double minMs = 0;
+    double medianMs = 0;
+    double maxMs = 0;
+};
+
+// A case runs once untimed to warm up, then `rounds` times; each run returns the milliseconds of the part it
+// measures, so cases that need untimed setup or undo around the measured call can keep it out of the number.
+class Runner {
+public:
+    explicit Runner(const Options& options) : options(options) {}
+    void run(const std::string& name, size_t lines, size_t items, const std::function<double()>& once, int rounds = 0) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+        rounds = rounds > 0 ? std::min(rounds, options.rounds) : options.rounds;
+        once();
+        std::vector<double> samples;
+        for (int i = 0; i < rounds; ++i) samples.push_back(once());
+        std::sort(samples.begin(), samples.end());
+        Result result{name, lines, items, rounds, samples.front(), samples[samples.size() / 2], samples.back()};
+        std::cout << std::left << std::setw(20) << name << std::right << std::setw(9) << lines << std::setw(9) << items << std::fixed << std::setprecision(3) << std::setw(12) << result.medianMs << std::setw(12) << result.minMs << std::setw(12) << result.maxMs << '\n';
+        results.push_back(std::move(result));
+    }
+    const std::vector<Result>& getResults() const { return results; }
+private:
+    const Options& options;
+    std::vector<Result> results;
+};
+
+static bool writeJson(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream out(path, std::ios::trunc);
+    out << "{\"benchmark\":\"alia-can\",\"version\":1,\"results\":[\n" << std::fixed << std::setprecision(4);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "{\"name\":\"" << r.name << "\",\"lines\":" << r.lines << ",\"items\":" << r.items << ",\"rounds\":" << r.rounds << ",\"min_ms\":" << r.minMs << ",\"median_ms\":" << r.medianMs << ",\"max_ms\":" << r.maxMs << '}' << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+    return static_cast<bool>(out);
+}
+// Reads back what writeJson produced: one result object per line.
+static std::map<std::pair<std::string, size_t>, double> readBaseline(const std::string& path) {
+    std::map<std::pair<std::string, size_t>, double> medians;
+    std::ifstream in(path);
+    std::string line;
+    auto field = [&](std::string_view key) -> std::string {
+        size_t at = line.find("\"" + std::string(key) + "\":");
+        if (at == std::string::npos) return {};
+        at += key.size() + 3;
+        if (line[at] == '"') return line.substr(at + 1, line.find('"', at + 1) - at - 1);
+        return line.substr(at, line.find_first_of(",}", at) - at);
+    };
+    while (std::getline(in, line)) {
+        std::string name = field("name"), lines = field("lines"), median = field("median_ms");
+        if (!name.empty() && !lines.empty() && !median.empty()) medians[{name, std::stoull(lines)}] = std::stod(median);
+    }
+    return medians;
+}
+// Differences under 20 µs are timer noise at these sizes, whatever the ratio says.
+static int compareBaseline(const std::vector<Result>& results, const std::string& path, double tolerance) {
+    auto baseline = readBaseline(path);
+    if (baseline.empty()) {
+        std::cerr << "No results in baseline " << path << '\n';
+        return 2;
+    }
+    int regressions = 0;
+    std::cout << "\ncase                    lines    baseline     current   change\n";
+    for (const Result& r : results) {
+        auto it = baseline.find({r.name, r.lines});
+        if (it == baseline.end()) continue;
+        double change = it->second > 0 ? r.medianMs / it->second - 1 : 0;
+        bool regressed = change > tolerance && r.medianMs - it->second > 0.02;
+        regressions += regressed;
+        std::cout << std::left << std::setw(20) << r.name << std::right << std::setw(9) << r.lines << std::fixed << std::setprecision(3) << std::setw(12) << it->second << std::setw(12) << r.medianMs << std::setw(8) << std::setprecision(1) << change * 100 << '%' << (regressed ? "  REGRESSION" : "") << '\n';
+    }
+    std::cout << regressions << " regression(s) over " << std::setprecision(0) << tolerance * 100 << "%\n";
+    return regressions > 0 ? 1 : 0;
+}
+
+static void benchSize(Runner& runner, const fs::path& root, size_t lines) {
+    Corpus::Stats stats;
+    const std::string corpus = Corpus::generate(lines, 42, &stats);
+    const fs::path dir = root / std::to_string(lines);
+    fs::create_directories(dir);
+    const std::string rc = (dir / ".bashrc").string();
+    std::ofstream(rc, std::ios::trunc) << corpus;
+    size_t sink = 0;
+
+    size_t scanned = AliasScanner::scan(corpus, [](const ScannedAlias&) {});
+    runner.run("scan", lines, scanned, [&] {
+        auto start = Clock::now();
+        AliasScanner::scan(corpus, [&](const ScannedAlias& a) { sink += a.alias.name.size() + a.alias.command.size() + a.line; });
+        return since(start);
+    });
+    runner.run("scan-legacy", lines, scanned, [&] {
+        auto start = Clock::now();
+        legacyScan(corpus, sink);
+        return since(start);
+    });
+    std::vector<std::string_view> aliasLines;
+    for (size_t begin = 0, end; begin < corpus.size(); begin = end + 1) {
+        end = corpus.find('\n', begin);
+        std::string_view line(corpus.data() + begin, end - begin);
+        if (AliasManager::isAliasLine(line)) aliasLines.push_back(line);
+    }
+    runner.run("parseAliasLine", lines, aliasLines.size(), [&] {
+        auto start = Clock::now();
+        for (std::string_view line : aliasLines) sink += AliasManager::parseAliasLine(line).command.size();
+        return since(start);
+    });
+
+    ConfigFileHandler handler(rc, ShellDetector::Shell::BASH);
+    const std::string cache = ParseCache::defaultPath();
+    AliasStore store = handler.loadAliases();
+    runner.run("loadAliases-cold", lines, store.size(), [&] {
+        fs::remove(cache);
+        auto start = Clock::now();
+        sink += handler.loadAliases().size();
+        return since(start);
+    });
+    handler.loadAliases();
+    runner.run("loadAliases-warm", lines, store.size(), [&] {
+        auto start = Clock::now();
+        sink += handler.loadAliases().size();
+        return since(start);
+    });
+    int serial = 0;
+    runner.run("addAlias", lines, 1, [&] {
+        std::string name = "bench_add_" + std::to_string(serial++);
+        auto start = Clock::now();
+        handler.addAlias(Alias{name, "git status --short"});
+        double ms = since(start);
+        handler.removeAlias(name);
+        return ms;
+    });
+    runner.run("removeAlias", lines, 1, [&] {
+        std::string name = "bench_rm_" + std::to_string(serial++);
+        handler.addAlias(Alias{name, "git status --short"});
+        auto start = Clock::now();
+        handler.removeAlias(name);
+        return since(start);
+    });
+
+    std::vector<size_t> rows;
+    for (const auto& alias : store) rows.push_back(alias.id);
+    AliasSearch index;
+    runner.run("search-build", lines, rows.size(), [&] {
+        auto start = Clock::now();
+        index.build(store, rows);
+        return since(start);
+    });
+    constexpr std::string_view queries[] = {"gst", "docker run", "ls -la", "zzzz", "l1"};
+    runner.run("search", lines, rows.size(), [&] {
+        auto start = Clock::now();
+        for (std::string_view query : queries) sink += index.search(query, AliasSearch::Mode::ALL).matches.size();
+        return since(start);
+    });
+    runner.run("search-narrowing", lines, rows.size(), [&] {
+        auto start = Clock::now();
+        auto previous = index.search("g", AliasSearch::Mode::ALL);
+        for (std::string_view query : {"gi", "git", "git l", "git lo"}) previous = index.search(query, AliasSearch::Mode::ALL, &previous);
+        sink += previous.matches.size();
+        return since(start);
+    });
+
+    // Keystroke checks against a warm coprocess; the GUI gives each one SyntaxChecker::KEYSTROKE_TIMEOUT.
+    constexpr size_t CHECKS = 50;
+    SyntaxChecker checker(ShellDetector::Shell::BASH, "", 1);
+    checker.warmUp();
+    runner.run("syntax-check", lines, CHECKS, [&] {
+        auto start = Clock::now();
+        for (size_t i = 0; i < CHECKS; ++i) sink += checker.check(Alias{"ll", "ls -la " + std::to_string(i)}, SyntaxChecker::BULK_TIMEOUT).message.size();
+        return since(start);
+    }, 3);
+
+    // Histories are usually much longer than rc files, so each size gets ten history lines per rc line.
+    const std::string history = (dir / ".zsh_history").string();
+    const std::string historyCache = (dir / "history-cache").string();
+    std::ofstream(history, std::ios::trunc) << Corpus::history(lines * 10);
+    runner.run("history-cold", lines, lines * 10, [&] {
+        fs::remove(historyCache);
+        HistoryUsage usage(ShellDetector::Shell::ZSH, history, historyCache);
+        auto start = Clock::now();
+        usage.update();
+        sink += usage.wordCount();
+        return since(start);
+    });
+    runner.run("history-append", lines, 100, [&] {
+        HistoryUsage usage(ShellDetector::Shell::ZSH, history, historyCache);
+        usage.update();
+        std::ofstream(history, std::ios::app) << Corpus::history(100, static_cast<uint32_t>(serial++));
+        auto start = Clock::now();
+        usage.update();
+        sink += usage.lastScannedBytes();
+        return since(start);
+    });
+    PathIndex noExecutables("");
+    runner.run("suggest", lines, lines * 10, [&] {
+        MappedFile file;
+        file.open(history);
+        auto start = Clock::now();
+        sink += SuggestionMiner(ShellDetector::Shell::ZSH).mine(file.view(), store, noExecutables).size();
+        return since(start);
+    });
+
+    // Backups run without compression so the background worker doesn't compete with the measured calls.
+    constexpr int KEEP = 10;
+    BackupManager backups(rc, (dir / "backups").string());
+    backups.setCompression(Compression::Codec::NONE);
+    backups.setMaxBackups(1000);
+    int edit = 0;
+    auto touch = [&] { std::ofstream(rc, std::ios::app) << "alias bench_edit_" << edit++ << "='true'\n"; };
+    runner.run("createBackup", lines, 1, [&] {
+        touch();
+        auto start = Clock::now();
+        backups.createBackup();
+        return since(start);
+    }, 5);
+    size_t listed = backups.listSnapshots().size();
+    runner.run("listBackups", lines, listed, [&] {
+        auto start = Clock::now();
+        sink += backups.listBackups().size();
+        return since(start);
+    });
+    runner.run("cleanupBackups", lines, KEEP, [&] {
+        while (backups.listSnapshots().size() < 2 * KEEP) {
+            touch();
+            backups.createBackup();
+        }
+        auto start = Clock::now();
+        backups.cleanupAndCompressOldBackups(KEEP);
+        return since(start);
+    }, 3);
+    if (sink == 0) std::cout << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg != "--sizes" && arg != "--rounds" && arg != "--filter" && arg != "--json" && arg != "--baseline" && arg != "--tolerance") {
+            std::cerr << "Unknown option: " << arg << '\n';
+            return 2;
+        }
+        if (value == nullptr) {
+            std::cerr << "Missing value for " << arg << '\n';
+            return 2;
+        }
+        if (arg == "--sizes") {
+            options.sizes.clear();
+            std::stringstream list(value);
+            for (std::string size; std::getline(list, size, ',');) options.sizes.push_back(std::stoull(size));
+        } else if (arg == "--rounds") options.rounds = std::max(1, std::atoi(value));
+        else if (arg == "--filter") options.filter = value;
+        else if (arg == "--json") options.jsonPath = value;
+        else if (arg == "--baseline") options.baselinePath = value;
+        else options.tolerance = std::atof(value);
+        ++i;
+    }
+    const fs::path root = fs::temp_directory_path() / "alia-can-bench";
+    fs::remove_all(root);
+    fs::create_directories(root);
+    setenv("XDG_CACHE_HOME", (root / "cache").c_str(), 1);
+    Runner runner(options);
+    std::cout << "case                    lines    items   median_ms      min_ms      max_ms\n";
+    for (size_t lines : options.sizes) benchSize(runner, root, lines);
+    BackupManager::waitForBackgroundWork();
+    fs::remove_all(root);
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, runner.getResults())) {
+        std::cerr << "Cannot write " << options.jsonPath << '\n';
+        return 2;
+    }
+    return options.baselinePath.empty() ? 0 : compareBaseline(runner.getResults(), options.baselinePath, options.tolerance);
+}
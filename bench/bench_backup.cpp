@@ -0,0 +1,60 @@
+#include "backupmanager.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+int main(int argc, char* argv[]) {
+    int lines = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int edits = argc > 2 ? std::atoi(argv[2]) : 1000;
+    int keyframeInterval = argc > 3 ? std::atoi(argv[3]) : 64;
+    fs::path root = fs::temp_directory_path() / "alia-can-bench-backup";
+    fs::remove_all(root);
+    fs::create_directories(root);
+    std::string config = (root / ".bashrc").string();
+    std::vector<std::string> content;
+    for (int i = 0; i < lines; ++i) content.push_back("alias a" + std::to_string(i) + "='ls -la --color=auto /srv/project/" + std::to_string(i) + "'\n");
+    auto writeConfig = [&] {
+        std::ofstream out(config, std::ios::trunc);
+        for (const auto& line : content) out << line;
+    };
+    BackupManager backups(config, (root / "backups").string());
+    backups.setKeyframeInterval(keyframeInterval);
+    backups.setMaxBackups(edits + 1);
+    std::mt19937 rng(42);
+    uint64_t naiveBytes = 0, editBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < edits; ++i) {
+        std::string& line = content[rng() % content.size()];
+        line = "alias e" + std::to_string(i) + "='git log --oneline -n " + std::to_string(i) + "'\n";
+        editBytes += line.size();
+        writeConfig();
+        naiveBytes += fs::file_size(config);
+        if (backups.createBackup().empty()) { std::cerr << backups.getLastError() << '\n'; return 1; }
+    }
+    double backupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    uint64_t storeBytes = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(root / "backups")) if (entry.is_regular_file()) storeBytes += entry.file_size();
+    std::map<size_t, std::pair<double, int>> restoreByChain;
+    for (const auto& snapshot : backups.listSnapshots()) {
+        auto restoreStart = std::chrono::steady_clock::now();
+        if (!backups.restoreFromBackup(snapshot.path)) { std::cerr << backups.getLastError() << '\n'; return 1; }
+        auto& [total, count] = restoreByChain[backups.getChainLength(snapshot.path)];
+        total += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - restoreStart).count();
+        ++count;
+    }
+    std::cout << "file: " << lines << " lines, " << fs::file_size(config) << " bytes; " << edits << " single-line edits; keyframe every " << keyframeInterval << "\n"
+              << "backup: " << std::fixed << std::setprecision(3) << backupMs / edits << " ms/edit\n"
+              << "store: " << storeBytes << " bytes (full copies: " << naiveBytes << ", edited bytes: " << editBytes << ", ratio " << std::setprecision(4) << double(storeBytes) / naiveBytes << ")\n"
+              << "chain\trestore_us\n";
+    for (const auto& [chain, stats] : restoreByChain) std::cout << chain << '\t' << std::setprecision(1) << stats.first / stats.second << '\n';
+    fs::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "corpus.hpp"
+#include <random>
+
+std::string Corpus::generate(size_t lines, uint32_t seed, Stats* stats) {
+    std::mt19937 rng(seed);
+    std::string out;
+    out.reserve(lines * 48);
+    Stats counted;
+    size_t next = 0;
+    auto name = [&](char prefix) { return prefix + std::to_string(next++); };
+    while (counted.lines < lines) {
+        const std::string n = std::to_string(counted.lines);
+        const unsigned pick = rng() % 100;
+        size_t produced = 1;
+        bool alias = true;
+        if (pick < 12) out += "alias " + name('l') + "='ls -la --color=auto /srv/project/" + n + "'\n";
+        else if (pick < 20) out += "  alias " + name('g') + "=\"git log --oneline -n " + n + " --author=\\\"$USER\\\"\" # recent\n";
+        else if (pick < 26) out += "alias " + name('p') + "=pwd\n";
+        else if (pick < 31) out += "alias " + name('q') + "='echo it'\\''s " + n + "'\n";
+        else if (pick < 35) out += "alias -- " + name('d') + "=\"docker run --rm -it -v \\\"$PWD\\\":/w img" + n + "\"\n";
+        else if (pick < 38) out += "alias " + name('m') + "='make -j8' " + name('m') + "='make clean'\n";
+        else if (pick < 40 && next > 0) out += "alias l" + std::to_string(rng() % next) + "='ls -lah " + n + "'\n";
+        else {
+            alias = false;
+            if (pick < 55) out += "export PATH_" + n + "=/opt/tool/" + n + "/bin:$PATH\n";
+            else if (pick < 65) out += pick % 2 ? "# alias commented" + n + "='not loaded'\n" : "# " + n + ": settings for the next block\n";
+            else if (pick < 75) {
+                out += "fn_" + n + "() {\n    local target=\"${1:-.}\"\n    grep -rn \"$2\" \"$target\" | head -n " + n + "\n}\n";
+                produced = 4;
+            } else if (pick < 83) {
+                out += "if [ -d /opt/" + n + " ]; then\n    PATH=/opt/" + n + ":$PATH\nfi\n";
+                produced = 3;
+            } else if (pick < 90) out += "\n";
+            else if (pick < 95) out += "HISTSIZE=" + n + "; shopt -s histappend\n";
+            else out += "bind '\"\\e[A\": history-search-backward' # " + n + "\n";
+        }
+        counted.lines += produced;
+        if (alias) ++counted.aliasStatements;
+    }
+    if (stats != nullptr) *stats = counted;
+    return out;
+}
+std::string Corpus::history(size_t lines, uint32_t seed, int64_t firstTimestamp) {
+    static constexpr const char* HOT[] = {"gs", "ll", "gd HEAD~1", "cd ..", "git push origin main", "make -j8", "vim src/main.cpp"};
+    std::mt19937 rng(seed);
+    std::string out;
+    out.reserve(lines * 40);
+    for (size_t line = 0; line < lines; ++line) {
+        const unsigned pick = rng() % 100;
+        out += ": " + std::to_string(firstTimestamp + static_cast<int64_t>(line) * 7) + ":" + std::to_string(pick % 4) + ";";
+        if (pick < 70) out += HOT[pick % std::size(HOT)];
+        else if (pick < 97) out += "tool" + std::to_string(rng() % 5000) + " --flag " + std::to_string(line);
+        else {
+            out += "for f in *.log; do \\\n  gzip \"$f\"\\\ndone";
+            line += 2;
+        }
+        out += '\n';
+    }
+    return out;
+}
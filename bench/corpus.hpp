@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Deterministic synthetic rc files: aliases in every quoting style the parser handles (single, double with
+// escapes, unquoted, '\'' splices, `alias --`, several per statement, trailing comments, redefinitions) mixed
+// with the noise real configs carry — exports, functions, if blocks, comments, blank lines and other commands.
+// The same line count and seed always give byte-identical output, so runs stay comparable.
+class Corpus {
+public:
+    struct Stats {
+        size_t lines = 0;
+        size_t aliasStatements = 0;
+    };
+    static std::string generate(size_t lines, uint32_t seed = 42, Stats* stats = nullptr);
+    // A zsh EXTENDED_HISTORY file: a few hot commands, a long tail of rare ones and the odd multi-line entry.
+    static std::string history(size_t lines, uint32_t seed = 42, int64_t firstTimestamp = 1700000000);
+};
@@ -0,0 +1,34 @@
+#include "aliasfiltermodel.hpp"
+
+AliasFilterModel::AliasFilterModel(QObject* parent) : QSortFilterProxyModel(parent) {}
+
+void AliasFilterModel::setMatches(const std::vector<AliasSearch::Match>& matches) {
+    ranks.assign(sourceModel() ? static_cast<size_t>(sourceModel()->rowCount()) : 0, -1);
+    for (size_t rank = 0; rank < matches.size(); ++rank) {
+        if (matches[rank].row < ranks.size()) ranks[matches[rank].row] = static_cast<int>(rank);
+    }
+    active = true;
+    invalidate();
+    if (sortColumn() != 0) sort(0);
+}
+
+void AliasFilterModel::clearMatches() {
+    if (!active) return;
+    ranks.clear();
+    active = false;
+    invalidate();
+    sort(-1);
+}
+
+bool AliasFilterModel::isFiltering() const { return active; }
+
+bool AliasFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex&) const {
+    // Rows appended after the last search stay hidden until it is re-run against the new aliases.
+    return !active || (static_cast<size_t>(sourceRow) < ranks.size() && ranks[static_cast<size_t>(sourceRow)] >= 0);
+}
+
+bool AliasFilterModel::lessThan(const QModelIndex& left, const QModelIndex& right) const {
+    if (!active) return left.row() < right.row();
+    auto rank = [this](int row) { return static_cast<size_t>(row) < ranks.size() ? ranks[static_cast<size_t>(row)] : -1; };
+    return rank(left.row()) < rank(right.row());
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QSortFilterProxyModel>
+#include <vector>
+#include "aliassearch.hpp"
+
+class AliasFilterModel : public QSortFilterProxyModel {
+    Q_OBJECT
+
+public:
+    explicit AliasFilterModel(QObject* parent = nullptr);
+    void setMatches(const std::vector<AliasSearch::Match>& matches);
+    void clearMatches();
+    bool isFiltering() const;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+
+private:
+    std::vector<int> ranks;
+    bool active = false;
+};
@@ -1,4 +1,6 @@
 #include "aliasmanager.hpp"
+#include "aliasparser.hpp"
+#include "fishparser.hpp"
 #include <algorithm>
 #include <cctype>
 #include <sstream>
@@ -15,73 +17,48 @@ bool AliasManager::validateCommand(const std::string& command) {
     return !command.empty() && command.length() <= 2048;
 }
 std::string AliasManager::formatAlias(const Alias& alias) const {
-    if (alias.command.find('\'') != std::string::npos) {
-        return "alias " + alias.name + "=\"" + alias.command + "\"";
-    }
-    return "alias " + alias.name + "='" + alias.command + "'";
+    return "alias " + formatDefinition(alias);
+}
+// The part of an alias statement after the keyword: `name='cmd'` for POSIX shells, `name 'cmd'` for fish.
+std::string AliasManager::formatDefinition(const Alias& alias) const {
+    if (currentShell == ShellDetector::Shell::FISH) return alias.name + " " + FishParser::quote(alias.command);
+    return alias.name + "=" + escapeCommand(alias.command);
+}
+// Undoes a definition made earlier in the shell's startup, quietly when there is none (the file that made it may
+// be missing on another machine).
+std::string AliasManager::formatUnalias(const std::string& name) const {
+    const bool fish = currentShell == ShellDetector::Shell::FISH;
+    std::string quoted = validateAliasName(name) ? name : fish ? FishParser::quote(name) : escapeCommand(name);
+    return fish ? "functions --erase " + quoted : "unalias " + quoted + " 2>/dev/null";
 }
-Alias AliasManager::parseAliasLine(const std::string& line) {
-    Alias result;
+Alias AliasManager::parseAliasLine(std::string_view line) {
     size_t start = line.find_first_not_of(" \t");
-    if (start == std::string::npos || line.substr(start, 5) != "alias") return result;
-    size_t eqPos = line.find('=', start + 5);
-    if (eqPos == std::string::npos) return result;
-    std::string namePart = line.substr(start + 5, eqPos - start - 5);
-    size_t nameStart = namePart.find_first_not_of(" \t");
-    size_t nameEnd = namePart.find_last_not_of(" \t");
-    if (nameStart == std::string::npos) return result;
-    result.name = namePart.substr(nameStart, nameEnd - nameStart + 1);
-    std::string commandPart = line.substr(eqPos + 1);
-    size_t cmdStart = commandPart.find_first_not_of(" \t");
-    if (cmdStart == std::string::npos) return result;
-    if (commandPart[cmdStart] == '\'' || commandPart[cmdStart] == '"') {
-        char quote = commandPart[cmdStart];
-        size_t endQuote = commandPart.find(quote, cmdStart + 1);
-        result.command = endQuote != std::string::npos ?
-        commandPart.substr(cmdStart + 1, endQuote - cmdStart - 1) :
-        commandPart.substr(cmdStart + 1);
-    } else {
-        size_t commentPos = commandPart.find('#');
-        result.command = commandPart.substr(cmdStart, commentPos - cmdStart);
-        size_t end = result.command.find_last_not_of(" \t");
-        if (end != std::string::npos) result.command.resize(end + 1);
-    }
-    return result;
+    AliasParser parser(line);
+    if (start == std::string_view::npos || !parser.parse(start) || parser.definitions().empty()) return {};
+    const auto& definition = parser.definitions().front();
+    return Alias{std::string(definition.name), std::string(definition.command)};
 }
-bool AliasManager::isAliasLine(const std::string& line) {
+bool AliasManager::isAliasLine(std::string_view line) {
     size_t start = line.find_first_not_of(" \t");
-    return start != std::string::npos && line.substr(start, 5) == "alias";
+    return start != std::string_view::npos && AliasParser::isKeyword(line.substr(start));
 }
 ShellDetector::Shell AliasManager::getShell() const { return currentShell; }
 void AliasManager::setShell(ShellDetector::Shell shell) { currentShell = shell; }
 std::string AliasManager::extractQuotedString(const std::string& str, size_t start) {
-    if (start >= str.length()) return "";
-    char quote = str[start];
-    size_t end = str.find(quote, start + 1);
-    return end == std::string::npos ? str.substr(start + 1) : str.substr(start + 1, end - start - 1);
+    return start < str.length() ? AliasParser::decodeWord(std::string_view(str).substr(start)) : "";
 }
+// Quotes a command as a single shell word that AliasParser decodes back to exactly the same bytes: double
+// quotes when that needs no escaping (keeps `alias x="echo 'hi'"` readable), single quotes otherwise.
 std::string AliasManager::escapeCommand(const std::string& command) {
+    if (command.find('\'') != std::string::npos && command.find_first_of("\"$`\\!") == std::string::npos) return "\"" + command + "\"";
     std::string escaped;
-    escaped.reserve(command.length() * 2);
+    escaped.reserve(command.length() + 2);
+    escaped += '\'';
     for (char c : command) {
-        if (c == '\'' || c == '"' || c == '\\' || c == '$') escaped += '\\';
-        escaped += c;
+        if (c == '\'') escaped += "'\\''";
+        else escaped += c;
     }
+    escaped += '\'';
     return escaped;
 }
-std::string AliasManager::unescapeString(const std::string& str) {
-    std::string unescaped;
-    unescaped.reserve(str.length());
-    bool prevBackslash = false;
-    for (char c : str) {
-        if (prevBackslash) {
-            unescaped += c;
-            prevBackslash = false;
-        } else if (c == '\\') {
-            prevBackslash = true;
-        } else {
-            unescaped += c;
-        }
-    }
-    return unescaped;
-}
+std::string AliasManager::unescapeString(const std::string& str) { return AliasParser::decodeWord(str); }
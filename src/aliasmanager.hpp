@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include "shelldetector.hpp"
 
 struct Alias {
@@ -9,14 +10,21 @@ struct Alias {
         return name == other.name && command == other.command;
     }
 };
+struct AliasView {
+    std::string_view name;
+    std::string_view command;
+    Alias materialize() const { return Alias{std::string(name), std::string(command)}; }
+};
 class AliasManager {
 public:
     explicit AliasManager(ShellDetector::Shell shell);
     static bool validateAliasName(const std::string& name);
     static bool validateCommand(const std::string& command);
     std::string formatAlias(const Alias& alias) const;
-    static Alias parseAliasLine(const std::string& line);
-    static bool isAliasLine(const std::string& line);
+    std::string formatDefinition(const Alias& alias) const;
+    std::string formatUnalias(const std::string& name) const;
+    static Alias parseAliasLine(std::string_view line);
+    static bool isAliasLine(std::string_view line);
     ShellDetector::Shell getShell() const;
     void setShell(ShellDetector::Shell shell);
     static std::string extractQuotedString(const std::string& str, size_t start);
@@ -0,0 +1,361 @@
+#include "aliasparser.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+static bool isOperator(char c) { return c == ';' || c == '&' || c == '|' || c == '(' || c == ')' || c == '<' || c == '>' || c == '`'; }
+static constexpr unsigned char BREAK = 1;
+static constexpr unsigned char QUOTING = 2;
+static constexpr auto CHAR_CLASS = [] {
+    std::array<unsigned char, 256> table{};
+    for (unsigned char c : std::string_view(" \t\r\n;&|()<>`")) table[c] = BREAK;
+    for (unsigned char c : std::string_view("'\"$\\")) table[c] = QUOTING;
+    return table;
+}();
+static bool isPlain(char c) { return CHAR_CLASS[static_cast<unsigned char>(c)] == 0; }
+// Inside "..." a backslash only escapes these (and newline); before anything else it is literal.
+static bool isDoubleQuoteEscape(char c) { return c == '$' || c == '`' || c == '"' || c == '\\'; }
+static int hexValue(char c) { return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1; }
+
+AliasParser::AliasParser(std::string_view buffer) : buffer(buffer) {}
+bool AliasParser::isKeyword(std::string_view text) {
+    return text.starts_with(KEYWORD) && (text.size() == KEYWORD.size() || isBlank(text[KEYWORD.size()]) || text[KEYWORD.size()] == '\n');
+}
+const std::vector<AliasParser::Definition>& AliasParser::definitions() const { return parsed; }
+size_t AliasParser::prefixEnd() const { return prefix; }
+size_t AliasParser::end() const { return statementEnd; }
+void AliasParser::write(const char* from, size_t length) {
+    if (length == 0) return;
+    if (used + length > scratch.size()) scratch.resize(std::max(scratch.size() * 2, used + length + 256));
+    std::memcpy(scratch.data() + used, from, length);
+    used += length;
+}
+void AliasParser::put(Word& word, bool splitAssignment, const char* from, size_t length) {
+    if (splitAssignment && !word.assignment) {
+        if (auto* equals = static_cast<const char*>(std::memchr(from, '=', length))) {
+            // A name that arrived in one piece can be viewed in place rather than through the scratch copy.
+            if (used == word.begin) word.rawName = from;
+            write(from, static_cast<size_t>(equals - from));
+            word.nameEnd = used;
+            word.assignment = true;
+            length -= static_cast<size_t>(equals + 1 - from);
+            from = equals + 1;
+        }
+    }
+    write(from, length);
+}
+void AliasParser::put(Word& word, char c) { put(word, false, &c, 1); }
+size_t AliasParser::decodeAnsiEscape(size_t pos, Word& word) {
+    char c = buffer[pos];
+    switch (c) {
+        case 'n': put(word, '\n'); return pos + 1;
+        case 't': put(word, '\t'); return pos + 1;
+        case 'r': put(word, '\r'); return pos + 1;
+        case 'a': put(word, '\a'); return pos + 1;
+        case 'b': put(word, '\b'); return pos + 1;
+        case 'f': put(word, '\f'); return pos + 1;
+        case 'v': put(word, '\v'); return pos + 1;
+        case 'e': case 'E': put(word, '\x1b'); return pos + 1;
+        case '\\': case '\'': case '"': case '?': put(word, c); return pos + 1;
+        case 'c':
+            if (pos + 1 < buffer.size()) {
+                put(word, static_cast<char>(buffer[pos + 1] & 0x1f));
+                return pos + 2;
+            }
+            break;
+        case 'x': case 'u': case 'U': {
+            size_t limit = c == 'x' ? 2 : c == 'u' ? 4 : 8, digits = 0;
+            uint32_t value = 0;
+            while (digits < limit && pos + 1 + digits < buffer.size() && hexValue(buffer[pos + 1 + digits]) >= 0) value = value * 16 + static_cast<uint32_t>(hexValue(buffer[pos + 1 + digits++]));
+            if (digits == 0) break;
+            if (c == 'x' || value < 0x80) {
+                put(word, static_cast<char>(value));
+            } else {
+                char utf8[4];
+                size_t length = value < 0x800 ? 2 : value < 0x10000 ? 3 : 4;
+                for (size_t i = length - 1; i > 0; --i, value >>= 6) utf8[i] = static_cast<char>(0x80 | (value & 0x3f));
+                utf8[0] = static_cast<char>((length == 2 ? 0xc0 : length == 3 ? 0xe0 : 0xf0) | value);
+                for (size_t i = 0; i < length; ++i) put(word, utf8[i]);
+            }
+            return pos + 1 + digits;
+        }
+        default:
+            if (c >= '0' && c <= '7') {
+                size_t digits = 0;
+                unsigned value = 0;
+                while (digits < 3 && pos + digits < buffer.size() && buffer[pos + digits] >= '0' && buffer[pos + digits] <= '7') value = value * 8 + static_cast<unsigned>(buffer[pos + digits++] - '0');
+                put(word, static_cast<char>(value));
+                return pos + digits;
+            }
+            break;
+    }
+    put(word, '\\');
+    put(word, c);
+    return pos + 1;
+}
+size_t AliasParser::findEither(size_t from, char first, char second) const {
+    const char* data = buffer.data();
+    auto* hit = static_cast<const char*>(std::memchr(data + from, first, buffer.size() - from));
+    size_t limit = hit != nullptr ? static_cast<size_t>(hit - data) : buffer.size();
+    auto* other = static_cast<const char*>(std::memchr(data + from, second, limit - from));
+    return other != nullptr ? static_cast<size_t>(other - data) : limit;
+}
+size_t AliasParser::readWord(size_t pos, Word& word, bool splitAssignment) {
+    const size_t size = buffer.size();
+    const char* const data = buffer.data();
+    word = Word{used, used, used, nullptr, false};
+    State state = State::UNQUOTED;
+    size_t quoteStart = 0;
+    Word atQuote;
+    size_t usedAtQuote = 0;
+    auto openQuote = [&](State quoted, size_t at) {
+        state = quoted;
+        quoteStart = at;
+        atQuote = word;
+        usedAtQuote = used;
+    };
+    // Runs of characters that need no unquoting are copied into the scratch buffer with one memcpy, so a quoted
+    // command costs a memchr for the closing quote rather than per-character dispatch.
+    size_t i = pos;
+    while (i < size) {
+        size_t run = i;
+        switch (state) {
+            case State::UNQUOTED: {
+                while (i < size && isPlain(data[i])) ++i;
+                put(word, splitAssignment, data + run, i - run);
+                if (i == size) break;
+                char c = data[i];
+                if (CHAR_CLASS[static_cast<unsigned char>(c)] == BREAK) {
+                    word.end = used;
+                    return i;
+                }
+                if (c == '\'') {
+                    openQuote(State::SINGLE, i++);
+                } else if (c == '"') {
+                    openQuote(State::DOUBLE, i++);
+                } else if (c == '$') {
+                    if (i + 1 < size && data[i + 1] == '\'') {
+                        openQuote(State::ANSI_C, i + 1);
+                        i += 2;
+                    } else {
+                        put(word, splitAssignment, data + i, 1);
+                        ++i;
+                    }
+                } else if (i + 1 < size) {
+                    if (data[i + 1] == '\n') i += 2;
+                    else if (data[i + 1] == '\r' && i + 2 < size && data[i + 2] == '\n') i += 3;
+                    else {
+                        put(word, splitAssignment, data + i + 1, 1);
+                        i += 2;
+                    }
+                } else {
+                    ++i;
+                }
+                break;
+            }
+            case State::SINGLE: {
+                auto* quote = static_cast<const char*>(std::memchr(data + i, '\'', size - i));
+                i = quote != nullptr ? static_cast<size_t>(quote - data) : size;
+                put(word, splitAssignment, data + run, i - run);
+                if (i < size) {
+                    state = State::UNQUOTED;
+                    ++i;
+                }
+                break;
+            }
+            case State::DOUBLE:
+                i = findEither(i, '"', '\\');
+                put(word, splitAssignment, data + run, i - run);
+                if (i == size) break;
+                if (data[i] == '"') {
+                    state = State::UNQUOTED;
+                    ++i;
+                } else if (i + 1 < size && (isDoubleQuoteEscape(data[i + 1]) || data[i + 1] == '\n')) {
+                    if (data[i + 1] != '\n') put(word, splitAssignment, data + i + 1, 1);
+                    i += 2;
+                } else {
+                    put(word, splitAssignment, data + i, 1);
+                    ++i;
+                }
+                break;
+            case State::ANSI_C:
+                i = findEither(i, '\'', '\\');
+                put(word, splitAssignment, data + run, i - run);
+                if (i == size) break;
+                if (data[i] == '\'') {
+                    state = State::UNQUOTED;
+                    ++i;
+                } else if (i + 1 < size) {
+                    i = decodeAnsiEscape(i + 1, word);
+                } else {
+                    put(word, splitAssignment, data + i, 1);
+                    ++i;
+                }
+                break;
+        }
+    }
+    if (state == State::UNQUOTED) {
+        word.end = used;
+        return i;
+    }
+    // A quote left open at the end of the buffer would swallow the rest of the file; take the rest of its line
+    // literally instead, like the line-based parser always did, so one typo doesn't hide every later alias.
+    word = atQuote;
+    used = usedAtQuote;
+    auto* newline = static_cast<const char*>(std::memchr(data + quoteStart, '\n', size - quoteStart));
+    size_t lineEnd = newline != nullptr ? static_cast<size_t>(newline - data) : size;
+    size_t contentEnd = lineEnd > quoteStart + 1 && data[lineEnd - 1] == '\r' ? lineEnd - 1 : lineEnd;
+    put(word, splitAssignment, data + quoteStart + 1, std::max(contentEnd, quoteStart + 1) - quoteStart - 1);
+    word.end = used;
+    return lineEnd;
+}
+// Straight-line path for the shapes nearly every rc file uses: one `name='...'` (including the `'\''` joins
+// escapeCommand writes), `name="..."` with backslash escapes, or `name=word`, then the end of the line or a
+// comment. Anything else goes through the state machine in parse(), which produces the same result for these.
+bool AliasParser::parseSimple(size_t pos) {
+    const char* const data = buffer.data();
+    const char* const end = data + buffer.size();
+    const char* p = data + pos;
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    const char* name = p;
+    while (p < end && isPlain(*p) && *p != '=') ++p;
+    if (p == name || p == end || *p != '=' || *name == '-' || *name == '#') return false;
+    const char* nameEnd = p++;
+    std::string_view value;
+    if (p < end && *p == '\'') {
+        const char* start = ++p;
+        p = static_cast<const char*>(std::memchr(p, '\'', static_cast<size_t>(end - p)));
+        if (p == nullptr) return false;
+        value = std::string_view(start, static_cast<size_t>(p++ - start));
+        if (end - p >= 3 && p[0] == '\\' && p[1] == '\'' && p[2] == '\'') {
+            size_t length = value.size();
+            const char* piece = p;
+            while (end - piece >= 3 && piece[0] == '\\' && piece[1] == '\'' && piece[2] == '\'') {
+                const char* close = static_cast<const char*>(std::memchr(piece + 3, '\'', static_cast<size_t>(end - piece - 3)));
+                if (close == nullptr) return false;
+                length += 1 + static_cast<size_t>(close - piece - 3);
+                piece = close + 1;
+            }
+            if (scratch.size() < length) scratch.resize(length + 256);
+            char* out = scratch.data();
+            for (const char* c = start; c < piece - 1; ++c) {
+                if (*c == '\'') c += 3;
+                *out++ = *c;
+            }
+            used = length;
+            value = std::string_view(scratch.data(), used);
+            p = piece;
+        }
+    } else if (p < end && *p == '"') {
+        const char* start = ++p;
+        // The closing quote is the first one preceded by an even run of backslashes.
+        const char* close = start;
+        for (;;) {
+            close = static_cast<const char*>(std::memchr(close, '"', static_cast<size_t>(end - close)));
+            if (close == nullptr) return false;
+            const char* slash = close;
+            while (slash > start && slash[-1] == '\\') --slash;
+            if ((close - slash) % 2 == 0) break;
+            ++close;
+        }
+        if (std::memchr(start, '\\', static_cast<size_t>(close - start)) == nullptr) {
+            value = std::string_view(start, static_cast<size_t>(close - start));
+        } else {
+            if (scratch.size() < static_cast<size_t>(close - start)) scratch.resize(static_cast<size_t>(close - start) + 256);
+            char* out = scratch.data();
+            for (const char* c = start; c < close; ++c) {
+                if (*c == '\\') {
+                    if (c[1] == '\n') return false;
+                    if (isDoubleQuoteEscape(c[1])) ++c;
+                }
+                *out++ = *c;
+            }
+            used = static_cast<size_t>(out - scratch.data());
+            value = std::string_view(scratch.data(), used);
+        }
+        p = close + 1;
+    } else {
+        const char* start = p;
+        while (p < end && isPlain(*p)) ++p;
+        value = std::string_view(start, static_cast<size_t>(p - start));
+    }
+    const char* wordEnd = p;
+    while (p < end && isBlank(*p)) ++p;
+    if (p < end && *p == '#' && p > wordEnd) p = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    if (p == nullptr) p = end;
+    if (p < end && *p != '\n') return false;
+    prefix = static_cast<size_t>(name - data);
+    statementEnd = p < end ? static_cast<size_t>(p - data) + 1 : buffer.size();
+    parsed.push_back(Definition{std::string_view(name, static_cast<size_t>(nameEnd - name)), value, prefix, static_cast<size_t>(wordEnd - name)});
+    return true;
+}
+bool AliasParser::parse(size_t keyword) {
+    parsed.clear();
+    words.clear();
+    used = 0;
+    if (keyword > buffer.size() || !isKeyword(buffer.substr(keyword))) return false;
+    if (parseSimple(keyword + KEYWORD.size())) return true;
+    const size_t size = buffer.size();
+    size_t i = keyword + KEYWORD.size();
+    bool options = true;
+    prefix = std::string_view::npos;
+    statementEnd = size;
+    while (i < size) {
+        char c = buffer[i];
+        if (isBlank(c)) {
+            ++i;
+            continue;
+        }
+        if (c == '\\' && i + 1 < size && buffer[i + 1] == '\n') {
+            i += 2;
+            continue;
+        }
+        if (c == '\n') {
+            statementEnd = i + 1;
+            break;
+        }
+        if (c == '#') {
+            const char* newline = static_cast<const char*>(std::memchr(buffer.data() + i, '\n', size - i));
+            statementEnd = newline != nullptr ? static_cast<size_t>(newline - buffer.data()) + 1 : size;
+            break;
+        }
+        if (isOperator(c)) {
+            statementEnd = i;
+            break;
+        }
+        Word word;
+        size_t wordEnd = readWord(i, word, true);
+        if (options && c == '-') {
+            if (wordEnd == i + 2 && buffer[i + 1] == '-') options = false;
+            used = word.begin;
+            i = wordEnd;
+            continue;
+        }
+        options = false;
+        if (prefix == std::string_view::npos) prefix = i;
+        if (word.assignment && word.nameEnd > word.begin) {
+            parsed.push_back(Definition{{}, {}, i, wordEnd - i});
+            words.push_back(word);
+        } else {
+            used = word.begin;
+        }
+        i = wordEnd;
+    }
+    if (prefix == std::string_view::npos) prefix = i;
+    // Views are taken once the statement is complete because growing the scratch buffer moves it.
+    const std::string_view decoded(scratch.data(), used);
+    for (size_t w = 0; w < words.size(); ++w) {
+        const Word& word = words[w];
+        parsed[w].name = word.rawName != nullptr ? std::string_view(word.rawName, word.nameEnd - word.begin) : decoded.substr(word.begin, word.nameEnd - word.begin);
+        parsed[w].command = decoded.substr(word.nameEnd, word.end - word.nameEnd);
+    }
+    return true;
+}
+std::string AliasParser::decodeWord(std::string_view text) {
+    AliasParser parser(text);
+    Word word;
+    parser.readWord(0, word, false);
+    return std::string(parser.scratch.data() + word.begin, word.end - word.begin);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Single-pass bash/zsh tokenizer for `alias` statements. Quote removal follows the shell: '...', "..." with
+// \$ \` \" \\ escapes, $'...' ANSI-C escapes, backslash escapes and backslash-newline continuations outside
+// quotes. Decoded names and commands point into the parsed buffer when the text needs no unquoting beyond
+// stripping the surrounding quotes, and into a reused scratch buffer otherwise; they stay valid until the next
+// parse() call. Nothing is allocated per statement once the scratch buffer has grown to the longest one.
+class AliasParser {
+public:
+    struct Definition {
+        std::string_view name;
+        std::string_view command;
+        size_t offset = 0;
+        size_t length = 0;
+    };
+    static constexpr std::string_view KEYWORD = "alias";
+    explicit AliasParser(std::string_view buffer);
+    bool parse(size_t keyword);
+    const std::vector<Definition>& definitions() const;
+    size_t prefixEnd() const;
+    size_t end() const;
+    static bool isKeyword(std::string_view text);
+    static bool startsStatement(char c) { return c == KEYWORD[0]; }
+    static std::string decodeWord(std::string_view text);
+private:
+    enum class State { UNQUOTED, SINGLE, DOUBLE, ANSI_C };
+    struct Word {
+        size_t begin = 0;
+        size_t nameEnd = 0;
+        size_t end = 0;
+        const char* rawName = nullptr;
+        bool assignment = false;
+    };
+    std::string_view buffer;
+    std::string scratch;
+    size_t used = 0;
+    std::vector<Word> words;
+    std::vector<Definition> parsed;
+    size_t prefix = 0;
+    size_t statementEnd = 0;
+    bool parseSimple(size_t pos);
+    size_t readWord(size_t pos, Word& word, bool splitAssignment);
+    size_t decodeAnsiEscape(size_t pos, Word& word);
+    size_t findEither(size_t from, char first, char second) const;
+    void put(Word& word, bool splitAssignment, const char* from, size_t length);
+    void put(Word& word, char c);
+    void write(const char* from, size_t length);
+};
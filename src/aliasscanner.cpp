@@ -0,0 +1,23 @@
+#include "aliasscanner.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+std::vector<Alias> AliasScanner::scanAll(std::string_view buffer, ShellDetector::Shell shell) {
+    std::vector<Alias> aliases;
+    scan(buffer, shell, [&](const ScannedAlias& scanned) { aliases.push_back(scanned.alias.materialize()); });
+    return aliases;
+}
+// Eight bytes per step: a byte of `word ^ '\n'...` is zero exactly where a newline was, and the expression below
+// sets that byte's high bit without the borrow-propagation false positives of the usual has-zero trick.
+size_t AliasScanner::countLines(const char* begin, const char* end) {
+    constexpr uint64_t NEWLINES = 0x0a0a0a0a0a0a0a0aULL, LOW_BITS = 0x7f7f7f7f7f7f7f7fULL;
+    size_t count = 0;
+    for (; end - begin >= 8; begin += 8) {
+        uint64_t word;
+        std::memcpy(&word, begin, sizeof(word));
+        word ^= NEWLINES;
+        count += static_cast<size_t>(std::popcount(~(((word & LOW_BITS) + LOW_BITS) | word | LOW_BITS)));
+    }
+    return count + static_cast<size_t>(std::count(begin, end, '\n'));
+}
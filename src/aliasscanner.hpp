@@ -0,0 +1,67 @@
+#pragma once
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "aliasmanager.hpp"
+#include "aliasparser.hpp"
+#include "fishparser.hpp"
+
+// One callback per definition; `alias a=b c=d` yields two that share the statement span. `prefixLength` covers
+// the statement up to its first definition (indentation, keyword and options), and the definition range is the
+// raw `name=value` word, so a single definition of a multi-definition statement can be rewritten on its own.
+struct ScannedAlias {
+    AliasView alias;
+    size_t line = 0;
+    size_t offset = 0;
+    size_t length = 0;
+    size_t prefixLength = 0;
+    size_t definitionOffset = 0;
+    size_t definitionLength = 0;
+};
+class AliasScanner {
+public:
+    template <typename Parser = AliasParser, typename Callback>
+    static size_t scan(std::string_view buffer, Callback&& onAlias);
+    template <typename Callback>
+    static size_t scan(std::string_view buffer, ShellDetector::Shell shell, Callback&& onAlias);
+    static std::vector<Alias> scanAll(std::string_view buffer, ShellDetector::Shell shell = ShellDetector::Shell::BASH);
+    static size_t countLines(const char* begin, const char* end);
+};
+
+template <typename Parser, typename Callback>
+size_t AliasScanner::scan(std::string_view buffer, Callback&& onAlias) {
+    const char* const begin = buffer.data();
+    const char* const end = begin + buffer.size();
+    const char* cursor = begin;
+    const char* counted = begin;
+    size_t lineNumber = 1;
+    size_t found = 0;
+    Parser parser(buffer);
+    // Statements are only recognised at the start of a line, so walk lines with memchr instead of searching the
+    // whole buffer for the keyword; comment and export lines then cost one newline search each.
+    while (cursor < end) {
+        const char* start = cursor;
+        while (start < end && (*start == ' ' || *start == '\t')) ++start;
+        if (start < end && Parser::startsStatement(*start) && parser.parse(static_cast<size_t>(start - begin))) {
+            lineNumber += countLines(counted, cursor);
+            counted = cursor;
+            const size_t offset = static_cast<size_t>(cursor - begin);
+            for (const auto& definition : parser.definitions()) {
+                onAlias(ScannedAlias{AliasView{definition.name, definition.command}, lineNumber, offset, parser.end() - offset, parser.prefixEnd() - offset, definition.offset, definition.length});
+                ++found;
+            }
+            cursor = begin + parser.end();
+            if (cursor[-1] == '\n') continue;
+            start = cursor;
+        }
+        auto* newline = static_cast<const char*>(std::memchr(start, '\n', static_cast<size_t>(end - start)));
+        cursor = newline != nullptr ? newline + 1 : end;
+    }
+    return found;
+}
+template <typename Callback>
+size_t AliasScanner::scan(std::string_view buffer, ShellDetector::Shell shell, Callback&& onAlias) {
+    if (shell == ShellDetector::Shell::FISH) return scan<FishParser>(buffer, std::forward<Callback>(onAlias));
+    return scan<AliasParser>(buffer, std::forward<Callback>(onAlias));
+}
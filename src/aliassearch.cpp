@@ -0,0 +1,169 @@
+#include "aliassearch.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+static constexpr int SCORE_MATCH = 16;
+static constexpr int GAP_START = 3;
+static constexpr int GAP_EXTENSION = 1;
+static constexpr int BONUS_BOUNDARY = 8;
+static constexpr int BONUS_CONSECUTIVE = 4;
+static constexpr int BONUS_FIRST_CHAR_MULTIPLIER = 2;
+static constexpr int BONUS_NAME = 8;
+static constexpr int BONUS_NAME_PREFIX = 16;
+static constexpr size_t PARALLEL_CHUNK = 8192;
+static std::atomic<uint64_t> nextGeneration{1};
+
+static char lower(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+static bool isWordChar(char c) { return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || static_cast<unsigned char>(c) >= 0x80; }
+
+void AliasSearch::build(const AliasStore& store, const std::vector<size_t>& rowIds) {
+    text.clear();
+    entries.clear();
+    nameMasks.clear();
+    commandMasks.clear();
+    entries.reserve(rowIds.size());
+    nameMasks.reserve(rowIds.size());
+    commandMasks.reserve(rowIds.size());
+    for (size_t id : rowIds) {
+        std::string_view name = store.name(id), command = store.command(id);
+        Entry entry{static_cast<uint32_t>(text.size()), static_cast<uint32_t>(name.size()), static_cast<uint32_t>(text.size() + name.size()), static_cast<uint32_t>(command.size())};
+        for (char c : name) text.push_back(lower(c));
+        for (char c : command) text.push_back(lower(c));
+        nameMasks.push_back(maskOf(std::string_view(text).substr(entry.nameOffset, entry.nameLength)));
+        commandMasks.push_back(maskOf(std::string_view(text).substr(entry.commandOffset, entry.commandLength)));
+        entries.push_back(entry);
+    }
+    nameBlockMasks.assign((entries.size() + BLOCK - 1) / BLOCK, 0);
+    commandBlockMasks.assign(nameBlockMasks.size(), 0);
+    for (size_t row = 0; row < entries.size(); ++row) {
+        nameBlockMasks[row / BLOCK] |= nameMasks[row];
+        commandBlockMasks[row / BLOCK] |= commandMasks[row];
+    }
+    generation = nextGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+size_t AliasSearch::size() const { return entries.size(); }
+uint64_t AliasSearch::maskOf(std::string_view text) {
+    uint64_t mask = 0;
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (u >= 'a' && u <= 'z') mask |= uint64_t{1} << (u - 'a');
+        else if (u >= '0' && u <= '9') mask |= uint64_t{1} << (26 + u - '0');
+        else mask |= uint64_t{1} << (36 + u % 28);
+    }
+    return mask;
+}
+static int scoreWindow(std::string_view text, std::string_view query, size_t start, size_t end) {
+    int total = 0, chunkBonus = 0;
+    bool inGap = false, previousMatched = false;
+    size_t matched = 0;
+    for (size_t i = start; i <= end; ++i) {
+        if (matched < query.size() && text[i] == query[matched]) {
+            int bonus = i == 0 || !isWordChar(text[i - 1]) ? BONUS_BOUNDARY : 0;
+            if (previousMatched) bonus = std::max({bonus, chunkBonus, BONUS_CONSECUTIVE});
+            else chunkBonus = bonus;
+            total += SCORE_MATCH + (matched == 0 ? bonus * BONUS_FIRST_CHAR_MULTIPLIER : bonus);
+            ++matched;
+            previousMatched = true;
+            inGap = false;
+        } else {
+            total -= inGap ? GAP_EXTENSION : GAP_START;
+            previousMatched = false;
+            inGap = true;
+        }
+    }
+    return std::max(total, 1);
+}
+// The most any window can score: every character on a word boundary, the first one doubled.
+static int bestPossible(size_t queryLength) { return SCORE_MATCH + BONUS_BOUNDARY * BONUS_FIRST_CHAR_MULTIPLIER + static_cast<int>(queryLength - 1) * (SCORE_MATCH + BONUS_BOUNDARY); }
+static size_t find(std::string_view text, char c, size_t from) {
+    const void* found = from < text.size() ? std::memchr(text.data() + from, c, text.size() - from) : nullptr;
+    return found != nullptr ? static_cast<size_t>(static_cast<const char*>(found) - text.data()) : std::string_view::npos;
+}
+int AliasSearch::score(std::string_view text, std::string_view query) {
+    if (query.empty()) return 0;
+    const int ceiling = bestPossible(query.size());
+    int best = -1;
+    // Like fzf's v1 matcher, find the first subsequence match and shrink it from the right; unlike it, retry
+    // past each window's start so "ab" in "a-b-c ab" scores the later, tighter occurrence. A window with
+    // gaps loses at least the gap penalty, so one that can't beat the best so far is not scored.
+    for (size_t from = find(text, query[0], 0); from != std::string_view::npos; from = find(text, query[0], from)) {
+        size_t end = from;
+        for (size_t matched = 1; matched < query.size() && end != std::string_view::npos; ++matched) end = find(text, query[matched], end + 1);
+        if (end == std::string_view::npos) break;
+        size_t start = end;
+        for (size_t i = end + 1, remaining = query.size(); i-- > from;) {
+            if (text[i] == query[remaining - 1] && --remaining == 0) {
+                start = i;
+                break;
+            }
+        }
+        const size_t gaps = end - start + 1 - query.size();
+        if (std::max(ceiling - (gaps > 0 ? GAP_START + static_cast<int>(gaps - 1) * GAP_EXTENSION : 0), 1) > best) best = std::max(best, scoreWindow(text, query, start, end));
+        if (best >= ceiling) break;
+        from = start + 1;
+    }
+    return best;
+}
+int AliasSearch::scoreRow(size_t row, std::string_view query, uint64_t queryMask, Mode mode) const {
+    const Entry& entry = entries[row];
+    int best = -1;
+    if (mode != Mode::COMMAND && (nameMasks[row] & queryMask) == queryMask) {
+        std::string_view name = std::string_view(text).substr(entry.nameOffset, entry.nameLength);
+        if (int nameScore = score(name, query); nameScore > 0) best = nameScore + (mode == Mode::ALL ? BONUS_NAME : 0) + (name.starts_with(query) ? BONUS_NAME_PREFIX : 0);
+    }
+    // A name match with its bonuses often beats anything the command could score, which then isn't scanned.
+    if (mode != Mode::NAME && best < bestPossible(query.size()) && (commandMasks[row] & queryMask) == queryMask) best = std::max(best, score(std::string_view(text).substr(entry.commandOffset, entry.commandLength), query));
+    return best;
+}
+AliasSearch::Result AliasSearch::search(std::string_view query, Mode mode, const Result* previous) const {
+    Result result{generation, {}, mode, {}};
+    result.query.reserve(query.size());
+    for (char c : query) result.query.push_back(lower(c));
+    if (result.query.empty()) {
+        result.matches.reserve(entries.size());
+        for (size_t row = 0; row < entries.size(); ++row) result.matches.push_back(Match{row, 0});
+        return result;
+    }
+    // A query that extends the previous one can only match a subset of its rows, so only those are rescored.
+    // They are visited in row order so that equal scores keep the same order as a full scan.
+    bool narrowing = previous != nullptr && previous->generation == generation && previous->mode == mode && result.query.starts_with(previous->query);
+    std::vector<char> candidates;
+    if (narrowing) {
+        candidates.assign(entries.size(), 0);
+        for (const auto& match : previous->matches) candidates[match.row] = 1;
+    }
+    uint64_t queryMask = maskOf(result.query);
+    size_t chunks = (entries.size() + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+    static_assert(PARALLEL_CHUNK % BLOCK == 0, "chunks must start on a block boundary");
+    std::vector<std::vector<Match>> partial(chunks);
+    auto scan = [&](size_t chunk) {
+        size_t end = std::min(entries.size(), (chunk + 1) * PARALLEL_CHUNK);
+        for (size_t block = chunk * PARALLEL_CHUNK; block < end; block += BLOCK) {
+            const bool inNames = mode != Mode::COMMAND && (nameBlockMasks[block / BLOCK] & queryMask) == queryMask;
+            const bool inCommands = mode != Mode::NAME && (commandBlockMasks[block / BLOCK] & queryMask) == queryMask;
+            if (!inNames && !inCommands) continue;
+            for (size_t row = block; row < std::min(end, block + BLOCK); ++row) {
+                if (narrowing && !candidates[row]) continue;
+                if (int rowScore = scoreRow(row, result.query, queryMask, mode); rowScore > 0) partial[chunk].push_back(Match{row, rowScore});
+            }
+        }
+    };
+    if (chunks > 1) ThreadPool::shared().parallelFor(chunks, scan);
+    else if (chunks == 1) scan(0);
+    std::vector<Match> matches;
+    size_t total = 0;
+    for (const auto& part : partial) total += part.size();
+    matches.reserve(total);
+    for (const auto& part : partial) matches.insert(matches.end(), part.begin(), part.end());
+    // Scores are small positive integers, so a stable counting sort ranks them in linear time.
+    int maxScore = 0;
+    for (const auto& match : matches) maxScore = std::max(maxScore, match.score);
+    std::vector<size_t> counts(static_cast<size_t>(maxScore) + 2, 0);
+    for (const auto& match : matches) ++counts[static_cast<size_t>(maxScore - match.score) + 1];
+    for (size_t i = 1; i < counts.size(); ++i) counts[i] += counts[i - 1];
+    result.matches.resize(matches.size());
+    for (const auto& match : matches) result.matches[counts[static_cast<size_t>(maxScore - match.score)]++] = match;
+    return result;
+}
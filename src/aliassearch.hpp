@@ -0,0 +1,45 @@
+#pragma once
+#include "aliasstore.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class AliasSearch {
+public:
+    enum class Mode { ALL, NAME, COMMAND };
+    struct Match {
+        size_t row;
+        int score;
+    };
+    struct Result {
+        uint64_t generation = 0;
+        std::string query;
+        Mode mode = Mode::ALL;
+        std::vector<Match> matches;
+    };
+    AliasSearch() = default;
+    void build(const AliasStore& store, const std::vector<size_t>& rowIds);
+    size_t size() const;
+    Result search(std::string_view query, Mode mode, const Result* previous = nullptr) const;
+    static int score(std::string_view text, std::string_view query);
+private:
+    struct Entry {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t commandOffset;
+        uint32_t commandLength;
+    };
+    std::string text;
+    std::vector<Entry> entries;
+    std::vector<uint64_t> nameMasks;
+    std::vector<uint64_t> commandMasks;
+    // The union of the row masks of every BLOCK rows, so a query with a rare character skips whole blocks.
+    static constexpr size_t BLOCK = 64;
+    std::vector<uint64_t> nameBlockMasks;
+    std::vector<uint64_t> commandBlockMasks;
+    uint64_t generation = 0;
+    static uint64_t maskOf(std::string_view text);
+    int scoreRow(size_t row, std::string_view query, uint64_t queryMask, Mode mode) const;
+};
@@ -0,0 +1,151 @@
+#include "aliasstore.hpp"
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+AliasStore::const_iterator::const_iterator(const AliasStore* store, size_t id) : store(store), id(id) { skipDead(); }
+AliasRef AliasStore::const_iterator::operator*() const { return store->at(id); }
+AliasStore::const_iterator& AliasStore::const_iterator::operator++() { ++id; skipDead(); return *this; }
+void AliasStore::const_iterator::skipDead() { while (id < store->entries.size() && !store->isLive(id)) ++id; }
+
+void AliasStore::reserve(size_t aliasCount, size_t textBytes) {
+    entries.reserve(aliasCount);
+    arena.reserve(textBytes);
+    if (aliasCount * 2 > buckets.size()) rehash(std::bit_ceil(aliasCount * 2));
+}
+void AliasStore::clear() {
+    arena.clear();
+    entries.clear();
+    buckets.clear();
+    originPaths.clear();
+    liveCount = usedBuckets = garbageBytes = 0;
+}
+size_t AliasStore::size() const { return liveCount; }
+bool AliasStore::empty() const { return liveCount == 0; }
+size_t AliasStore::slotCount() const { return entries.size(); }
+size_t AliasStore::insert(std::string_view name, std::string_view command, size_t line, size_t origin) {
+    uint32_t hash = hashName(name);
+    if (size_t bucket = findBucket(name, hash); bucket != npos) {
+        uint32_t id = buckets[bucket].id;
+        Entry& entry = entries[id];
+        if (command != this->command(id)) {
+            garbageBytes += entry.commandLength;
+            entry.commandOffset = appendText(command);
+            entry.commandLength = static_cast<uint32_t>(command.size());
+        }
+        entry.line = static_cast<uint32_t>(line);
+        entry.origin = static_cast<uint32_t>(origin);
+        compactArena();
+        return id;
+    }
+    if ((usedBuckets + 1) * 10 > buckets.size() * 7) rehash(buckets.empty() ? 16 : (liveCount + 1) * 2 > buckets.size() ? buckets.size() * 2 : buckets.size());
+    uint32_t id = static_cast<uint32_t>(entries.size());
+    uint32_t nameOffset = appendText(name);
+    uint32_t commandOffset = appendText(command);
+    entries.push_back(Entry{nameOffset, static_cast<uint32_t>(name.size()), commandOffset, static_cast<uint32_t>(command.size()), static_cast<uint32_t>(line), static_cast<uint32_t>(origin), hash});
+    size_t mask = buckets.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        if (buckets[i].id == EMPTY || buckets[i].id == TOMBSTONE) {
+            if (buckets[i].id == EMPTY) ++usedBuckets;
+            buckets[i] = Bucket{id, hash};
+            break;
+        }
+    }
+    ++liveCount;
+    return id;
+}
+bool AliasStore::update(std::string_view name, std::string_view command) {
+    size_t id = find(name);
+    if (id == npos) return false;
+    insert(name, command, entries[id].line, entries[id].origin);
+    return true;
+}
+bool AliasStore::remove(std::string_view name) {
+    size_t bucket = findBucket(name, hashName(name));
+    if (bucket == npos) return false;
+    Entry& entry = entries[buckets[bucket].id];
+    garbageBytes += entry.nameLength + entry.commandLength;
+    entry.hash = DEAD;
+    entry.nameLength = entry.commandLength = 0;
+    buckets[bucket].id = TOMBSTONE;
+    --liveCount;
+    compactArena();
+    return true;
+}
+size_t AliasStore::find(std::string_view name) const {
+    size_t bucket = findBucket(name, hashName(name));
+    return bucket == npos ? npos : buckets[bucket].id;
+}
+bool AliasStore::contains(std::string_view name) const { return find(name) != npos; }
+bool AliasStore::isLive(size_t id) const { return id < entries.size() && entries[id].hash != DEAD; }
+std::string_view AliasStore::name(size_t id) const { return std::string_view(arena).substr(entries[id].nameOffset, entries[id].nameLength); }
+std::string_view AliasStore::command(size_t id) const { return std::string_view(arena).substr(entries[id].commandOffset, entries[id].commandLength); }
+size_t AliasStore::line(size_t id) const { return entries[id].line; }
+// Origins are the files aliases were read from, interned so every entry carries a 32-bit index rather than a
+// path; entries inserted without one report an empty origin until an origin has been added.
+std::string_view AliasStore::origin(size_t id) const { return entries[id].origin < originPaths.size() ? std::string_view(originPaths[entries[id].origin]) : std::string_view(); }
+size_t AliasStore::addOrigin(std::string_view path) {
+    auto it = std::find(originPaths.begin(), originPaths.end(), path);
+    if (it != originPaths.end()) return static_cast<size_t>(it - originPaths.begin());
+    originPaths.emplace_back(path);
+    return originPaths.size() - 1;
+}
+const std::vector<std::string>& AliasStore::origins() const { return originPaths; }
+AliasRef AliasStore::at(size_t id) const { return AliasRef{id, name(id), command(id), line(id), origin(id)}; }
+std::vector<Alias> AliasStore::toVector() const {
+    std::vector<Alias> aliases;
+    aliases.reserve(liveCount);
+    for (const auto& alias : *this) aliases.push_back(alias.materialize());
+    return aliases;
+}
+size_t AliasStore::memoryUsage() const {
+    return arena.capacity() + entries.capacity() * sizeof(Entry) + buckets.capacity() * sizeof(Bucket);
+}
+AliasStore::const_iterator AliasStore::begin() const { return const_iterator(this, 0); }
+AliasStore::const_iterator AliasStore::end() const { return const_iterator(this, entries.size()); }
+uint32_t AliasStore::hashName(std::string_view name) {
+    uint32_t hash = static_cast<uint32_t>(std::hash<std::string_view>{}(name));
+    return hash >= TOMBSTONE ? hash - 2 : hash;
+}
+uint32_t AliasStore::appendText(std::string_view text) {
+    uint32_t offset = static_cast<uint32_t>(arena.size());
+    arena.append(text);
+    return offset;
+}
+size_t AliasStore::findBucket(std::string_view name, uint32_t hash) const {
+    if (buckets.empty()) return npos;
+    size_t mask = buckets.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Bucket& bucket = buckets[i];
+        if (bucket.id == EMPTY) return npos;
+        if (bucket.id != TOMBSTONE && bucket.hash == hash && this->name(bucket.id) == name) return i;
+    }
+}
+void AliasStore::rehash(size_t bucketCount) {
+    buckets.assign(bucketCount, Bucket{EMPTY, 0});
+    usedBuckets = 0;
+    size_t mask = bucketCount - 1;
+    for (uint32_t id = 0; id < entries.size(); ++id) {
+        if (entries[id].hash == DEAD) continue;
+        size_t i = entries[id].hash & mask;
+        while (buckets[i].id != EMPTY) i = (i + 1) & mask;
+        buckets[i] = Bucket{id, entries[id].hash};
+        ++usedBuckets;
+    }
+}
+void AliasStore::compactArena() {
+    if (garbageBytes < 65536 || garbageBytes * 2 < arena.size()) return;
+    std::string compacted;
+    compacted.reserve(arena.size() - garbageBytes);
+    for (Entry& entry : entries) {
+        if (entry.hash == DEAD) continue;
+        uint32_t nameOffset = static_cast<uint32_t>(compacted.size());
+        compacted.append(arena, entry.nameOffset, entry.nameLength);
+        uint32_t commandOffset = static_cast<uint32_t>(compacted.size());
+        compacted.append(arena, entry.commandOffset, entry.commandLength);
+        entry.nameOffset = nameOffset;
+        entry.commandOffset = commandOffset;
+    }
+    arena = std::move(compacted);
+    garbageBytes = 0;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "aliasmanager.hpp"
+
+struct AliasRef {
+    size_t id;
+    std::string_view name;
+    std::string_view command;
+    size_t line;
+    std::string_view origin;
+    Alias materialize() const { return Alias{std::string(name), std::string(command)}; }
+};
+class AliasStore {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = AliasRef;
+        using difference_type = std::ptrdiff_t;
+        const_iterator(const AliasStore* store, size_t id);
+        AliasRef operator*() const;
+        const_iterator& operator++();
+        bool operator==(const const_iterator& other) const { return id == other.id; }
+    private:
+        const AliasStore* store;
+        size_t id;
+        void skipDead();
+    };
+    AliasStore() = default;
+    void reserve(size_t aliasCount, size_t textBytes);
+    void clear();
+    size_t size() const;
+    bool empty() const;
+    size_t slotCount() const;
+    size_t insert(std::string_view name, std::string_view command, size_t line = 0, size_t origin = 0);
+    bool update(std::string_view name, std::string_view command);
+    bool remove(std::string_view name);
+    size_t find(std::string_view name) const;
+    bool contains(std::string_view name) const;
+    bool isLive(size_t id) const;
+    std::string_view name(size_t id) const;
+    std::string_view command(size_t id) const;
+    size_t line(size_t id) const;
+    std::string_view origin(size_t id) const;
+    size_t addOrigin(std::string_view path);
+    const std::vector<std::string>& origins() const;
+    AliasRef at(size_t id) const;
+    std::vector<Alias> toVector() const;
+    size_t memoryUsage() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+private:
+    struct Entry {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t commandOffset;
+        uint32_t commandLength;
+        uint32_t line;
+        uint32_t origin;
+        uint32_t hash;
+    };
+    struct Bucket {
+        uint32_t id;
+        uint32_t hash;
+    };
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+    static constexpr uint32_t TOMBSTONE = UINT32_MAX - 1;
+    static constexpr uint32_t DEAD = UINT32_MAX;
+    std::string arena;
+    std::vector<Entry> entries;
+    std::vector<std::string> originPaths;
+    std::vector<Bucket> buckets;
+    size_t liveCount = 0;
+    size_t usedBuckets = 0;
+    size_t garbageBytes = 0;
+    static uint32_t hashName(std::string_view name);
+    uint32_t appendText(std::string_view text);
+    size_t findBucket(std::string_view name, uint32_t hash) const;
+    void rehash(size_t bucketCount);
+    void compactArena();
+};
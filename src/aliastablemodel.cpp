@@ -0,0 +1,150 @@
+#include "aliastablemodel.hpp"
+#include <QDateTime>
+#include <QLocale>
+#include <string>
+
+static QString toQString(std::string_view text) { return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size())); }
+
+AliasTableModel::AliasTableModel(QObject* parent) : QAbstractTableModel(parent) {}
+
+int AliasTableModel::rowCount(const QModelIndex& parent) const { return parent.isValid() ? 0 : static_cast<int>(rows.size()); }
+
+int AliasTableModel::columnCount(const QModelIndex& parent) const { return parent.isValid() ? 0 : COLUMN_COUNT; }
+
+QVariant AliasTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(rows.size())) return {};
+    size_t id = rows[static_cast<size_t>(index.row())];
+    if (index.column() == CHECK) {
+        if (id >= checks.size() || checks[id].status == PathIndex::Status::OK || (role != Qt::DisplayRole && role != Qt::ToolTipRole)) return {};
+        const PathIndex::Check& check = checks[id];
+        if (role == Qt::DisplayRole) return check.status == PathIndex::Status::SHADOWS ? QStringLiteral("⚠️ shadows") : QStringLiteral("❓ not found");
+        if (check.status == PathIndex::Status::SHADOWS) return QString("Hides %1: typing %2 runs this alias instead").arg(toQString(check.target), toQString(store.name(id)));
+        return QString("'%1' is not a builtin, another alias or an executable on $PATH (it may be a shell function)").arg(toQString(check.target));
+    }
+    if (index.column() == USES || index.column() == LAST_USED) {
+        if (id >= usage.size()) return {};
+        const HistoryUsage::Usage& used = usage[id];
+        if (index.column() == USES) {
+            if (role == Qt::TextAlignmentRole) return QVariant::fromValue(Qt::AlignRight | Qt::AlignVCenter);
+            return role == Qt::DisplayRole ? QVariant(QString::number(used.count)) : QVariant();
+        }
+        // Histories without timestamps (bash without HISTTIMEFORMAT) still count uses; the date is left empty.
+        if (used.count == 0) return role == Qt::DisplayRole ? QVariant(QStringLiteral("never")) : QVariant();
+        if (used.lastUsed == 0) return role == Qt::ToolTipRole ? QVariant(QStringLiteral("The history file has no timestamps")) : QVariant();
+        QDateTime when = QDateTime::fromSecsSinceEpoch(used.lastUsed);
+        if (role == Qt::DisplayRole) return QLocale().toString(when.date(), QLocale::ShortFormat);
+        return role == Qt::ToolTipRole ? QVariant(QLocale().toString(when, QLocale::LongFormat)) : QVariant();
+    }
+    switch (role) {
+        case Qt::DisplayRole:
+            return toQString(index.column() == NAME ? store.name(id) : store.command(id));
+        case Qt::ToolTipRole:
+            if (index.column() == COMMAND) return toQString(store.command(id));
+            if (store.origin(id).empty()) return {};
+            return QString("Defined in %1, line %2").arg(toQString(store.origin(id))).arg(store.line(id));
+        case Qt::UserRole:
+            return toQString(store.name(id));
+        default:
+            return {};
+    }
+}
+
+QVariant AliasTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return {};
+    switch (section) {
+        case NAME: return QStringLiteral("Alias");
+        case COMMAND: return QStringLiteral("Command");
+        case USES: return QStringLiteral("Uses");
+        case LAST_USED: return QStringLiteral("Last Used");
+        case CHECK: return QStringLiteral("Check");
+        default: return {};
+    }
+}
+
+void AliasTableModel::clear() {
+    beginResetModel();
+    store.clear();
+    rows.clear();
+    checks.clear();
+    usage.clear();
+    endResetModel();
+}
+
+void AliasTableModel::append(const std::vector<Alias>& aliases, const std::vector<size_t>& lines, const std::vector<std::string>& origins) {
+    std::vector<size_t> added;
+    for (size_t i = 0; i < aliases.size(); ++i) {
+        bool existed = store.contains(aliases[i].name);
+        size_t id = store.insert(aliases[i].name, aliases[i].command, i < lines.size() ? lines[i] : 0, i < origins.size() ? store.addOrigin(origins[i]) : 0);
+        if (!existed) added.push_back(id);
+        else if (int row = rowForName(aliases[i].name); row >= 0) emit dataChanged(index(row, COMMAND), index(row, COMMAND));
+    }
+    if (added.empty()) return;
+    beginInsertRows(QModelIndex(), static_cast<int>(rows.size()), static_cast<int>(rows.size() + added.size() - 1));
+    rows.insert(rows.end(), added.begin(), added.end());
+    endInsertRows();
+}
+
+// Ids of removed aliases get reused, so checks and usage are dropped here and recomputed once the load is complete.
+void AliasTableModel::applyStore(const AliasStore& next) {
+    if (!checks.empty()) setChecks({});
+    if (!usage.empty()) setUsage({});
+    for (int row = static_cast<int>(rows.size()) - 1; row >= 0;) {
+        if (next.contains(store.name(rows[static_cast<size_t>(row)]))) {
+            --row;
+            continue;
+        }
+        int last = row;
+        while (row >= 0 && !next.contains(store.name(rows[static_cast<size_t>(row)]))) --row;
+        beginRemoveRows(QModelIndex(), row + 1, last);
+        for (int removed = row + 1; removed <= last; ++removed) store.remove(std::string(store.name(rows[static_cast<size_t>(removed)])));
+        rows.erase(rows.begin() + row + 1, rows.begin() + last + 1);
+        endRemoveRows();
+    }
+
+    std::vector<int> rowOfId(store.slotCount(), -1);
+    for (size_t row = 0; row < rows.size(); ++row) rowOfId[rows[row]] = static_cast<int>(row);
+    std::vector<size_t> added;
+    for (const auto& alias : next) {
+        size_t id = store.find(alias.name);
+        if (id == AliasStore::npos) {
+            added.push_back(store.insert(alias.name, alias.command, alias.line, store.addOrigin(alias.origin)));
+            continue;
+        }
+        bool changed = store.command(id) != alias.command;
+        store.insert(alias.name, alias.command, alias.line, store.addOrigin(alias.origin));
+        if (changed && rowOfId[id] >= 0) emit dataChanged(index(rowOfId[id], COMMAND), index(rowOfId[id], COMMAND));
+    }
+    if (added.empty()) return;
+    beginInsertRows(QModelIndex(), static_cast<int>(rows.size()), static_cast<int>(rows.size() + added.size() - 1));
+    rows.insert(rows.end(), added.begin(), added.end());
+    endInsertRows();
+}
+
+// Indexed by alias id, as PathIndex::checkAll returns them.
+void AliasTableModel::setChecks(std::vector<PathIndex::Check> next) {
+    checks = std::move(next);
+    if (!rows.empty()) emit dataChanged(index(0, CHECK), index(static_cast<int>(rows.size()) - 1, CHECK));
+}
+
+// Indexed by alias id, as HistoryUsage::forAliases returns them.
+void AliasTableModel::setUsage(std::vector<HistoryUsage::Usage> next) {
+    usage = std::move(next);
+    if (!rows.empty()) emit dataChanged(index(0, USES), index(static_cast<int>(rows.size()) - 1, LAST_USED));
+}
+
+const AliasStore& AliasTableModel::aliases() const { return store; }
+
+const std::vector<size_t>& AliasTableModel::rowIds() const { return rows; }
+
+std::string_view AliasTableModel::name(int row) const { return store.name(rows[static_cast<size_t>(row)]); }
+
+std::string_view AliasTableModel::command(int row) const { return store.command(rows[static_cast<size_t>(row)]); }
+
+int AliasTableModel::rowForName(std::string_view name) const {
+    size_t id = store.find(name);
+    if (id == AliasStore::npos) return -1;
+    for (size_t row = 0; row < rows.size(); ++row) {
+        if (rows[row] == id) return static_cast<int>(row);
+    }
+    return -1;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "aliasstore.hpp"
+#include "historyusage.hpp"
+#include "pathindex.hpp"
+
+class AliasTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { NAME, COMMAND, USES, LAST_USED, CHECK, COLUMN_COUNT };
+    explicit AliasTableModel(QObject* parent = nullptr);
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void clear();
+    void append(const std::vector<Alias>& aliases, const std::vector<size_t>& lines, const std::vector<std::string>& origins);
+    void applyStore(const AliasStore& next);
+    void setChecks(std::vector<PathIndex::Check> next);
+    void setUsage(std::vector<HistoryUsage::Usage> next);
+    const AliasStore& aliases() const;
+    const std::vector<size_t>& rowIds() const;
+    std::string_view name(int row) const;
+    std::string_view command(int row) const;
+    int rowForName(std::string_view name) const;
+
+private:
+    AliasStore store;
+    std::vector<size_t> rows;
+    std::vector<PathIndex::Check> checks;
+    std::vector<HistoryUsage::Usage> usage;
+};
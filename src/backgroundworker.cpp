@@ -0,0 +1,44 @@
+#include "backgroundworker.hpp"
+#include <sys/resource.h>
+#include <unistd.h>
+
+BackgroundWorker::~BackgroundWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    if (thread.joinable()) thread.join();
+}
+BackgroundWorker& BackgroundWorker::shared() {
+    static BackgroundWorker worker;
+    return worker;
+}
+void BackgroundWorker::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+        if (!thread.joinable()) thread = std::thread(&BackgroundWorker::workerLoop, this);
+    }
+    workAvailable.notify_one();
+}
+void BackgroundWorker::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return tasks.empty() && !running; });
+}
+void BackgroundWorker::workerLoop() {
+    setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), 10);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        workAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+        if (tasks.empty()) return;
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+        running = true;
+        lock.unlock();
+        task();
+        lock.lock();
+        running = false;
+        if (tasks.empty()) idle.notify_all();
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class BackgroundWorker {
+public:
+    BackgroundWorker() = default;
+    ~BackgroundWorker();
+    BackgroundWorker(const BackgroundWorker&) = delete;
+    BackgroundWorker& operator=(const BackgroundWorker&) = delete;
+    void post(std::function<void()> task);
+    void waitIdle();
+    static BackgroundWorker& shared();
+private:
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable idle;
+    std::deque<std::function<void()>> tasks;
+    std::thread thread;
+    bool running = false;
+    bool stopping = false;
+    void workerLoop();
+};
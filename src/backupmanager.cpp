@@ -1,74 +1,233 @@
 #include "backupmanager.hpp"
+#include "backgroundworker.hpp"
+#include "linedelta.hpp"
+#include "mappedfile.hpp"
+#include "sha256.hpp"
+#include "trace.hpp"
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <chrono>
 #include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
-BackupManager::BackupManager(const std::string& originalFilePath) : originalFilePath(originalFilePath) {}
+static int64_t nowNanoseconds() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count(); }
+static int64_t mtimeNanoseconds(const struct stat& sb) { return static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec; }
+static constexpr std::string_view OBJECT_MAGIC = "ALIACAN-OBJECT 1 ";
+static constexpr size_t MIN_COMPRESS_SIZE = 256;
+static Compression::Codec codecFromExtension(const std::string& path) { return path.ends_with(".xz") ? Compression::Codec::XZ : path.ends_with(".zst") ? Compression::Codec::ZSTD : Compression::Codec::NONE; }
+static bool hasCompressedExtension(const std::string& path) { return codecFromExtension(path) != Compression::Codec::NONE; }
+static bool writeFully(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t n = ::write(fd, data.data(), data.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(n));
+    }
+    return true;
+}
+// Replaces `target` with `data` through a synced temporary file of its own, which takes the owner, mode and
+// times of `like`; concurrent writers of the same target each finish their own file and the last rename wins.
+static bool replaceFileLike(const std::string& target, std::string_view data, const struct stat& like) {
+    std::string tempPath = target + ".tmp.XXXXXX";
+    int fd = mkstemp(tempPath.data());
+    if (fd < 0) return false;
+    bool ok = writeFully(fd, data);
+    ok = ok && (fchown(fd, like.st_uid, like.st_gid) == 0 || geteuid() != 0);
+    ok = ok && fchmod(fd, like.st_mode & 07777) == 0;
+    struct timespec times[2] = {like.st_atim, like.st_mtim};
+    ok = ok && futimens(fd, times) == 0 && fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    ok = ok && ::rename(tempPath.c_str(), target.c_str()) == 0;
+    if (!ok) unlink(tempPath.c_str());
+    return ok;
+}
+BackupManager::BackupManager(const std::string& originalFilePath, const std::string& backupDirectory) : originalFilePath(originalFilePath), backupDirectory(backupDirectory), configKey(keyFor(originalFilePath)) {
+    if (const char* setting = std::getenv("ALIACAN_BACKUP_COMPRESSION")) {
+        std::string_view value(setting);
+        size_t colon = value.find(':');
+        Compression::Codec configured;
+        if (Compression::codecFromName(value.substr(0, colon), configured) && Compression::isAvailable(configured)) setCompression(configured, colon == std::string_view::npos ? -1 : std::atoi(setting + colon + 1));
+    }
+}
 std::string BackupManager::createBackup() {
-    if (!fs::exists(originalFilePath)) { lastError = "Original file does not exist: " + originalFilePath; return ""; }
-    std::string backupPath = fs::path(getBackupDirectory()) / (fs::path(originalFilePath).filename().string() + ".bak" + generateTimestamp());
-    try { fs::copy_file(originalFilePath, backupPath, fs::copy_options::overwrite_existing); } catch (const std::exception& e) { lastError = std::string("Failed to create backup: ") + e.what(); return ""; }
-    cleanupAndCompressOldBackups(20);
-    return backupPath;
+    TRACE_SCOPE(span, "BackupManager::createBackup");
+    struct stat sb;
+    if (stat(originalFilePath.c_str(), &sb) != 0) { lastError = "Original file does not exist: " + originalFilePath; return ""; }
+    Snapshot latest;
+    bool haveLatest = latestSnapshot(latest);
+    if (haveLatest && latest.size == static_cast<uint64_t>(sb.st_size) && latest.sourceMtime == mtimeNanoseconds(sb) && fs::exists(latest.path)) return latest.path;
+    MappedFile original;
+    if (!original.open(originalFilePath)) { lastError = "Failed to create backup: " + original.getLastError(); return ""; }
+    Snapshot snapshot{"", Sha256::hex(original.view()), nowNanoseconds(), original.size(), mtimeNanoseconds(sb)};
+    snapshot.path = getObjectPath(snapshot.hash);
+    if (haveLatest && latest.hash == snapshot.hash && fs::exists(snapshot.path)) return snapshot.path;
+    if (haveLatest && snapshot.timestamp <= latest.timestamp) snapshot.timestamp = latest.timestamp + 1;
+    if (!storeObject(snapshot, original.view(), haveLatest && !latest.hash.empty() ? &latest : nullptr) || !appendToManifest(snapshot)) return "";
+    if (lchown(snapshot.path.c_str(), sb.st_uid, sb.st_gid) != 0) lastError = "Cannot transfer backup ownership: " + snapshot.path;
+    if (codec != Compression::Codec::NONE) BackgroundWorker::shared().post([path = snapshot.path, codec = codec, level = compressionLevel, manifest = BackupManifest(getManifestPath()), record = toRecord(snapshot)] { compressObject(path, codec, level, manifest, record); });
+    cleanupAndCompressOldBackups(maxBackups);
+    TRACE_ARG(span, "bytes", snapshot.size);
+    return snapshot.path;
 }
 int BackupManager::cleanupAndCompressOldBackups(int maxBackups) {
+    TRACE_SCOPE(span, "BackupManager::cleanupAndCompressOldBackups");
     if (maxBackups <= 0) maxBackups = 20;
-    std::vector<std::string> backups = listBackups();
-    std::vector<std::pair<std::string, fs::file_time_type>> backupsWithTime;
-    for (const auto& backup : backups) { try { backupsWithTime.emplace_back(backup, fs::last_write_time(backup)); } catch (...) { continue; } }
-    std::sort(backupsWithTime.begin(), backupsWithTime.end(), [](const auto& a, const auto& b){ return a.second > b.second; });
-    int deleted = 0;
-    for (size_t i = 0; i < backupsWithTime.size(); ++i) {
-        const std::string& path = backupsWithTime[i].first;
-        if (i >= (size_t)maxBackups) { try { fs::remove(path); deleted++; } catch (...) { continue; } }
-        else if (i >= 10 && path.substr(path.size()-3) != ".xz") { std::string cmd = "xz -9e " + path; if (std::system(cmd.c_str()) != 0) lastError = "Failed to compress backup: " + path; }
-    }
-    return deleted;
+    if (BackupManifest(getManifestPath()).recordCount() <= static_cast<size_t>(maxBackups)) return 0;
+    // Trimming and the sweep of the objects it released happen under the manifest lock: a backup another
+    // process appends meanwhile is kept, and its object is never collected as unreferenced.
+    std::vector<Snapshot> kept;
+    std::vector<std::string> droppedLegacy;
+    size_t excess = 0;
+    bool droppedObjects = false;
+    auto trim = [&](std::vector<BackupManifest::Record>& records) {
+        excess = records.size() > static_cast<size_t>(maxBackups) ? records.size() - static_cast<size_t>(maxBackups) : 0;
+        droppedObjects = false;
+        droppedLegacy.clear();
+        for (size_t i = 0; i < excess; ++i) {
+            if (records[i].kind == BackupManifest::Kind::OBJECT) droppedObjects = true;
+            else droppedLegacy.push_back(toSnapshot(records[i]).path);
+        }
+        records.erase(records.begin(), records.begin() + static_cast<std::ptrdiff_t>(excess));
+        kept.clear();
+        for (const auto& record : records) kept.push_back(toSnapshot(record));
+    };
+    auto sweep = [&] {
+        for (const auto& path : droppedLegacy) {
+            if (std::error_code ec; !fs::remove(path, ec) && ec) lastError = "Failed to remove backup: " + path;
+        }
+        if (droppedObjects) collectUnreferencedObjects();
+    };
+    // A damaged manifest is rebuilt first, then trimmed like an intact one.
+    if (!rewriteManifest(trim, sweep) && (loadManifest(), !rewriteManifest(trim, sweep))) {
+        lastError = "Failed to write backup manifest: " + getManifestPath();
+        return 0;
+    }
+    scheduleLegacyCompression(kept);
+    return static_cast<int>(excess);
+}
+void BackupManager::scheduleLegacyCompression(const std::vector<Snapshot>& snapshots) const {
+    if (codec == Compression::Codec::NONE || snapshots.size() <= 10) return;
+    BackupManifest manifest(getManifestPath());
+    for (size_t i = 0; i < snapshots.size() - 10; ++i) {
+        if (!snapshots[i].hash.empty() || hasCompressedExtension(snapshots[i].path)) continue;
+        BackgroundWorker::shared().post([path = snapshots[i].path, codec = codec, level = compressionLevel, manifest, record = toRecord(snapshots[i])] { compressLegacyBackup(path, codec, level, manifest, record); });
+    }
 }
 bool BackupManager::restoreFromBackup(const std::string& backupPath) {
-    std::string actualBackupPath = backupPath;
-    if (backupPath.substr(backupPath.size()-3) == ".xz") {
-        actualBackupPath = backupPath.substr(0, backupPath.size()-3);
-        std::string cmd = "xz -d -k -f " + backupPath;
-        if (std::system(cmd.c_str()) != 0) { lastError = "Failed to decompress backup: " + backupPath; return false; }
+    TRACE_SCOPE(span, "BackupManager::restoreFromBackup");
+    if (!fs::exists(backupPath)) { lastError = "Backup file does not exist: " + backupPath; return false; }
+    if (hasCompressedExtension(backupPath)) {
+        MappedFile compressed;
+        if (!compressed.open(backupPath)) { lastError = "Failed to read backup: " + compressed.getLastError(); return false; }
+        std::string error;
+        return replaceOriginal([&](int fd) {
+            if (Compression::decompressToFile(compressed.view(), fd, Compression::detect(compressed.view()), error)) return true;
+            lastError = "Failed to decompress backup " + backupPath + ": " + error;
+            return false;
+        });
+    }
+    std::string content;
+    if (!loadContent(backupPath, content)) return false;
+    return replaceOriginal([&](int fd) {
+        if (writeFully(fd, content)) return true;
+        lastError = "Failed to restore from backup: cannot write " + originalFilePath;
+        return false;
+    });
+}
+// Like ConfigEditor::commit: the content goes to a synced temporary file next to the config (behind any
+// symlink) that then replaces it, so a crash or a full disk midway leaves the old config intact. An existing
+// config keeps its mode and owner; a missing one is created 0644.
+bool BackupManager::replaceOriginal(const std::function<bool(int fd)>& write) {
+    std::error_code ec;
+    fs::path target = fs::exists(originalFilePath, ec) ? fs::canonical(originalFilePath, ec) : fs::absolute(originalFilePath, ec);
+    if (ec) { lastError = "Cannot resolve config file: " + originalFilePath; return false; }
+    struct stat sb;
+    const bool existed = stat(target.c_str(), &sb) == 0;
+    std::string tempPath = (target.parent_path() / ("." + target.filename().string() + ".aliacan-XXXXXX")).string();
+    int fd = mkstemp(tempPath.data());
+    if (fd < 0) { lastError = "Failed to restore from backup: cannot create temporary file: " + std::string(std::strerror(errno)); return false; }
+    if (existed && fchown(fd, sb.st_uid, sb.st_gid) != 0 && geteuid() == 0) lastError = "Cannot preserve config file ownership: " + originalFilePath;
+    bool ok = write(fd);
+    if (ok && (fchmod(fd, existed ? sb.st_mode & 07777 : 0644) != 0 || fsync(fd) != 0)) {
+        lastError = "Failed to restore from backup: cannot write " + originalFilePath;
+        ok = false;
     }
-    if (!fs::exists(actualBackupPath)) { lastError = "Backup file does not exist: " + actualBackupPath; return false; }
-    try { fs::copy_file(actualBackupPath, originalFilePath, fs::copy_options::overwrite_existing); return true; } catch (const std::exception& e) { lastError = std::string("Failed to restore from backup: ") + e.what(); return false; }
+    if (::close(fd) != 0 && ok) {
+        lastError = "Failed to restore from backup: cannot write " + originalFilePath;
+        ok = false;
+    }
+    if (ok && ::rename(tempPath.c_str(), target.c_str()) != 0) {
+        lastError = "Failed to restore from backup: " + std::string(std::strerror(errno));
+        ok = false;
+    }
+    if (!ok) ::unlink(tempPath.c_str());
+    return ok;
 }
 std::vector<std::string> BackupManager::listBackups() const {
     std::vector<std::string> backups;
-    std::string backupPattern = getBackupBaseName();
+    for (const auto& snapshot : listSnapshots()) backups.push_back(snapshot.path);
+    return backups;
+}
+std::vector<BackupManager::Snapshot> BackupManager::listSnapshots() const {
+    TRACE_SCOPE(span, "BackupManager::listSnapshots");
+    std::vector<Snapshot> snapshots = loadManifest();
+    TRACE_ARG(span, "snapshots", snapshots.size());
+    std::reverse(snapshots.begin(), snapshots.end());
+    return snapshots;
+}
+std::vector<BackupManager::Snapshot> BackupManager::scanLegacyBackups(const std::string& backupPattern) const {
+    std::vector<Snapshot> backups;
     try {
         for (const auto& entry : fs::directory_iterator(getBackupDirectory())) {
             if (entry.is_regular_file()) {
                 std::string filename = entry.path().filename().string();
-                if (filename.find(backupPattern) != std::string::npos) backups.push_back(entry.path().string());
+                if (filename.find(backupPattern) == std::string::npos || filename.ends_with(".tmp") || filename.find(".tmp.") != std::string::npos) continue;
+                auto modified = std::chrono::file_clock::to_sys(entry.last_write_time());
+                backups.push_back(Snapshot{entry.path().string(), "", std::chrono::duration_cast<std::chrono::nanoseconds>(modified.time_since_epoch()).count(), entry.file_size(), 0, codecFromExtension(filename)});
             }
         }
     } catch (...) {}
     return backups;
 }
 std::string BackupManager::getBackupDirectory() const {
-    const char* homeDir = std::getenv("HOME");
-    if (!homeDir) return fs::path(originalFilePath).parent_path().string();
-    fs::path backupDir = fs::path(homeDir) / ".shellbackup";
-    if (!fs::exists(backupDir)) { try { fs::create_directories(backupDir); } catch (...) { return fs::path(originalFilePath).parent_path().string(); } }
+    fs::path backupDir = backupDirectory;
+    if (backupDir.empty()) {
+        const char* homeDir = std::getenv("HOME");
+        if (!homeDir) return fs::path(originalFilePath).parent_path().string();
+        backupDir = fs::path(homeDir) / ".shellbackup";
+    }
+    if (!fs::exists(backupDir)) {
+        try { fs::create_directories(backupDir); } catch (...) { return fs::path(originalFilePath).parent_path().string(); }
+        if (struct stat sb; stat(backupDir.parent_path().c_str(), &sb) == 0 && lchown(backupDir.c_str(), sb.st_uid, sb.st_gid) != 0) lastError = "Cannot transfer backup directory ownership: " + backupDir.string();
+    }
     return backupDir.string();
 }
+uint64_t BackupManager::getBackupDirectorySize() const {
+    TRACE_SCOPE(span, "BackupManager::getBackupDirectorySize");
+    uint64_t total = 0;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(getBackupDirectory(), ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec)) total += it->file_size(ec);
+    }
+    return total;
+}
 std::string BackupManager::getLastBackupPath() const {
-    std::vector<std::string> backups = listBackups();
-    if (backups.empty()) return "";
-    std::vector<std::pair<std::string, fs::file_time_type>> backupsWithTime;
-    for (const auto& backup : backups) { try { backupsWithTime.emplace_back(backup, fs::last_write_time(backup)); } catch (...) { continue; } }
-    if (backupsWithTime.empty()) return "";
-    std::sort(backupsWithTime.begin(), backupsWithTime.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
-    return backupsWithTime[0].first;
+    Snapshot latest;
+    return latestSnapshot(latest) ? latest.path : "";
 }
 bool BackupManager::restoreFromLastBackup() {
     std::string lastBackup = getLastBackupPath();
@@ -79,12 +238,352 @@ std::string BackupManager::getOriginalFilePath() const { return originalFilePath
 std::string BackupManager::generateTimestamp() {
     auto now = std::chrono::system_clock::now();
     auto time = std::chrono::system_clock::to_time_t(now);
+    std::tm local{};
+    localtime_r(&time, &local);
     std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y%m%d_%H%M%S");
+    ss << std::put_time(&local, "%Y%m%d_%H%M%S");
     return ss.str();
 }
-std::string BackupManager::getBackupBaseName() const { return fs::path(originalFilePath).filename().string() + ".bak"; }
+std::string BackupManager::getBackupBaseName() const { return configKey + ".bak"; }
+// Configs that share a backup directory and a file name (~/.bashrc and /srv/x/.bashrc) must not share an index,
+// so everything per config is named after the file and a hash of its absolute, canonical path.
+std::string BackupManager::keyFor(const std::string& path) {
+    std::error_code ec;
+    fs::path absolute = fs::weakly_canonical(fs::absolute(path, ec), ec);
+    if (ec) absolute = fs::absolute(path, ec);
+    return fs::path(path).filename().string() + "." + Sha256::hex(absolute.string()).substr(0, 16);
+}
+std::string BackupManager::indexPath(std::string_view name, std::string_view extension) const { return (fs::path(getBackupDirectory()) / (std::string(name) + std::string(extension))).string(); }
 std::string BackupManager::getLastError() const { return lastError; }
+void BackupManager::setKeyframeInterval(int interval) { keyframeInterval = std::max(1, interval); }
+void BackupManager::setMaxBackups(int count) { maxBackups = count > 0 ? count : 20; }
+void BackupManager::setCompression(Compression::Codec newCodec, int level) {
+    codec = Compression::isAvailable(newCodec) ? newCodec : Compression::Codec::NONE;
+    compressionLevel = level < 0 ? Compression::defaultLevel(codec) : level;
+}
+Compression::Codec BackupManager::getCompressionCodec() const { return codec; }
+void BackupManager::waitForBackgroundWork() { BackgroundWorker::shared().waitIdle(); }
+size_t BackupManager::getChainLength(const std::string& backupPath) const {
+    ObjectHeader header;
+    std::string body;
+    size_t length = 0;
+    int expectedDepth = -1;
+    for (std::string path = backupPath; readObjectHeader(path, header) && header.delta && header.depth >= 1 && (expectedDepth < 0 || header.depth == expectedDepth); path = getObjectPath(header.base)) {
+        expectedDepth = header.depth - 1;
+        ++length;
+    }
+    return length;
+}
 bool BackupManager::isNewer(const std::string& file1, const std::string& file2) {
     try { return fs::last_write_time(file1) > fs::last_write_time(file2); } catch (...) { return false; }
 }
+std::string BackupManager::getSnapshotLogPath() const { return indexPath(configKey, ".snapshots"); }
+std::string BackupManager::getObjectPath(const std::string& hash) const { return (fs::path(getBackupDirectory()) / "objects" / hash.substr(0, 2) / hash.substr(2)).string(); }
+std::vector<BackupManager::Snapshot> BackupManager::readSnapshotLog(const std::string& logPath) const {
+    std::vector<Snapshot> snapshots;
+    std::ifstream log(logPath);
+    std::string line;
+    while (std::getline(log, line)) {
+        std::istringstream fields(line);
+        Snapshot snapshot;
+        if (!(fields >> snapshot.timestamp >> snapshot.size >> snapshot.sourceMtime >> snapshot.hash) || snapshot.hash.size() != 64) continue;
+        snapshot.path = getObjectPath(snapshot.hash);
+        snapshots.push_back(std::move(snapshot));
+    }
+    return snapshots;
+}
+std::string BackupManager::getManifestPath() const { return indexPath(configKey, ".manifest"); }
+BackupManager::Snapshot BackupManager::toSnapshot(const BackupManifest::Record& record) const {
+    bool legacy = record.kind == BackupManifest::Kind::LEGACY;
+    return Snapshot{legacy ? (fs::path(getBackupDirectory()) / record.name).string() : getObjectPath(record.name), legacy ? "" : record.name, record.timestamp, record.size, record.sourceMtime, record.codec};
+}
+BackupManifest::Record BackupManager::toRecord(const Snapshot& snapshot) {
+    bool legacy = snapshot.hash.empty();
+    return BackupManifest::Record{snapshot.timestamp, snapshot.size, snapshot.sourceMtime, snapshot.codec, legacy ? BackupManifest::Kind::LEGACY : BackupManifest::Kind::OBJECT, BackupManifest::Op::ADD, legacy ? fs::path(snapshot.path).filename().string() : snapshot.hash};
+}
+std::vector<BackupManager::Snapshot> BackupManager::loadManifest() const {
+    std::vector<BackupManifest::Record> records;
+    if (!BackupManifest(getManifestPath()).read(records)) return rebuildManifest(records);
+    std::vector<Snapshot> snapshots;
+    snapshots.reserve(records.size());
+    for (const auto& record : records) snapshots.push_back(toSnapshot(record));
+    return snapshots;
+}
+std::vector<BackupManager::Snapshot> BackupManager::rebuildManifest(const std::vector<BackupManifest::Record>& salvaged) const {
+    std::vector<Snapshot> candidates;
+    for (const auto& record : salvaged) candidates.push_back(toSnapshot(record));
+    std::vector<Snapshot> logged = readSnapshotLog(getSnapshotLogPath());
+    std::vector<Snapshot> legacy = scanLegacyBackups(getBackupBaseName());
+    // Without an index of its own the config may predate keyed names: the history kept under its bare file
+    // name is copied in. It is left in place, as another config with the same name may own part of it.
+    const std::string filename = fs::path(originalFilePath).filename().string();
+    const bool migrating = !fs::exists(getManifestPath());
+    if (migrating) {
+        std::vector<BackupManifest::Record> unkeyed;
+        BackupManifest(indexPath(filename, ".manifest")).read(unkeyed);
+        for (const auto& record : unkeyed) candidates.push_back(toSnapshot(record));
+        std::vector<Snapshot> unkeyedLog = readSnapshotLog(indexPath(filename, ".snapshots"));
+        std::vector<Snapshot> unkeyedLegacy = scanLegacyBackups(filename + ".bak");
+        logged.insert(logged.end(), unkeyedLog.begin(), unkeyedLog.end());
+        legacy.insert(legacy.end(), unkeyedLegacy.begin(), unkeyedLegacy.end());
+    }
+    ObjectHeader header;
+    std::error_code ec;
+    for (const auto& entry : fs::recursive_directory_iterator(fs::path(getBackupDirectory()) / "objects", ec)) {
+        std::string hash = hashFromObjectPath(entry.path().string());
+        if (hash.empty() || !readObjectHeader(entry.path().string(), header) || header.timestamp <= 0) continue;
+        if (header.origin == configKey || (migrating && header.origin == filename)) candidates.push_back(Snapshot{entry.path().string(), hash, header.timestamp, header.size, header.sourceMtime, header.codec});
+    }
+    candidates.insert(candidates.end(), logged.begin(), logged.end());
+    candidates.insert(candidates.end(), legacy.begin(), legacy.end());
+    std::unordered_set<std::string> seen;
+    std::vector<Snapshot> snapshots;
+    for (auto& candidate : candidates) {
+        std::string key = candidate.hash.empty() ? candidate.path : std::to_string(candidate.timestamp) + candidate.hash;
+        if (!seen.insert(key).second || !fs::exists(candidate.path)) continue;
+        if (!candidate.hash.empty() && readObjectHeader(candidate.path, header)) candidate.codec = header.codec;
+        snapshots.push_back(std::move(candidate));
+    }
+    std::stable_sort(snapshots.begin(), snapshots.end(), [](const Snapshot& a, const Snapshot& b) { return a.timestamp < b.timestamp; });
+    for (size_t i = 1; i < snapshots.size(); ++i) snapshots[i].timestamp = std::max(snapshots[i].timestamp, snapshots[i - 1].timestamp + 1);
+    if (writeManifest(snapshots)) fs::remove(getSnapshotLogPath(), ec);
+    scheduleLegacyCompression(snapshots);
+    return snapshots;
+}
+bool BackupManager::latestSnapshot(Snapshot& snapshot) const {
+    BackupManifest::Record record;
+    if (BackupManifest(getManifestPath()).latest(record)) {
+        snapshot = toSnapshot(record);
+        return true;
+    }
+    std::vector<Snapshot> snapshots = loadManifest();
+    if (snapshots.empty()) return false;
+    snapshot = snapshots.back();
+    return true;
+}
+bool BackupManager::writeManifest(const std::vector<Snapshot>& snapshots) const {
+    std::vector<BackupManifest::Record> records;
+    records.reserve(snapshots.size());
+    for (const auto& snapshot : snapshots) records.push_back(toRecord(snapshot));
+    BackupManifest manifest(getManifestPath());
+    if (!manifest.rewrite(records)) { lastError = "Failed to write backup manifest: " + manifest.getPath(); return false; }
+    adoptManifestOwner();
+    return true;
+}
+bool BackupManager::rewriteManifest(const std::function<void(std::vector<BackupManifest::Record>&)>& edit, const std::function<void()>& whileLocked) const {
+    if (!BackupManifest(getManifestPath()).rewrite(edit, whileLocked)) return false;
+    adoptManifestOwner();
+    return true;
+}
+void BackupManager::adoptManifestOwner() const {
+    if (struct stat sb; stat(getBackupDirectory().c_str(), &sb) == 0 && lchown(getManifestPath().c_str(), sb.st_uid, sb.st_gid) != 0) lastError = "Cannot transfer manifest ownership: " + getManifestPath();
+}
+bool BackupManager::appendToManifest(const Snapshot& snapshot) const {
+    BackupManifest manifest(getManifestPath());
+    if (manifest.append(toRecord(snapshot))) return true;
+    loadManifest();
+    if (manifest.append(toRecord(snapshot))) return true;
+    lastError = "Failed to append to backup manifest: " + manifest.getPath();
+    return false;
+}
+bool BackupManager::storeObject(const Snapshot& snapshot, std::string_view content, const Snapshot* previous) const {
+    if (fs::exists(snapshot.path)) return true;
+    std::error_code ec;
+    fs::create_directories(fs::path(snapshot.path).parent_path(), ec);
+    ObjectHeader header;
+    header.size = content.size();
+    header.timestamp = snapshot.timestamp;
+    header.sourceMtime = snapshot.sourceMtime;
+    header.origin = configKey;
+    std::string delta;
+    ObjectHeader previousHeader;
+    std::string previousContent;
+    if (previous != nullptr && keyframeInterval > 1 && readObjectHeader(previous->path, previousHeader) && previousHeader.depth + 1 < keyframeInterval && loadContent(previous->path, previousContent)) {
+        delta = LineDelta::encode(previousContent, content);
+        if (delta.size() < content.size()) {
+            header.delta = true;
+            header.base = previous->hash;
+            header.depth = previousHeader.depth + 1;
+        } else delta.clear();
+    }
+    std::string_view body = delta.empty() ? content : std::string_view(delta);
+    // Synced before it is renamed into place: the config edit this backup precedes is, so after a crash the
+    // object is never torn while the edit survived. The name is unique, so two processes storing the same
+    // content each write a whole file of their own.
+    std::string tempPath = snapshot.path + ".tmp.XXXXXX";
+    int fd = mkstemp(tempPath.data());
+    if (fd < 0) { lastError = "Failed to create backup: cannot create temporary file: " + std::string(std::strerror(errno)); return false; }
+    bool ok = writeFully(fd, formatObjectHeader(header)) && writeFully(fd, body) && fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok) lastError = "Failed to create backup: cannot write " + tempPath;
+    else if (::rename(tempPath.c_str(), snapshot.path.c_str()) != 0) {
+        lastError = "Failed to create backup: " + std::string(std::strerror(errno));
+        ok = false;
+    }
+    if (!ok) ::unlink(tempPath.c_str());
+    return ok;
+}
+std::string BackupManager::formatObjectHeader(const ObjectHeader& header) {
+    std::string line = std::string(OBJECT_MAGIC) + (header.delta ? "delta " : "full ") + std::to_string(header.size);
+    if (header.delta) line += " " + header.base + " " + std::to_string(header.depth);
+    if (header.codec != Compression::Codec::NONE || !header.origin.empty()) line += " " + Compression::codecName(header.codec);
+    if (!header.origin.empty()) line += " " + std::to_string(header.timestamp) + " " + std::to_string(header.sourceMtime) + " " + header.origin;
+    return line + "\n";
+}
+bool BackupManager::parseObjectHeader(std::string& data, ObjectHeader& header) {
+    header = ObjectHeader{};
+    if (!data.starts_with(OBJECT_MAGIC)) {
+        header.size = data.size();
+        return true;
+    }
+    size_t newline = data.find('\n');
+    if (newline == std::string::npos) return false;
+    std::istringstream fields(data.substr(OBJECT_MAGIC.size(), newline - OBJECT_MAGIC.size()));
+    std::string kind, codecName;
+    fields >> kind >> header.size;
+    header.delta = kind == "delta";
+    if (header.delta) fields >> header.base >> header.depth;
+    if (!fields || (kind != "full" && !header.delta) || (header.delta && header.base.size() != 64)) return false;
+    if (fields >> codecName && !Compression::codecFromName(codecName, header.codec)) return false;
+    if (fields >> header.timestamp >> header.sourceMtime) {
+        std::getline(fields >> std::ws, header.origin);
+    } else {
+        header.timestamp = header.sourceMtime = 0;
+    }
+    data.erase(0, newline + 1);
+    return true;
+}
+void BackupManager::compressObject(const std::string& objectPath, Compression::Codec codec, int level, const BackupManifest& manifest, BackupManifest::Record record) {
+    TRACE_SCOPE(span, "BackupManager::compressObject");
+    struct stat sb;
+    std::ifstream object(objectPath, std::ios::binary);
+    if (!object.is_open() || stat(objectPath.c_str(), &sb) != 0) return;
+    std::string body(std::istreambuf_iterator<char>(object), {});
+    ObjectHeader header;
+    if (!parseObjectHeader(body, header) || header.codec != Compression::Codec::NONE || body.size() < MIN_COMPRESS_SIZE) return;
+    std::string compressed, error;
+    if (!Compression::compress(body, compressed, codec, level, error) || compressed.size() >= body.size()) return;
+    header.codec = codec;
+    if (!replaceFileLike(objectPath, formatObjectHeader(header) + compressed, sb)) return;
+    record.codec = codec;
+    record.op = BackupManifest::Op::UPDATE;
+    manifest.append(record);
+}
+void BackupManager::compressLegacyBackup(const std::string& backupPath, Compression::Codec codec, int level, const BackupManifest& manifest, BackupManifest::Record record) {
+    TRACE_SCOPE(span, "BackupManager::compressLegacyBackup");
+    struct stat sb;
+    MappedFile original;
+    if (stat(backupPath.c_str(), &sb) != 0 || !original.open(backupPath)) return;
+    std::string compressed, error;
+    if (!Compression::compress(original.view(), compressed, codec, level, error)) return;
+    std::string compressedPath = backupPath + Compression::fileExtension(codec);
+    if (!replaceFileLike(compressedPath, compressed, sb)) return;
+    unlink(backupPath.c_str());
+    record.name = fs::path(compressedPath).filename().string();
+    record.codec = codec;
+    record.size = compressed.size();
+    record.op = BackupManifest::Op::UPDATE;
+    manifest.append(record);
+}
+bool BackupManager::readObjectHeader(const std::string& objectPath, ObjectHeader& header) const {
+    std::ifstream object(objectPath, std::ios::binary);
+    if (!object.is_open()) { lastError = "Backup file does not exist: " + objectPath; return false; }
+    std::string line(OBJECT_MAGIC.size(), '\0');
+    object.read(line.data(), static_cast<std::streamsize>(line.size()));
+    line.resize(static_cast<size_t>(object.gcount()));
+    if (line == OBJECT_MAGIC) {
+        std::string rest;
+        std::getline(object, rest);
+        line += rest + "\n";
+    }
+    if (!parseObjectHeader(line, header)) { lastError = "Corrupted backup object: " + objectPath; return false; }
+    return true;
+}
+bool BackupManager::readObject(const std::string& objectPath, ObjectHeader& header, std::string& body) const {
+    std::ifstream object(objectPath, std::ios::binary);
+    if (!object.is_open()) { lastError = "Backup file does not exist: " + objectPath; return false; }
+    body.assign(std::istreambuf_iterator<char>(object), {});
+    if (!parseObjectHeader(body, header)) { lastError = "Corrupted backup object: " + objectPath; return false; }
+    if (header.codec == Compression::Codec::NONE) return true;
+    std::string decoded, error;
+    if (!Compression::decompress(body, decoded, header.codec, error)) { lastError = "Corrupted backup object " + objectPath + ": " + error; return false; }
+    body.swap(decoded);
+    return true;
+}
+bool BackupManager::loadContent(const std::string& backupPath, std::string& content) const {
+    std::vector<std::string> deltas;
+    ObjectHeader header;
+    std::string body;
+    std::string path = backupPath;
+    int expectedDepth = -1;
+    while (true) {
+        if (!readObject(path, header, body)) return false;
+        if (!header.delta) break;
+        if (header.depth < 1 || (expectedDepth >= 0 && header.depth != expectedDepth)) { lastError = "Corrupted backup chain: " + backupPath; return false; }
+        expectedDepth = header.depth - 1;
+        deltas.push_back(std::move(body));
+        path = getObjectPath(header.base);
+    }
+    content = std::move(body);
+    std::string next;
+    for (auto delta = deltas.rbegin(); delta != deltas.rend(); ++delta) {
+        if (!LineDelta::apply(content, *delta, next)) { lastError = "Corrupted backup delta in chain of " + backupPath; return false; }
+        content.swap(next);
+    }
+    std::string expected = hashFromObjectPath(backupPath);
+    if (!expected.empty() && Sha256::hex(content) != expected) { lastError = "Backup failed integrity check: " + backupPath; return false; }
+    return true;
+}
+std::string BackupManager::hashFromObjectPath(const std::string& objectPath) {
+    fs::path path(objectPath);
+    if (path.parent_path().parent_path().filename() != "objects") return "";
+    std::string hash = path.parent_path().filename().string() + path.filename().string();
+    return hash.size() == 64 ? hash : "";
+}
+int BackupManager::collectUnreferencedObjects() const {
+    std::unordered_set<std::string> referenced;
+    fs::path backupDir = getBackupDirectory();
+    std::error_code ec;
+    std::vector<BackupManifest::Record> records;
+    std::unordered_set<std::string> indexedConfigs;
+    std::unordered_map<std::string, int64_t> newestRecord;
+    for (const auto& entry : fs::directory_iterator(backupDir, ec)) {
+        if (entry.path().extension() == ".manifest" || entry.path().extension() == ".snapshots") indexedConfigs.insert(entry.path().stem().string());
+        if (entry.path().extension() == ".manifest") {
+            if (!BackupManifest(entry.path().string()).read(records)) return 0;
+            for (const auto& record : records) {
+                if (record.kind == BackupManifest::Kind::OBJECT) referenced.insert(record.name);
+            }
+            if (!records.empty()) newestRecord[entry.path().stem().string()] = records.back().timestamp;
+            continue;
+        }
+        if (entry.path().extension() != ".snapshots") continue;
+        std::ifstream log(entry.path());
+        std::string line;
+        while (std::getline(log, line)) {
+            if (size_t space = line.rfind(' '); space != std::string::npos) referenced.insert(line.substr(space + 1));
+        }
+    }
+    std::vector<std::string> pending(referenced.begin(), referenced.end());
+    ObjectHeader header;
+    while (!pending.empty()) {
+        std::string hash = std::move(pending.back());
+        pending.pop_back();
+        if (readObjectHeader(getObjectPath(hash), header) && header.delta && referenced.insert(header.base).second) pending.push_back(header.base);
+    }
+    int removed = 0;
+    // Only files named like a finished object are swept: temporary files next to one belong to a backup or a
+    // background compression that is still writing. An object newer than every record of its config was stored
+    // by a backup that has yet to append it.
+    for (const auto& entry : fs::recursive_directory_iterator(backupDir / "objects", ec)) {
+        if (!entry.is_regular_file()) continue;
+        std::string hash = hashFromObjectPath(entry.path().string());
+        if (hash.empty() || referenced.contains(hash)) continue;
+        if (readObjectHeader(entry.path().string(), header) && !header.origin.empty()) {
+            auto newest = newestRecord.find(header.origin);
+            if (!indexedConfigs.contains(header.origin) || (newest != newestRecord.end() && header.timestamp > newest->second)) continue;
+        }
+        if (fs::remove(entry.path(), ec)) ++removed;
+    }
+    return removed;
+}
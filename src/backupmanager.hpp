@@ -1,26 +1,91 @@
 #pragma once
+#include "backupmanifest.hpp"
+#include "compression.hpp"
 #include <string>
 #include <filesystem>
 #include <ctime>
+#include <cstdint>
+#include <functional>
+#include <string_view>
 #include <vector>
 
 class BackupManager {
 public:
-    explicit BackupManager(const std::string& originalFilePath);
+    struct Snapshot {
+        std::string path;
+        std::string hash;
+        int64_t timestamp = 0;
+        uint64_t size = 0;
+        int64_t sourceMtime = 0;
+        Compression::Codec codec = Compression::Codec::NONE;
+    };
+    explicit BackupManager(const std::string& originalFilePath, const std::string& backupDirectory = "");
     std::string createBackup();
     std::string getLastBackupPath() const;
     std::vector<std::string> listBackups() const;
+    std::vector<Snapshot> listSnapshots() const;
     bool restoreFromLastBackup();
     bool restoreFromBackup(const std::string& backupPath);
     std::string getOriginalFilePath() const;
     std::string getBackupDirectory() const;
+    std::string getManifestPath() const;
+    uint64_t getBackupDirectorySize() const;
     int cleanupOldBackups(int keepCount = 10);
     int cleanupAndCompressOldBackups(int maxBackups);
     std::string getLastError() const;
+    void setKeyframeInterval(int interval);
+    void setMaxBackups(int maxBackups);
+    size_t getChainLength(const std::string& backupPath) const;
+    void setCompression(Compression::Codec codec, int level = -1);
+    Compression::Codec getCompressionCodec() const;
+    static void waitForBackgroundWork();
 private:
+    struct ObjectHeader {
+        bool delta = false;
+        uint64_t size = 0;
+        std::string base;
+        int depth = 0;
+        Compression::Codec codec = Compression::Codec::NONE;
+        int64_t timestamp = 0;
+        int64_t sourceMtime = 0;
+        std::string origin;
+    };
     std::string originalFilePath;
+    std::string backupDirectory;
+    std::string configKey;
+    int keyframeInterval = 64;
+    int maxBackups = 20;
+    Compression::Codec codec = Compression::defaultCodec();
+    int compressionLevel = Compression::defaultLevel(Compression::defaultCodec());
     mutable std::string lastError;
     static std::string generateTimestamp();
     std::string getBackupBaseName() const;
     static bool isNewer(const std::string& file1, const std::string& file2);
+    static std::string keyFor(const std::string& path);
+    std::string indexPath(std::string_view name, std::string_view extension) const;
+    std::string getSnapshotLogPath() const;
+    std::string getObjectPath(const std::string& hash) const;
+    std::vector<Snapshot> readSnapshotLog(const std::string& logPath) const;
+    std::vector<Snapshot> loadManifest() const;
+    std::vector<Snapshot> rebuildManifest(const std::vector<BackupManifest::Record>& salvaged) const;
+    bool latestSnapshot(Snapshot& snapshot) const;
+    bool writeManifest(const std::vector<Snapshot>& snapshots) const;
+    bool rewriteManifest(const std::function<void(std::vector<BackupManifest::Record>&)>& edit, const std::function<void()>& whileLocked) const;
+    void adoptManifestOwner() const;
+    bool appendToManifest(const Snapshot& snapshot) const;
+    Snapshot toSnapshot(const BackupManifest::Record& record) const;
+    static BackupManifest::Record toRecord(const Snapshot& snapshot);
+    void scheduleLegacyCompression(const std::vector<Snapshot>& snapshots) const;
+    bool storeObject(const Snapshot& snapshot, std::string_view content, const Snapshot* previous) const;
+    bool readObject(const std::string& objectPath, ObjectHeader& header, std::string& body) const;
+    bool readObjectHeader(const std::string& objectPath, ObjectHeader& header) const;
+    static std::string formatObjectHeader(const ObjectHeader& header);
+    static bool parseObjectHeader(std::string& data, ObjectHeader& header);
+    static void compressObject(const std::string& objectPath, Compression::Codec codec, int level, const BackupManifest& manifest, BackupManifest::Record record);
+    static void compressLegacyBackup(const std::string& backupPath, Compression::Codec codec, int level, const BackupManifest& manifest, BackupManifest::Record record);
+    bool loadContent(const std::string& backupPath, std::string& content) const;
+    bool replaceOriginal(const std::function<bool(int fd)>& write);
+    static std::string hashFromObjectPath(const std::string& objectPath);
+    std::vector<Snapshot> scanLegacyBackups(const std::string& baseName) const;
+    int collectUnreferencedObjects() const;
 };
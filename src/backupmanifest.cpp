@@ -0,0 +1,180 @@
+#include "backupmanifest.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <map>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr size_t NAME_OFFSET = 71;
+static constexpr size_t CHECKSUM_OFFSET = NAME_OFFSET + BackupManifest::MAX_NAME_LENGTH + 1;
+static constexpr std::string_view MANIFEST_MAGIC = "ALIACAN-MANIFEST 1";
+
+static bool writeAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+    return true;
+}
+static std::string sealRecord(std::string body) {
+    body.resize(CHECKSUM_OFFSET - 1, ' ');
+    char checksum[16];
+    std::snprintf(checksum, sizeof(checksum), " %08x\n", Compression::crc32(body));
+    return body + checksum;
+}
+static bool checkSeal(std::string_view line) {
+    if (line.size() != BackupManifest::RECORD_SIZE || line.back() != '\n' || line[CHECKSUM_OFFSET - 1] != ' ') return false;
+    uint32_t expected = 0;
+    auto result = std::from_chars(line.data() + CHECKSUM_OFFSET, line.data() + CHECKSUM_OFFSET + 8, expected, 16);
+    return result.ec == std::errc() && result.ptr == line.data() + CHECKSUM_OFFSET + 8 && Compression::crc32(line.substr(0, CHECKSUM_OFFSET - 1)) == expected;
+}
+template <typename T> static bool parseField(std::string_view field, T& value) {
+    while (!field.empty() && field.front() == '0' && field.size() > 1) field.remove_prefix(1);
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+static void applyRecord(std::map<int64_t, BackupManifest::Record>& resolved, BackupManifest::Record record) {
+    if (record.op == BackupManifest::Op::UPDATE && !resolved.contains(record.timestamp)) return;
+    record.op = BackupManifest::Op::ADD;
+    resolved[record.timestamp] = std::move(record);
+}
+
+BackupManifest::BackupManifest(std::string path) : path(std::move(path)) {}
+const std::string& BackupManifest::getPath() const { return path; }
+std::string BackupManifest::header() { return sealRecord(std::string(MANIFEST_MAGIC)); }
+std::string BackupManifest::encode(const Record& record) {
+    char fields[NAME_OFFSET + 1];
+    std::snprintf(fields, sizeof(fields), "%020lld %020llu %020lld %-4s %c%c ", static_cast<long long>(record.timestamp), static_cast<unsigned long long>(record.size), static_cast<long long>(record.sourceMtime), Compression::codecName(record.codec).c_str(), static_cast<char>(record.kind), static_cast<char>(record.op));
+    return sealRecord(std::string(fields) + record.name);
+}
+bool BackupManifest::decode(std::string_view line, Record& record) {
+    if (!checkSeal(line) || line.starts_with(MANIFEST_MAGIC)) return false;
+    record = Record{};
+    std::string_view codec = line.substr(63, 4);
+    codec = codec.substr(0, codec.find(' '));
+    if (!parseField(line.substr(0, 20), record.timestamp) || !parseField(line.substr(21, 20), record.size) || !parseField(line.substr(42, 20), record.sourceMtime) || !Compression::codecFromName(codec, record.codec)) return false;
+    if (line[68] != 'O' && line[68] != 'L') return false;
+    if (line[69] != '+' && line[69] != '~') return false;
+    record.kind = static_cast<Kind>(line[68]);
+    record.op = static_cast<Op>(line[69]);
+    std::string_view name = line.substr(NAME_OFFSET, MAX_NAME_LENGTH);
+    name = name.substr(0, name.find_last_not_of(' ') + 1);
+    record.name.assign(name);
+    return !record.name.empty();
+}
+bool BackupManifest::read(std::vector<Record>& records) const {
+    records.clear();
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    std::string line(RECORD_SIZE, '\0');
+    bool intact = std::fread(line.data(), 1, RECORD_SIZE, file) == RECORD_SIZE && checkSeal(line) && line.starts_with(MANIFEST_MAGIC);
+    std::map<int64_t, Record> resolved;
+    size_t got;
+    while ((got = std::fread(line.data(), 1, RECORD_SIZE, file)) > 0) {
+        Record record;
+        if (got == RECORD_SIZE && decode(line, record)) applyRecord(resolved, std::move(record));
+        else intact = false;
+    }
+    std::fclose(file);
+    for (auto& entry : resolved) records.push_back(std::move(entry.second));
+    return intact;
+}
+bool BackupManifest::latest(Record& record) const {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat sb;
+    bool found = false;
+    if (fstat(fd, &sb) == 0 && sb.st_size > 0 && static_cast<size_t>(sb.st_size) % RECORD_SIZE == 0) {
+        std::vector<Record> updates;
+        std::string line(RECORD_SIZE, '\0');
+        for (off_t offset = sb.st_size - static_cast<off_t>(RECORD_SIZE); offset > 0; offset -= static_cast<off_t>(RECORD_SIZE)) {
+            Record candidate;
+            if (pread(fd, line.data(), RECORD_SIZE, offset) != static_cast<ssize_t>(RECORD_SIZE) || !decode(line, candidate)) break;
+            if (candidate.op == Op::UPDATE) {
+                updates.push_back(std::move(candidate));
+                continue;
+            }
+            auto update = std::find_if(updates.begin(), updates.end(), [&](const Record& u) { return u.timestamp == candidate.timestamp; });
+            record = update == updates.end() ? std::move(candidate) : std::move(*update);
+            record.op = Op::ADD;
+            found = true;
+            break;
+        }
+    }
+    ::close(fd);
+    return found;
+}
+size_t BackupManifest::recordCount() const {
+    struct stat sb;
+    if (stat(path.c_str(), &sb) != 0 || sb.st_size < static_cast<off_t>(RECORD_SIZE)) return 0;
+    return static_cast<size_t>(sb.st_size) / RECORD_SIZE - 1;
+}
+bool BackupManifest::append(const Record& record) const {
+    if (record.name.empty() || record.name.size() > MAX_NAME_LENGTH || record.name.find('\n') != std::string::npos) return false;
+    std::string line = encode(record);
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat sb;
+        bool ok = flock(fd, LOCK_EX) == 0 && fstat(fd, &sb) == 0;
+        if (ok && sb.st_nlink == 0) {
+            ::close(fd);
+            continue;
+        }
+        ok = ok && static_cast<size_t>(sb.st_size) % RECORD_SIZE == 0 && writeAll(fd, line);
+        ok = ::close(fd) == 0 && ok;
+        return ok;
+    }
+    return false;
+}
+bool BackupManifest::rewrite(const std::vector<Record>& records) const {
+    return replace([&](std::vector<Record>& current) { current = records; }, false, {});
+}
+// Reads, edits and swaps the manifest in under one exclusive lock, so a record appended meanwhile by another
+// process is either in what `edit` sees or waits for the new manifest; `whileLocked` runs before it is released.
+bool BackupManifest::rewrite(const std::function<void(std::vector<Record>&)>& edit, const std::function<void()>& whileLocked) const {
+    return replace(edit, true, whileLocked);
+}
+bool BackupManifest::replace(const std::function<void(std::vector<Record>&)>& edit, bool readFirst, const std::function<void()>& whileLocked) const {
+    int lockFd = -1;
+    for (int attempt = 0; attempt < 8 && lockFd < 0; ++attempt) {
+        lockFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (lockFd < 0) break;
+        struct stat sb;
+        if (flock(lockFd, LOCK_EX) == 0 && fstat(lockFd, &sb) == 0 && sb.st_nlink > 0) break;
+        ::close(lockFd);
+        lockFd = -1;
+    }
+    std::vector<Record> records;
+    if (readFirst && (lockFd < 0 || !read(records))) {
+        if (lockFd >= 0) ::close(lockFd);
+        return false;
+    }
+    edit(records);
+    std::string content = header();
+    for (const auto& record : records) {
+        if (record.name.empty() || record.name.size() > MAX_NAME_LENGTH || record.name.find('\n') != std::string::npos) continue;
+        Record added = record;
+        added.op = Op::ADD;
+        content += encode(added);
+    }
+    // The new manifest is locked before it is renamed into place, so appends that open it wait as well.
+    std::string tempPath = path + ".XXXXXX";
+    int fd = mkstemp(tempPath.data());
+    bool ok = fd >= 0 && flock(fd, LOCK_EX) == 0 && fchmod(fd, 0644) == 0 && writeAll(fd, content) && fsync(fd) == 0;
+    ok = ok && ::rename(tempPath.c_str(), path.c_str()) == 0;
+    if (!ok && fd >= 0) unlink(tempPath.c_str());
+    if (ok && whileLocked) whileLocked();
+    if (fd >= 0) ::close(fd);
+    if (lockFd >= 0) ::close(lockFd);
+    return ok;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "compression.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class BackupManifest {
+public:
+    enum class Kind : char { OBJECT = 'O', LEGACY = 'L' };
+    enum class Op : char { ADD = '+', UPDATE = '~' };
+    struct Record {
+        int64_t timestamp = 0;
+        uint64_t size = 0;
+        int64_t sourceMtime = 0;
+        Compression::Codec codec = Compression::Codec::NONE;
+        Kind kind = Kind::OBJECT;
+        Op op = Op::ADD;
+        std::string name;
+    };
+    static constexpr size_t RECORD_SIZE = 256;
+    static constexpr size_t MAX_NAME_LENGTH = 175;
+    explicit BackupManifest(std::string path);
+    const std::string& getPath() const;
+    bool read(std::vector<Record>& records) const;
+    bool latest(Record& record) const;
+    size_t recordCount() const;
+    bool append(const Record& record) const;
+    bool rewrite(const std::vector<Record>& records) const;
+    bool rewrite(const std::function<void(std::vector<Record>&)>& edit, const std::function<void()>& whileLocked = {}) const;
+    static std::string encode(const Record& record);
+    static bool decode(std::string_view line, Record& record);
+private:
+    std::string path;
+    static std::string header();
+    bool replace(const std::function<void(std::vector<Record>&)>& edit, bool readFirst, const std::function<void()>& whileLocked) const;
+};
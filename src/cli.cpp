@@ -0,0 +1,342 @@
+#include "cli.hpp"
+#include "aliasscanner.hpp"
+#include "backupmanager.hpp"
+#include "configfilehandler.hpp"
+#include "fleet.hpp"
+#include "historyusage.hpp"
+#include "pathindex.hpp"
+#include "suggestionminer.hpp"
+#include "syntaxchecker.hpp"
+#include "shelldetector.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+static constexpr std::string_view SUBCOMMANDS[] = {"list", "check", "usage", "suggest", "add", "rm", "import", "backup", "backups", "restore", "fleet", "help"};
+// More threads than this only add contention; each home is mostly file I/O.
+static constexpr size_t MAX_JOBS = 256;
+static constexpr std::string_view VALUE_OPTIONS[] = {"--shell", "--config", "--format"};
+
+static ShellDetector::Shell shellFromName(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (name == "bash") return ShellDetector::Shell::BASH;
+    if (name == "zsh") return ShellDetector::Shell::ZSH;
+    if (name == "fish") return ShellDetector::Shell::FISH;
+    return ShellDetector::Shell::UNKNOWN;
+}
+static int fail(std::ostream& out, std::string_view message, int code = 1) {
+    out << "{\"ok\":false,\"error\":" << Cli::jsonString(message) << "}\n";
+    return code;
+}
+bool Cli::isSubcommand(std::string_view name) {
+    return std::find(std::begin(SUBCOMMANDS), std::end(SUBCOMMANDS), name) != std::end(SUBCOMMANDS);
+}
+bool Cli::isCliInvocation(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h" || isSubcommand(arg)) return true;
+        if (std::find(std::begin(VALUE_OPTIONS), std::end(VALUE_OPTIONS), arg) != std::end(VALUE_OPTIONS)) { ++i; continue; }
+        if (arg == "--no-backup") continue;
+        return false;
+    }
+    return false;
+}
+bool Cli::parseOptions(const std::vector<std::string>& args, Options& options, std::ostream& err) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        if (std::find(std::begin(VALUE_OPTIONS), std::end(VALUE_OPTIONS), arg) != std::end(VALUE_OPTIONS)) {
+            if (i + 1 >= args.size()) { err << "alia-can: " << arg << " requires a value\n"; return false; }
+            const std::string& value = args[++i];
+            if (arg == "--shell") options.shell = value;
+            else if (arg == "--config") options.config = value;
+            else if (value == "json" || value == "tsv") options.format = value == "json" ? Format::JSON : Format::TSV;
+            else { err << "alia-can: unknown format '" << value << "'\n"; return false; }
+        } else if (arg == "--no-backup") {
+            options.backup = false;
+        } else if (arg == "--help" || arg == "-h") {
+            options.command = "help";
+        } else if (options.command.empty()) {
+            if (!isSubcommand(arg)) { err << "alia-can: unknown command '" << arg << "'\n"; return false; }
+            options.command = arg;
+        } else {
+            options.arguments.push_back(arg);
+        }
+    }
+    return !options.command.empty();
+}
+void Cli::printUsage(std::ostream& out) {
+    out << "Usage: alia-can [--shell bash|zsh|fish] [--config PATH] [--format json|tsv] [--no-backup] COMMAND\n"
+           "Commands:\n"
+           "  list                 List aliases defined in the config file\n"
+           "  check                List aliases that hide an executable on $PATH or call one that isn't there\n"
+           "  usage [HISTORY]      Count how often each alias was run, from the shell's history file\n"
+           "  suggest [HISTORY]    Propose aliases for long commands that the history shows are typed often\n"
+           "  add NAME COMMAND     Add an alias or update it in place\n"
+           "  rm NAME...           Remove one or more aliases\n"
+           "  import FILE|-        Add or update every alias line found in FILE\n"
+           "  backup               Create a backup of the config file\n"
+           "  backups              List available backups\n"
+           "  restore [BACKUP]     Restore BACKUP, or the most recent backup\n"
+           "  fleet [--jobs N] [--add NAME=COMMAND]... [--rm NAME]... [--homes-from FILE|-] HOME...\n"
+           "                       Audit or patch the aliases of many home directories in parallel\n"
+           "Without a command the graphical interface is started.\n";
+}
+std::string Cli::jsonString(std::string_view value) {
+    std::string escaped;
+    escaped.reserve(value.size() + 2);
+    escaped += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    escaped += buffer;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    escaped += '"';
+    return escaped;
+}
+int Cli::run(const std::vector<std::string>& args, std::ostream& out, std::ostream& err) {
+    Options options;
+    if (!parseOptions(args, options, err)) {
+        printUsage(err);
+        return 2;
+    }
+    if (options.command == "help") {
+        printUsage(out);
+        return 0;
+    }
+    if (options.command == "fleet") return runFleet(options, out, err);
+    ShellDetector::Shell shell = options.shell.empty() ? ShellDetector::detectShellCached() : shellFromName(options.shell);
+    if (shell == ShellDetector::Shell::UNKNOWN) return fail(out, "Unknown shell: " + options.shell, 2);
+    std::string configPath = options.config.empty() ? ShellDetector::getConfigFilePath(shell) : options.config;
+    ConfigFileHandler handler(configPath, shell);
+    BackupManager backups(configPath);
+    BackupManager* backup = options.backup ? &backups : nullptr;
+    const bool json = options.format == Format::JSON;
+    auto expectArguments = [&](size_t minimum, size_t maximum) {
+        if (options.arguments.size() >= minimum && options.arguments.size() <= maximum) return true;
+        err << "alia-can: wrong number of arguments for '" << options.command << "'\n";
+        printUsage(err);
+        return false;
+    };
+
+    if (options.command == "list") {
+        if (!expectArguments(0, 0)) return 2;
+        if (!handler.configFileExists()) return fail(out, "Config file does not exist: " + configPath);
+        AliasStore aliases = handler.loadAliases();
+        if (!json) {
+            for (const auto& alias : aliases) out << alias.name << '\t' << alias.command << '\n';
+            return 0;
+        }
+        out << "{\"shell\":" << jsonString(ShellDetector::getShellName(shell)) << ",\"config\":" << jsonString(configPath) << ",\"aliases\":[";
+        bool first = true;
+        for (const auto& alias : aliases) {
+            out << (first ? "" : ",") << "{\"name\":" << jsonString(alias.name) << ",\"command\":" << jsonString(alias.command) << ",\"line\":" << alias.line << ",\"file\":" << jsonString(alias.origin) << '}';
+            first = false;
+        }
+        out << "]}\n";
+        return 0;
+    }
+    if (options.command == "check") {
+        if (!expectArguments(0, 0)) return 2;
+        if (!handler.configFileExists()) return fail(out, "Config file does not exist: " + configPath);
+        AliasStore aliases = handler.loadAliases();
+        std::vector<PathIndex::Check> checks = PathIndex::shared().checkAll(aliases);
+        if (json) out << "{\"checked\":" << aliases.size() << ",\"aliases\":[";
+        bool first = true;
+        for (const auto& alias : aliases) {
+            const PathIndex::Check& check = checks[alias.id];
+            if (check.status == PathIndex::Status::OK) continue;
+            const char* status = check.status == PathIndex::Status::SHADOWS ? "shadows" : "missing";
+            if (!json) {
+                out << alias.name << '\t' << status << '\t' << check.target << '\n';
+                continue;
+            }
+            out << (first ? "" : ",") << "{\"name\":" << jsonString(alias.name) << ",\"status\":\"" << status << "\",\"target\":" << jsonString(check.target) << ",\"line\":" << alias.line << ",\"file\":" << jsonString(alias.origin) << '}';
+            first = false;
+        }
+        if (json) out << "]}\n";
+        return 0;
+    }
+    if (options.command == "usage") {
+        if (!expectArguments(0, 1)) return 2;
+        if (!handler.configFileExists()) return fail(out, "Config file does not exist: " + configPath);
+        AliasStore aliases = handler.loadAliases();
+        HistoryUsage history(shell, options.arguments.empty() ? "" : options.arguments[0]);
+        if (!history.update()) return fail(out, history.getLastError());
+        std::vector<HistoryUsage::Usage> usages = history.forAliases(aliases);
+        // Most used first; never-used aliases, the pruning candidates, end up at the bottom in file order.
+        std::vector<size_t> ids;
+        for (const auto& alias : aliases) ids.push_back(alias.id);
+        std::stable_sort(ids.begin(), ids.end(), [&](size_t a, size_t b) { return usages[a].count > usages[b].count; });
+        if (json) out << "{\"history\":" << jsonString(history.getHistoryPath()) << ",\"aliases\":[";
+        for (size_t i = 0; i < ids.size(); ++i) {
+            const HistoryUsage::Usage& usage = usages[ids[i]];
+            if (json) out << (i ? "," : "") << "{\"name\":" << jsonString(aliases.name(ids[i])) << ",\"count\":" << usage.count << ",\"last_used\":" << usage.lastUsed << '}';
+            else out << aliases.name(ids[i]) << '\t' << usage.count << '\t' << usage.lastUsed << '\n';
+        }
+        if (json) out << "]}\n";
+        return 0;
+    }
+    if (options.command == "suggest") {
+        if (!expectArguments(0, 1)) return 2;
+        if (!handler.configFileExists()) return fail(out, "Config file does not exist: " + configPath);
+        AliasStore aliases = handler.loadAliases();
+        const std::string historyPath = options.arguments.empty() ? HistoryUsage::defaultHistoryPath(shell) : options.arguments[0];
+        SuggestionMiner miner(shell);
+        std::vector<SuggestionMiner::Suggestion> suggestions;
+        if (!miner.mineFile(historyPath, aliases, PathIndex::shared(), suggestions)) return fail(out, miner.getLastError());
+        if (json) out << "{\"history\":" << jsonString(historyPath) << ",\"suggestions\":[";
+        for (size_t i = 0; i < suggestions.size(); ++i) {
+            const SuggestionMiner::Suggestion& suggestion = suggestions[i];
+            if (json) out << (i ? "," : "") << "{\"name\":" << jsonString(suggestion.name) << ",\"command\":" << jsonString(suggestion.command) << ",\"count\":" << suggestion.count << '}';
+            else out << suggestion.name << '\t' << suggestion.command << '\t' << suggestion.count << '\n';
+        }
+        if (json) out << "]}\n";
+        return 0;
+    }
+    if (options.command == "add" || options.command == "rm" || options.command == "import") {
+        std::vector<Alias> additions;
+        if (options.command == "add") {
+            if (!expectArguments(2, 2)) return 2;
+            additions.push_back(Alias{options.arguments[0], options.arguments[1]});
+        } else if (options.command == "import") {
+            if (!expectArguments(1, 1)) return 2;
+            std::string content;
+            if (options.arguments[0] == "-") {
+                content.assign(std::istreambuf_iterator<char>(std::cin), {});
+            } else {
+                std::ifstream input(options.arguments[0]);
+                if (!input.is_open()) return fail(out, "Cannot open import file: " + options.arguments[0]);
+                content.assign(std::istreambuf_iterator<char>(input), {});
+            }
+            additions = AliasScanner::scanAll(content, shell);
+        } else if (!expectArguments(1, SIZE_MAX)) {
+            return 2;
+        }
+        // Checked before anything is staged, so a preset with one broken line changes nothing. Names and lengths
+        // are left to stageAdd, which reports them with its own message.
+        std::vector<SyntaxChecker::Result> syntax = SyntaxChecker::forShell(shell).checkAll(additions);
+        for (size_t i = 0; i < additions.size(); ++i) {
+            if (syntax[i].verdict != SyntaxChecker::Verdict::INVALID || !AliasManager::validateAliasName(additions[i].name) || !AliasManager::validateCommand(additions[i].command)) continue;
+            return fail(out, "Syntax error in alias " + additions[i].name + ": " + syntax[i].message);
+        }
+        bool staged = handler.beginTransaction(backup);
+        for (const auto& alias : additions) {
+            if (!staged) break;
+            staged = handler.stageAdd(alias);
+        }
+        if (options.command == "rm") {
+            for (const auto& name : options.arguments) {
+                if (!staged) break;
+                staged = handler.stageRemove(name);
+            }
+        }
+        if (!staged || !handler.commitTransaction()) {
+            handler.rollbackTransaction();
+            return fail(out, handler.getLastError());
+        }
+        size_t changed = handler.changedCount();
+        if (json) out << "{\"ok\":true,\"changed\":" << changed << "}\n";
+        else out << changed << '\n';
+        return 0;
+    }
+    if (options.command == "backup") {
+        if (!expectArguments(0, 0)) return 2;
+        std::string path = backups.createBackup();
+        if (path.empty()) return fail(out, backups.getLastError());
+        if (json) out << "{\"ok\":true,\"backup\":" << jsonString(path) << "}\n";
+        else out << path << '\n';
+        return 0;
+    }
+    if (options.command == "backups") {
+        if (!expectArguments(0, 0)) return 2;
+        std::vector<std::string> paths = backups.listBackups();
+        if (!json) {
+            for (const auto& path : paths) out << path << '\n';
+            return 0;
+        }
+        out << "{\"backups\":[";
+        for (size_t i = 0; i < paths.size(); ++i) out << (i ? "," : "") << jsonString(paths[i]);
+        out << "]}\n";
+        return 0;
+    }
+    if (!expectArguments(0, 1)) return 2;
+    std::string path = options.arguments.empty() ? backups.getLastBackupPath() : options.arguments[0];
+    if (path.empty()) return fail(out, "No backup found");
+    if (!backups.restoreFromBackup(path)) return fail(out, backups.getLastError());
+    if (json) out << "{\"ok\":true,\"restored\":" << jsonString(path) << "}\n";
+    else out << path << '\n';
+    return 0;
+}
+int Cli::runFleet(const Options& options, std::ostream& out, std::ostream& err) {
+    FleetOptions fleet;
+    fleet.backup = options.backup;
+    const auto& args = options.arguments;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        if (arg == "--jobs" || arg == "--add" || arg == "--rm" || arg == "--homes-from") {
+            if (i + 1 >= args.size()) { err << "alia-can: " << arg << " requires a value\n"; return 2; }
+            const std::string& value = args[++i];
+            if (arg == "--jobs") {
+                size_t jobs = 0;
+                auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), jobs);
+                if (ec != std::errc() || end != value.data() + value.size() || jobs == 0) { err << "alia-can: --jobs expects a positive number\n"; return 2; }
+                fleet.jobs = std::min(jobs, MAX_JOBS);
+            } else if (arg == "--add") {
+                size_t eq = value.find('=');
+                if (eq == std::string::npos) { err << "alia-can: --add expects NAME=COMMAND\n"; return 2; }
+                fleet.additions.push_back(Alias{value.substr(0, eq), value.substr(eq + 1)});
+            } else if (arg == "--rm") {
+                fleet.removals.push_back(value);
+            } else if (value == "-") {
+                for (auto& home : Fleet::readHomeList(std::cin)) fleet.homes.push_back(std::move(home));
+            } else {
+                std::ifstream input(value);
+                if (!input.is_open()) return fail(out, "Cannot open home list: " + value);
+                for (auto& home : Fleet::readHomeList(input)) fleet.homes.push_back(std::move(home));
+            }
+        } else {
+            fleet.homes.push_back(arg);
+        }
+    }
+    if (fleet.homes.empty()) { err << "alia-can: fleet needs at least one home directory\n"; return 2; }
+    for (const auto& alias : fleet.additions) {
+        if (!AliasManager::validateAliasName(alias.name) || !AliasManager::validateCommand(alias.command)) return fail(out, "Invalid alias name or command: " + alias.name, 2);
+    }
+    FleetReport report = Fleet::run(fleet);
+    if (options.format == Format::TSV) {
+        for (const auto& result : report.results) {
+            out << result.home << '\t' << (result.ok ? "ok" : "error") << '\t' << ShellDetector::getShellName(result.shell) << '\t' << result.aliasCount << '\t' << result.changed << '\t' << result.error << '\n';
+        }
+    } else {
+        out << "{\"homes\":[";
+        for (size_t i = 0; i < report.results.size(); ++i) {
+            const FleetResult& result = report.results[i];
+            out << (i ? "," : "") << "{\"home\":" << jsonString(result.home) << ",\"ok\":" << (result.ok ? "true" : "false")
+                << ",\"shell\":" << jsonString(ShellDetector::getShellName(result.shell)) << ",\"config\":" << jsonString(result.configPath)
+                << ",\"aliases\":" << result.aliasCount << ",\"changed\":" << result.changed << ",\"elapsed_ms\":" << result.elapsedMs;
+            if (!result.ok) out << ",\"error\":" << jsonString(result.error);
+            out << '}';
+        }
+        out << "],\"summary\":{\"homes\":" << report.results.size() << ",\"ok\":" << report.succeeded << ",\"failed\":" << report.failed
+            << ",\"aliases\":" << report.totalAliases << ",\"changed\":" << report.totalChanged << ",\"elapsed_ms\":" << report.elapsedMs << "}}\n";
+    }
+    return report.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Cli {
+public:
+    static bool isCliInvocation(int argc, char* argv[]);
+    static int run(const std::vector<std::string>& args, std::ostream& out, std::ostream& err);
+    static std::string jsonString(std::string_view value);
+private:
+    enum class Format { JSON, TSV };
+    struct Options {
+        std::string shell;
+        std::string config;
+        Format format = Format::JSON;
+        bool backup = true;
+        std::string command;
+        std::vector<std::string> arguments;
+    };
+    static bool isSubcommand(std::string_view name);
+    static bool parseOptions(const std::vector<std::string>& args, Options& options, std::ostream& err);
+    static void printUsage(std::ostream& out);
+    static int runFleet(const Options& options, std::ostream& out, std::ostream& err);
+};
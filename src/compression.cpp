@@ -0,0 +1,161 @@
+#include "compression.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <functional>
+#include <lzma.h>
+#include <unistd.h>
+#ifdef ALIACAN_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static bool writeChunk(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+static bool runLzma(lzma_stream& stream, std::string_view input, const std::function<bool(const char*, size_t)>& sink, std::string& error) {
+    char buffer[64 * 1024];
+    stream.next_in = reinterpret_cast<const uint8_t*>(input.data());
+    stream.avail_in = input.size();
+    lzma_ret ret = LZMA_OK;
+    while (ret == LZMA_OK) {
+        stream.next_out = reinterpret_cast<uint8_t*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        ret = lzma_code(&stream, LZMA_FINISH);
+        if ((ret == LZMA_OK || ret == LZMA_STREAM_END) && !sink(buffer, sizeof(buffer) - stream.avail_out)) {
+            error = "Failed to write decompressed data";
+            lzma_end(&stream);
+            return false;
+        }
+    }
+    lzma_end(&stream);
+    if (ret != LZMA_STREAM_END) {
+        error = "xz stream error " + std::to_string(static_cast<int>(ret));
+        return false;
+    }
+    return true;
+}
+#ifdef ALIACAN_HAVE_ZSTD
+static bool runZstdDecompress(std::string_view input, const std::function<bool(const char*, size_t)>& sink, std::string& error) {
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    char buffer[64 * 1024];
+    ZSTD_inBuffer in{input.data(), input.size(), 0};
+    size_t ret = 1;
+    while (in.pos < in.size || ret != 0) {
+        ZSTD_outBuffer out{buffer, sizeof(buffer), 0};
+        ret = ZSTD_decompressStream(stream, &out, &in);
+        if (ZSTD_isError(ret)) { error = std::string("zstd error: ") + ZSTD_getErrorName(ret); break; }
+        if (!sink(buffer, out.pos)) { error = "Failed to write decompressed data"; ret = static_cast<size_t>(-1); break; }
+        if (in.pos == in.size && out.pos == 0 && ret != 0) { error = "Truncated zstd stream"; ret = static_cast<size_t>(-1); break; }
+    }
+    ZSTD_freeDStream(stream);
+    return error.empty();
+}
+#endif
+static bool decompressTo(std::string_view input, Compression::Codec codec, const std::function<bool(const char*, size_t)>& sink, std::string& error) {
+    switch (codec) {
+        case Compression::Codec::NONE:
+            if (!sink(input.data(), input.size())) { error = "Failed to write data"; return false; }
+            return true;
+        case Compression::Codec::XZ: {
+            lzma_stream stream = LZMA_STREAM_INIT;
+            if (lzma_stream_decoder(&stream, UINT64_MAX, 0) != LZMA_OK) { error = "Cannot initialize xz decoder"; return false; }
+            return runLzma(stream, input, sink, error);
+        }
+        case Compression::Codec::ZSTD:
+#ifdef ALIACAN_HAVE_ZSTD
+            return runZstdDecompress(input, sink, error);
+#else
+            error = "zstd support is not compiled in";
+            return false;
+#endif
+    }
+    return false;
+}
+
+bool Compression::isAvailable(Codec codec) {
+#ifndef ALIACAN_HAVE_ZSTD
+    if (codec == Codec::ZSTD) return false;
+#endif
+    return true;
+}
+Compression::Codec Compression::defaultCodec() { return isAvailable(Codec::ZSTD) ? Codec::ZSTD : Codec::XZ; }
+int Compression::defaultLevel(Codec codec) {
+    switch (codec) {
+        case Codec::XZ: return 3;
+        case Codec::ZSTD: return 6;
+        case Codec::NONE: return 0;
+    }
+    return 0;
+}
+std::string Compression::codecName(Codec codec) {
+    switch (codec) {
+        case Codec::XZ: return "xz";
+        case Codec::ZSTD: return "zstd";
+        case Codec::NONE: return "none";
+    }
+    return "none";
+}
+bool Compression::codecFromName(std::string_view name, Codec& codec) {
+    if (name == "xz") codec = Codec::XZ;
+    else if (name == "zstd") codec = Codec::ZSTD;
+    else if (name == "none") codec = Codec::NONE;
+    else return false;
+    return true;
+}
+std::string Compression::fileExtension(Codec codec) {
+    switch (codec) {
+        case Codec::XZ: return ".xz";
+        case Codec::ZSTD: return ".zst";
+        case Codec::NONE: return "";
+    }
+    return "";
+}
+Compression::Codec Compression::detect(std::string_view data) {
+    if (data.starts_with(std::string_view("\xFD" "7zXZ\0", 6))) return Codec::XZ;
+    if (data.starts_with("\x28\xB5\x2F\xFD")) return Codec::ZSTD;
+    return Codec::NONE;
+}
+bool Compression::compress(std::string_view input, std::string& output, Codec codec, int level, std::string& error) {
+    output.clear();
+    switch (codec) {
+        case Codec::NONE:
+            output.assign(input);
+            return true;
+        case Codec::XZ: {
+            lzma_stream stream = LZMA_STREAM_INIT;
+            if (lzma_easy_encoder(&stream, static_cast<uint32_t>(std::clamp(level, 0, 9)), LZMA_CHECK_CRC64) != LZMA_OK) { error = "Cannot initialize xz encoder"; return false; }
+            return runLzma(stream, input, [&](const char* data, size_t size) { output.append(data, size); return true; }, error);
+        }
+        case Codec::ZSTD:
+#ifdef ALIACAN_HAVE_ZSTD
+        {
+            output.resize(ZSTD_compressBound(input.size()));
+            size_t size = ZSTD_compress(output.data(), output.size(), input.data(), input.size(), level);
+            if (ZSTD_isError(size)) { error = std::string("zstd error: ") + ZSTD_getErrorName(size); return false; }
+            output.resize(size);
+            return true;
+        }
+#else
+            error = "zstd support is not compiled in";
+            return false;
+#endif
+    }
+    return false;
+}
+bool Compression::decompress(std::string_view input, std::string& output, Codec codec, std::string& error) {
+    output.clear();
+    return decompressTo(input, codec, [&](const char* data, size_t size) { output.append(data, size); return true; }, error);
+}
+bool Compression::decompressToFile(std::string_view input, int fd, Codec codec, std::string& error) {
+    return decompressTo(input, codec, [fd](const char* data, size_t size) { return writeChunk(fd, data, size); }, error);
+}
+uint32_t Compression::crc32(std::string_view data) { return lzma_crc32(reinterpret_cast<const uint8_t*>(data.data()), data.size(), 0); }
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class Compression {
+public:
+    enum class Codec { NONE, XZ, ZSTD };
+    static bool isAvailable(Codec codec);
+    static Codec defaultCodec();
+    static int defaultLevel(Codec codec);
+    static std::string codecName(Codec codec);
+    static bool codecFromName(std::string_view name, Codec& codec);
+    static std::string fileExtension(Codec codec);
+    static Codec detect(std::string_view data);
+    static bool compress(std::string_view input, std::string& output, Codec codec, int level, std::string& error);
+    static bool decompress(std::string_view input, std::string& output, Codec codec, std::string& error);
+    static uint32_t crc32(std::string_view data);
+    static bool decompressToFile(std::string_view input, int fd, Codec codec, std::string& error);
+};
@@ -0,0 +1,204 @@
+#include "configeditor.hpp"
+#include "aliasscanner.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+static bool writeFully(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+    return true;
+}
+static bool statFile(const std::string& path, struct stat& sb) { return ::stat(path.c_str(), &sb) == 0; }
+static int64_t mtimeOf(const struct stat& sb) { return static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec; }
+
+ConfigEditor::ConfigEditor(const std::string& filePath, ShellDetector::Shell shell) : filePath(filePath), shell(shell) {}
+bool ConfigEditor::open() {
+    discard();
+    spans.clear();
+    byName.clear();
+    decodedNames.clear();
+    struct stat sb;
+    if (!statFile(filePath, sb)) { lastError = "Config file does not exist: " + filePath; return false; }
+    if (!file.open(filePath)) { lastError = file.getLastError(); return false; }
+    mtime = mtimeOf(sb);
+    std::string_view content = file.view();
+    AliasScanner::scan(content, shell, [&](const ScannedAlias& scanned) {
+        std::string_view name = scanned.alias.name;
+        if (name.data() < content.data() || name.data() + name.size() > content.data() + content.size()) name = decodedNames.emplace_back(name);
+        spans.push_back(Span{name, scanned.offset, scanned.length, scanned.line, scanned.prefixLength, scanned.definitionOffset, scanned.definitionLength, false, {}});
+    });
+    return true;
+}
+std::pair<size_t, size_t> ConfigEditor::findSpans(std::string_view name) {
+    if (byName.size() != spans.size()) {
+        byName.resize(spans.size());
+        for (uint32_t i = 0; i < byName.size(); ++i) byName[i] = i;
+        std::stable_sort(byName.begin(), byName.end(), [this](uint32_t a, uint32_t b) { return spans[a].name < spans[b].name; });
+    }
+    auto first = std::lower_bound(byName.begin(), byName.end(), name, [this](uint32_t id, std::string_view value) { return spans[id].name < value; });
+    auto last = std::upper_bound(first, byName.end(), name, [this](std::string_view value, uint32_t id) { return value < spans[id].name; });
+    return {static_cast<size_t>(first - byName.begin()), static_cast<size_t>(last - byName.begin())};
+}
+bool ConfigEditor::contains(std::string_view name) {
+    if (std::any_of(additions.begin(), additions.end(), [&](const Addition& a) { return a.name == name && !a.undefines; })) return true;
+    auto [first, last] = findSpans(name);
+    for (size_t i = first; i < last; ++i) {
+        const Span& span = spans[byName[i]];
+        if (!span.edited || !span.replacement.empty()) return true;
+    }
+    return false;
+}
+// `definition` is the statement minus its keyword (`name='cmd'`); an existing statement keeps its own prefix so
+// `alias -g`, fish `abbr -a` and indentation survive the edit, and new ones are appended as plain `alias`.
+void ConfigEditor::upsert(std::string_view name, std::string_view definition) {
+    auto [first, last] = findSpans(name);
+    bool placed = false;
+    for (size_t i = first; i < last; ++i) {
+        Span& span = spans[byName[i]];
+        if (span.edited && span.replacement.empty()) continue;
+        span.edited = true;
+        span.replacement.clear();
+        if (!placed) {
+            span.replacement.append(definition).push_back('\n');
+            placed = true;
+        }
+    }
+    auto added = std::find_if(additions.begin(), additions.end(), [&](const Addition& a) { return a.name == name; });
+    if (placed) {
+        if (added != additions.end()) additions.erase(added);
+    } else {
+        std::string line = std::string(AliasParser::KEYWORD) + " " + std::string(definition);
+        if (added != additions.end()) *added = Addition{std::string(name), std::move(line)};
+        else additions.push_back(Addition{std::string(name), std::move(line)});
+    }
+    ++editCount;
+}
+bool ConfigEditor::remove(std::string_view name) {
+    bool found = false;
+    auto [first, last] = findSpans(name);
+    for (size_t i = first; i < last; ++i) {
+        Span& span = spans[byName[i]];
+        if (span.edited && span.replacement.empty()) continue;
+        span.edited = true;
+        span.replacement.clear();
+        found = true;
+    }
+    auto added = std::find_if(additions.begin(), additions.end(), [&](const Addition& a) { return a.name == name; });
+    if (added != additions.end()) { additions.erase(added); found = true; }
+    if (found) ++editCount;
+    return found;
+}
+// For a name defined by a file this editor can't change: the file's own definitions go and `line`, which undoes
+// the other one, is appended. A later upsert() replaces the line with a definition.
+void ConfigEditor::undefine(std::string_view name, std::string line) {
+    remove(name);
+    additions.push_back(Addition{std::string(name), std::move(line), true});
+    ++editCount;
+}
+bool ConfigEditor::hasChanges() const { return editCount > 0; }
+void ConfigEditor::discard() {
+    for (Span& span : spans) { span.edited = false; span.replacement.clear(); }
+    additions.clear();
+    editCount = 0;
+}
+bool ConfigEditor::streamTo(int fd) const {
+    std::string_view content = file.view();
+    size_t cursor = 0;
+    for (size_t first = 0, last = 0; first < spans.size(); first = last) {
+        while (last < spans.size() && spans[last].offset == spans[first].offset) ++last;
+        if (std::none_of(spans.begin() + first, spans.begin() + last, [](const Span& span) { return span.edited; })) continue;
+        const Span& statement = spans[first];
+        if (!writeFully(fd, content.substr(cursor, statement.offset - cursor))) return false;
+        // Definitions sharing a statement (`alias a=b c=d`) are split onto their own lines once one of them
+        // changes; each keeps the statement's prefix and the untouched ones keep their original quoting. Whatever
+        // followed the last definition, such as a trailing comment, stays on the last line left.
+        std::string rewritten;
+        for (size_t i = first; i < last; ++i) {
+            const Span& span = spans[i];
+            if (span.edited && span.replacement.empty()) continue;
+            rewritten.append(content.substr(span.offset, span.prefixLength));
+            if (span.edited) rewritten += span.replacement;
+            else rewritten.append(content.substr(span.definitionOffset, span.definitionLength)).push_back('\n');
+        }
+        if (last - first > 1 && !rewritten.empty()) {
+            const size_t tailOffset = spans[last - 1].definitionOffset + spans[last - 1].definitionLength;
+            std::string_view tail = content.substr(tailOffset, statement.offset + statement.length - tailOffset);
+            if (tail.ends_with('\n')) tail.remove_suffix(1);
+            rewritten.insert(rewritten.size() - 1, tail);
+        }
+        if (!rewritten.empty() && content[statement.offset + statement.length - 1] != '\n') rewritten.pop_back();
+        if (!writeFully(fd, rewritten)) return false;
+        cursor = statement.offset + statement.length;
+    }
+    if (!writeFully(fd, content.substr(cursor))) return false;
+    if (additions.empty()) return true;
+    if (!content.empty() && content.back() != '\n' && !writeFully(fd, "\n")) return false;
+    for (const Addition& addition : additions) {
+        if (!writeFully(fd, addition.line) || !writeFully(fd, "\n")) return false;
+    }
+    return true;
+}
+bool ConfigEditor::commit() {
+    if (!hasChanges()) return true;
+    std::error_code ec;
+    fs::path target = fs::canonical(filePath, ec);
+    if (ec) { lastError = "Cannot resolve config file: " + filePath; return false; }
+    struct stat sb;
+    if (!statFile(target, sb) || mtimeOf(sb) != mtime || static_cast<size_t>(sb.st_size) != file.size()) {
+        lastError = "Config file changed on disk: " + filePath;
+        return false;
+    }
+    std::string tempPath = (target.parent_path() / ("." + target.filename().string() + ".aliacan-XXXXXX")).string();
+    int fd = mkstemp(tempPath.data());
+    if (fd < 0) { lastError = "Cannot create temporary file: " + std::string(std::strerror(errno)); return false; }
+    if (fchown(fd, sb.st_uid, sb.st_gid) != 0 && geteuid() == 0) lastError = "Cannot preserve config file ownership: " + filePath;
+    bool ok = streamTo(fd) && fchmod(fd, sb.st_mode & 07777) == 0 && fsync(fd) == 0;
+    // Renaming over a hard-linked config would detach it from its other names, so the new content is copied
+    // into the existing inode instead; the synced temporary file stays behind until the copy is on disk.
+    if (ok && sb.st_nlink > 1) {
+        ok = copyInto(fd, target.string());
+        if (::close(fd) != 0) ok = false;
+        if (!ok) lastError = "Failed to write config file: " + std::string(std::strerror(errno));
+        ::unlink(tempPath.c_str());
+        return ok && open();
+    }
+    if (::close(fd) != 0) ok = false;
+    if (!ok || ::rename(tempPath.c_str(), target.c_str()) != 0) {
+        lastError = "Failed to write config file: " + std::string(std::strerror(errno));
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+    return open();
+}
+// Overwrites `target` in place with everything in `source`, which is read from its start.
+bool ConfigEditor::copyInto(int source, const std::string& target) {
+    if (::lseek(source, 0, SEEK_SET) != 0) return false;
+    int fd = ::open(target.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    char buffer[1 << 16];
+    off_t total = 0;
+    bool ok = true;
+    for (;;) {
+        ssize_t n = ::read(source, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) { ok = n == 0; break; }
+        if (!writeFully(fd, std::string_view(buffer, static_cast<size_t>(n)))) { ok = false; break; }
+        total += n;
+    }
+    ok = ok && ::ftruncate(fd, total) == 0 && fsync(fd) == 0;
+    if (::close(fd) != 0) ok = false;
+    return ok;
+}
+std::string ConfigEditor::getLastError() const { return lastError; }
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mappedfile.hpp"
+#include "shelldetector.hpp"
+
+class ConfigEditor {
+public:
+    explicit ConfigEditor(const std::string& filePath, ShellDetector::Shell shell = ShellDetector::Shell::BASH);
+    bool open();
+    bool contains(std::string_view name);
+    void upsert(std::string_view name, std::string_view definition);
+    bool remove(std::string_view name);
+    void undefine(std::string_view name, std::string line);
+    bool hasChanges() const;
+    void discard();
+    bool commit();
+    std::string getLastError() const;
+private:
+    struct Span {
+        std::string_view name;
+        size_t offset;
+        size_t length;
+        size_t line;
+        size_t prefixLength;
+        size_t definitionOffset;
+        size_t definitionLength;
+        bool edited;
+        std::string replacement;
+    };
+    struct Addition {
+        std::string name;
+        std::string line;
+        bool undefines = false;
+    };
+    std::string filePath;
+    ShellDetector::Shell shell;
+    MappedFile file;
+    std::vector<Span> spans;
+    std::deque<std::string> decodedNames;
+    std::vector<uint32_t> byName;
+    std::vector<Addition> additions;
+    int64_t mtime = 0;
+    size_t editCount = 0;
+    std::string lastError;
+    std::pair<size_t, size_t> findSpans(std::string_view name);
+    bool streamTo(int fd) const;
+    static bool copyInto(int source, const std::string& target);
+};
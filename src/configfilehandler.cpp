@@ -1,30 +1,41 @@
 #include "configfilehandler.hpp"
+#include "aliasscanner.hpp"
+#include "backupmanager.hpp"
+#include "configeditor.hpp"
+#include "fishfunctions.hpp"
+#include "sourcegraph.hpp"
+#include "trace.hpp"
+#include <algorithm>
 #include <fstream>
 #include <filesystem>
 #include <sys/stat.h>
 
 namespace fs = std::filesystem;
-ConfigFileHandler::ConfigFileHandler(const std::string& configFilePath, ShellDetector::Shell shell)
-: configFilePath(configFilePath), shell(shell), aliasManager(shell) {}
-std::vector<Alias> ConfigFileHandler::loadAliases() {
-    std::vector<Alias> aliases;
+ConfigFileHandler::ConfigFileHandler(const std::string& configFilePath, ShellDetector::Shell shell, const std::string& home)
+: configFilePath(configFilePath), shell(shell), home(home), aliasManager(shell) {
+    if (shell == ShellDetector::Shell::FISH) functions = std::make_unique<FishFunctions>(FishFunctions::directoryFor(configFilePath));
+}
+ConfigFileHandler::~ConfigFileHandler() = default;
+AliasStore ConfigFileHandler::loadAliases() {
+    TRACE_SCOPE(span, "ConfigFileHandler::loadAliases");
+    AliasStore aliases;
     if (!configFileExists()) {
         lastError = "Config file does not exist: " + configFilePath;
         return aliases;
     }
-    std::ifstream file(configFilePath);
-    if (!file.is_open()) {
-        lastError = "Cannot open config file for reading: " + configFilePath;
-        return aliases;
-    }
-    std::string line;
-    while (std::getline(file, line)) {
-        if (AliasManager::isAliasLine(line)) {
-            if (auto parsed = AliasManager::parseAliasLine(line); !parsed.name.empty()) {
-                aliases.push_back(std::move(parsed));
-            }
-        }
+    // Declared first: the graph's definitions point into the cache mapping for every file it didn't re-read.
+    ParseCache cache;
+    SourceGraph graph(configFilePath, shell, home);
+    if (!loadGraph(graph, cache)) return aliases;
+    aliases.reserve(graph.definitions().size() + 16, graph.definitions().size() * 48);
+    std::vector<size_t> origins;
+    for (const auto& file : graph.files()) origins.push_back(aliases.addOrigin(file));
+    // Function files load first so a definition in config.fish, which fish runs later, overrides them.
+    if (functions) {
+        for (const auto& function : functions->load()) aliases.insert(function.alias.name, function.alias.command, 0, aliases.addOrigin(function.path));
     }
+    for (const auto& definition : graph.definitions()) aliases.insert(definition.name, definition.command, definition.line, origins[definition.file]);
+    TRACE_ARG(span, "aliases", aliases.size());
     return aliases;
 }
 bool ConfigFileHandler::addAlias(const Alias& alias) {
@@ -32,17 +43,11 @@ bool ConfigFileHandler::addAlias(const Alias& alias) {
         lastError = "Invalid alias name or command";
         return false;
     }
-    if (!ensureFileExists()) {
-        lastError = "Cannot create config file";
+    if (!beginTransaction()) return false;
+    if (!stageAdd(alias) || !commitTransaction()) {
+        rollbackTransaction();
         return false;
     }
-    std::ofstream file(configFilePath, std::ios::app);
-    if (!file.is_open()) {
-        lastError = "Cannot open config file for writing";
-        return false;
-    }
-    file << '\n' << aliasManager.formatAlias(alias);
-    setFilePermissions();
     return true;
 }
 bool ConfigFileHandler::removeAlias(const std::string& aliasName) {
@@ -50,36 +55,192 @@ bool ConfigFileHandler::removeAlias(const std::string& aliasName) {
         lastError = "Config file does not exist";
         return false;
     }
-    auto lines = readAllLines();
-    if (lines.empty()) {
-        lastError = "Failed to read config file";
+    if (!beginTransaction()) return false;
+    if (!stageRemove(aliasName) || !commitTransaction()) {
+        rollbackTransaction();
+        return false;
+    }
+    return true;
+}
+bool ConfigFileHandler::beginTransaction(BackupManager* backupManager) {
+    TRACE_SCOPE(span, "ConfigFileHandler::beginTransaction");
+    if (inTransaction()) {
+        lastError = "A transaction is already in progress";
+        return false;
+    }
+    if (!ensureFileExists()) {
+        lastError = "Cannot create config file";
         return false;
     }
-    bool found = false;
-    std::vector<std::string> newLines;
-    newLines.reserve(lines.size());
-    for (auto& line : lines) {
-        if (AliasManager::isAliasLine(line)) {
-            if (auto parsed = AliasManager::parseAliasLine(line); parsed.name == aliasName) {
-                found = true;
-                continue;
-            }
+    ParseCache cache;
+    SourceGraph graph(configFilePath, shell, home);
+    if (!loadGraph(graph, cache)) return false;
+    auto editor = std::make_unique<ConfigEditor>(configFilePath, shell);
+    if (!editor->open()) {
+        lastError = editor->getLastError();
+        return false;
+    }
+    transactionFiles = graph.files();
+    editors.resize(transactionFiles.size());
+    editors[0] = std::move(editor);
+    // Sourced files are only edited inside the config's home and when they belong to its owner; a definition in
+    // /etc/profile.d or anywhere else is overridden from the root config instead.
+    writable.assign(transactionFiles.size(), 0);
+    writable[0] = 1;
+    struct stat root;
+    std::error_code ec;
+    const std::string home = fs::canonical(graph.homeDirectory(), ec).string() + "/";
+    if (!ec && stat(configFilePath.c_str(), &root) == 0) {
+        for (size_t file = 1; file < transactionFiles.size(); ++file) {
+            struct stat sb;
+            writable[file] = transactionFiles[file].starts_with(home) && stat(transactionFiles[file].c_str(), &sb) == 0 && sb.st_uid == root.st_uid;
         }
-        newLines.push_back(std::move(line));
+    }
+    // The last file to define a name is the one the shell takes it from, so it goes to the back of the list.
+    for (const auto& definition : graph.definitions()) {
+        Defined& defined = definedIn[std::string(definition.name)];
+        std::erase(defined.files, definition.file);
+        defined.files.push_back(definition.file);
+        defined.command = definition.command;
+        ++defined.count;
+    }
+    transactionBackup = backupManager;
+    return true;
+}
+bool ConfigFileHandler::stageAdd(const Alias& alias) {
+    if (!inTransaction()) {
+        lastError = "No transaction in progress";
+        return false;
+    }
+    if (!AliasManager::validateAliasName(alias.name) || !AliasManager::validateCommand(alias.command)) {
+        lastError = "Invalid alias name or command: " + alias.name;
+        return false;
+    }
+    if (isFunctionAlias(alias.name)) {
+        if (functions->read(alias.name).command == alias.command) return true;
+        functionEdits.push_back(FunctionEdit{alias, false});
+        changedNames.insert(alias.name);
+        return true;
+    }
+    // Re-adding the one existing definition unchanged is a no-op, so it doesn't rewrite the file or its quoting.
+    auto defined = definedIn.find(alias.name);
+    if (defined != definedIn.end() && defined->second.count == 1 && defined->second.command == alias.command) return true;
+    const size_t file = defined != definedIn.end() && !defined->second.files.empty() ? defined->second.files.back() : 0;
+    ConfigEditor* editor = editorFor(writable[file] ? file : 0);
+    if (editor == nullptr) return false;
+    // An override has to come after the file it overrides, so the root config's own definition moves to its end.
+    if (!writable[file]) editor->remove(alias.name);
+    editor->upsert(alias.name, aliasManager.formatDefinition(alias));
+    if (defined != definedIn.end()) {
+        defined->second.command = alias.command;
+        defined->second.count = 1;
+    }
+    changedNames.insert(alias.name);
+    return true;
+}
+bool ConfigFileHandler::stageUpdate(const Alias& alias) {
+    if (!inTransaction()) {
+        lastError = "No transaction in progress";
+        return false;
+    }
+    bool found = isFunctionAlias(alias.name);
+    for (size_t file : filesDefining(alias.name)) {
+        if (found) break;
+        ConfigEditor* editor = editorFor(file);
+        if (editor == nullptr) return false;
+        found = editor->contains(alias.name);
     }
     if (!found) {
+        lastError = "Alias not found: " + alias.name;
+        return false;
+    }
+    return stageAdd(alias);
+}
+bool ConfigFileHandler::stageRemove(const std::string& aliasName) {
+    if (!inTransaction()) {
+        lastError = "No transaction in progress";
+        return false;
+    }
+    // Every definition goes, not just the effective one, or an earlier one would take its place; those in files
+    // that can't be edited are undone by an unalias at the end of the root config.
+    bool removed = false, shadowed = false;
+    for (size_t file : filesDefining(aliasName)) {
+        if (!writable[file]) {
+            shadowed = true;
+            continue;
+        }
+        ConfigEditor* editor = editorFor(file);
+        if (editor == nullptr) return false;
+        removed = editor->remove(aliasName) || removed;
+    }
+    if (shadowed) {
+        editors[0]->undefine(aliasName, aliasManager.formatUnalias(aliasName));
+        removed = true;
+    }
+    if (hasFunctionFile(aliasName)) {
+        functionEdits.push_back(FunctionEdit{Alias{aliasName, {}}, true});
+        removed = true;
+    }
+    if (!removed) {
         lastError = "Alias not found: " + aliasName;
         return false;
     }
-    return writeAllLines(newLines);
+    if (auto defined = definedIn.find(aliasName); defined != definedIn.end()) {
+        defined->second.command.clear();
+        defined->second.count = 0;
+    }
+    changedNames.insert(aliasName);
+    return true;
 }
-std::string ConfigFileHandler::getConfigFilePath() const {
-    switch (shell) {
-        case ShellDetector::Shell::BASH: return ShellDetector::expandHome("~/.bashrc");
-        case ShellDetector::Shell::ZSH: return ShellDetector::expandHome("~/.zshrc");
-        case ShellDetector::Shell::FISH: return ShellDetector::expandHome("~/.config/fish/config.fish");
-        default: return configFilePath;
+bool ConfigFileHandler::commitTransaction() {
+    TRACE_SCOPE(span, "ConfigFileHandler::commitTransaction");
+    if (!inTransaction()) {
+        lastError = "No transaction in progress";
+        return false;
+    }
+    if (editors[0]->hasChanges() && transactionBackup != nullptr && transactionBackup->createBackup().empty()) {
+        lastError = "Failed to create backup: " + transactionBackup->getLastError();
+        return false;
+    }
+    // Sourced files and function files get their own snapshots, so every file the commit touches can be restored.
+    for (size_t file = 1; file < editors.size(); ++file) {
+        if (editors[file] && editors[file]->hasChanges() && !backUp(transactionFiles[file])) return false;
+    }
+    for (const FunctionEdit& edit : functionEdits) {
+        if (!backUp(functions->pathFor(edit.alias.name))) return false;
+    }
+    for (auto& editor : editors) {
+        if (!editor || !editor->hasChanges()) continue;
+        if (!editor->commit()) {
+            lastError = editor->getLastError();
+            return false;
+        }
     }
+    if (!applyFunctionEdits()) return false;
+    const size_t changed = changedNames.size();
+    rollbackTransaction();
+    lastChanged = changed;
+    return true;
+}
+// Aliases the last committed transaction actually added, changed or removed.
+size_t ConfigFileHandler::changedCount() const {
+    return lastChanged;
+}
+void ConfigFileHandler::rollbackTransaction() {
+    editors.clear();
+    writable.clear();
+    transactionFiles.clear();
+    definedIn.clear();
+    changedNames.clear();
+    lastChanged = 0;
+    transactionBackup = nullptr;
+    functionEdits.clear();
+}
+bool ConfigFileHandler::inTransaction() const {
+    return !editors.empty();
+}
+std::string ConfigFileHandler::getConfigFilePath() const {
+    return configFilePath;
 }
 bool ConfigFileHandler::configFileExists() const {
     return fs::exists(configFilePath);
@@ -93,6 +254,8 @@ std::vector<std::string> ConfigFileHandler::readAllLines() {
     return lines;
 }
 bool ConfigFileHandler::writeAllLines(const std::vector<std::string>& lines) {
+    TRACE_SCOPE(span, "ConfigFileHandler::writeAllLines");
+    TRACE_ARG(span, "lines", lines.size());
     std::ofstream file(configFilePath, std::ios::trunc);
     if (!file.is_open()) {
         lastError = "Cannot open file for writing";
@@ -102,7 +265,6 @@ bool ConfigFileHandler::writeAllLines(const std::vector<std::string>& lines) {
         file << lines[i];
         if (i < lines.size() - 1) file << '\n';
     }
-    setFilePermissions();
     return true;
 }
 bool ConfigFileHandler::checkPermissions() const {
@@ -112,6 +274,62 @@ bool ConfigFileHandler::checkPermissions() const {
 std::string ConfigFileHandler::getLastError() const {
     return lastError;
 }
+ConfigEditor* ConfigFileHandler::editorFor(size_t file) {
+    if (editors[file]) return editors[file].get();
+    auto editor = std::make_unique<ConfigEditor>(transactionFiles[file], shell);
+    if (!editor->open()) {
+        lastError = editor->getLastError();
+        return nullptr;
+    }
+    editors[file] = std::move(editor);
+    return editors[file].get();
+}
+// The files a transaction has to look at for a name: wherever the source graph found it, and the root config,
+// which is where anything added during the transaction goes.
+std::vector<size_t> ConfigFileHandler::filesDefining(const std::string& name) const {
+    std::vector<size_t> files;
+    if (auto defined = definedIn.find(name); defined != definedIn.end()) files = defined->second.files;
+    if (std::find(files.begin(), files.end(), 0) == files.end()) files.push_back(0);
+    return files;
+}
+// An alias lives in its fish function file only while no sourced file defines it as well; edits go to
+// whichever definition fish would actually use.
+bool ConfigFileHandler::isFunctionAlias(const std::string& name) {
+    return !definedIn.contains(name) && !editors[0]->contains(name) && hasFunctionFile(name);
+}
+bool ConfigFileHandler::hasFunctionFile(const std::string& name) const {
+    if (!functions) return false;
+    for (auto it = functionEdits.rbegin(); it != functionEdits.rend(); ++it) {
+        if (it->alias.name == name) return !it->remove;
+    }
+    return functions->defines(name);
+}
+// Snapshots a file other than the root config into the transaction's backup directory, keyed by its own path so
+// it is restored on its own.
+bool ConfigFileHandler::backUp(const std::string& path) {
+    if (transactionBackup == nullptr || !fs::exists(path)) return true;
+    BackupManager backups(path, transactionBackup->getBackupDirectory());
+    if (!backups.createBackup().empty()) return true;
+    lastError = "Failed to create backup of " + path + ": " + backups.getLastError();
+    return false;
+}
+// Another user's config is parsed without the invoking user's cache, whose entries were expanded in this
+// process's environment and would be mixed with theirs.
+bool ConfigFileHandler::loadGraph(SourceGraph& graph, ParseCache& cache) {
+    if (home.empty()) cache.open();
+    if (graph.load(home.empty() ? &cache : nullptr)) return true;
+    lastError = graph.getLastError();
+    return false;
+}
+bool ConfigFileHandler::applyFunctionEdits() {
+    for (const FunctionEdit& edit : functionEdits) {
+        if (edit.remove ? functions->remove(edit.alias.name) : functions->save(edit.alias)) continue;
+        lastError = functions->getLastError();
+        return false;
+    }
+    functionEdits.clear();
+    return true;
+}
 bool ConfigFileHandler::ensureFileExists() {
     if (fs::exists(configFilePath)) return true;
     std::ofstream file(configFilePath);
@@ -119,6 +337,7 @@ bool ConfigFileHandler::ensureFileExists() {
     setFilePermissions();
     return true;
 }
+// Only for a config the handler creates; an existing file keeps whatever mode its owner gave it.
 bool ConfigFileHandler::setFilePermissions() {
     return chmod(configFilePath.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) == 0;
 }
@@ -1,15 +1,33 @@
 #pragma once
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "aliasmanager.hpp"
+#include "aliasstore.hpp"
 #include "shelldetector.hpp"
 
+class BackupManager;
+class ConfigEditor;
+class FishFunctions;
+class ParseCache;
+class SourceGraph;
 class ConfigFileHandler {
 public:
-    ConfigFileHandler(const std::string& configFilePath, ShellDetector::Shell shell);
-    std::vector<Alias> loadAliases();
+    ConfigFileHandler(const std::string& configFilePath, ShellDetector::Shell shell, const std::string& home = "");
+    ~ConfigFileHandler();
+    AliasStore loadAliases();
     bool addAlias(const Alias& alias);
     bool removeAlias(const std::string& aliasName);
+    bool beginTransaction(BackupManager* backupManager = nullptr);
+    bool stageAdd(const Alias& alias);
+    bool stageUpdate(const Alias& alias);
+    bool stageRemove(const std::string& aliasName);
+    bool commitTransaction();
+    size_t changedCount() const;
+    void rollbackTransaction();
+    bool inTransaction() const;
     std::string getConfigFilePath() const;
     bool configFileExists() const;
     std::vector<std::string> readAllLines();
@@ -19,8 +37,37 @@ public:
 private:
     std::string configFilePath;
     ShellDetector::Shell shell;
+    // The owner's home for another user's config (fleet runs), empty for the invoking user's.
+    std::string home;
     std::string lastError;
     AliasManager aliasManager;
+    std::unique_ptr<FishFunctions> functions;
+    std::vector<std::string> transactionFiles;
+    std::vector<std::unique_ptr<ConfigEditor>> editors;
+    // Per file: whether edits may be written back into it rather than overridden from the root config.
+    std::vector<char> writable;
+    // Per name: the files defining it, the command the shell ends up with and how many definitions there are.
+    struct Defined {
+        std::vector<size_t> files;
+        std::string command;
+        size_t count = 0;
+    };
+    std::unordered_map<std::string, Defined> definedIn;
+    std::unordered_set<std::string> changedNames;
+    size_t lastChanged = 0;
+    BackupManager* transactionBackup = nullptr;
+    struct FunctionEdit {
+        Alias alias;
+        bool remove;
+    };
+    std::vector<FunctionEdit> functionEdits;
+    ConfigEditor* editorFor(size_t file);
+    std::vector<size_t> filesDefining(const std::string& name) const;
+    bool isFunctionAlias(const std::string& name);
+    bool hasFunctionFile(const std::string& name) const;
+    bool backUp(const std::string& path);
+    bool loadGraph(SourceGraph& graph, ParseCache& cache);
+    bool applyFunctionEdits();
     bool ensureFileExists();
     bool setFilePermissions();
 };
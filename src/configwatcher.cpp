@@ -0,0 +1,109 @@
+#include "configwatcher.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <sys/stat.h>
+
+static constexpr int CONFIG_SETTLE_MS = 150;
+static constexpr int BACKUP_SETTLE_MS = 300;
+
+ConfigWatcher::ConfigWatcher(QObject* parent) : QObject(parent) {
+    configTimer.setSingleShot(true);
+    configTimer.setInterval(CONFIG_SETTLE_MS);
+    backupTimer.setSingleShot(true);
+    backupTimer.setInterval(BACKUP_SETTLE_MS);
+    connect(&watcher, &QFileSystemWatcher::fileChanged, this, &ConfigWatcher::onFileChanged);
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, this, &ConfigWatcher::onDirectoryChanged);
+    connect(&configTimer, &QTimer::timeout, this, &ConfigWatcher::onConfigSettled);
+    connect(&backupTimer, &QTimer::timeout, this, [this]() {
+        rearm();
+        emit backupsChanged();
+    });
+}
+
+void ConfigWatcher::watchConfig(const std::vector<std::string>& files) {
+    if (files == configFiles) return;
+    for (const auto& file : configFiles) watcher.removePath(QString::fromStdString(file));
+    for (const auto& directory : directories) {
+        if (directory != backupDirectory) watcher.removePath(QString::fromStdString(directory));
+    }
+    std::erase_if(watchedInodes, [this](const auto& watched) { return watched.first != manifestPath; });
+    configFiles = files;
+    directories.clear();
+    // Editors that save by writing a temporary file and renaming it over the original replace the inode the
+    // file watch was on, so the parent directories are watched too and the file watch is re-armed on change.
+    for (const auto& file : configFiles) {
+        std::string directory = std::filesystem::path(file).parent_path().string();
+        if (!directory.empty() && std::find(directories.begin(), directories.end(), directory) == directories.end()) directories.push_back(directory);
+    }
+    for (const auto& directory : directories) watcher.addPath(QString::fromStdString(directory));
+    rearm();
+    markCurrent();
+}
+
+void ConfigWatcher::watchBackups(const std::string& directory, const std::string& manifest) {
+    if (!backupDirectory.empty() && std::find(directories.begin(), directories.end(), backupDirectory) == directories.end()) watcher.removePath(QString::fromStdString(backupDirectory));
+    if (!manifestPath.empty()) watcher.removePath(QString::fromStdString(manifestPath));
+    std::erase_if(watchedInodes, [this](const auto& watched) { return watched.first == manifestPath; });
+    backupDirectory = directory;
+    manifestPath = manifest;
+    if (!backupDirectory.empty()) watcher.addPath(QString::fromStdString(backupDirectory));
+    rearm();
+}
+
+void ConfigWatcher::markCurrent() { stamps = currentStamps(); }
+
+ConfigWatcher::Stamp ConfigWatcher::stampOf(const std::string& path) {
+    struct stat sb;
+    if (stat(path.c_str(), &sb) != 0) return {};
+    return Stamp{sb.st_dev, sb.st_ino, static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec, sb.st_size};
+}
+
+std::vector<ConfigWatcher::Stamp> ConfigWatcher::currentStamps() const {
+    std::vector<Stamp> current;
+    current.reserve(configFiles.size());
+    for (const auto& file : configFiles) current.push_back(stampOf(file));
+    return current;
+}
+
+void ConfigWatcher::watchPath(const std::string& path) {
+    Stamp stamp = stampOf(path);
+    auto watched = std::find_if(watchedInodes.begin(), watchedInodes.end(), [&path](const auto& entry) { return entry.first == path; });
+    if (stamp.size < 0) {
+        if (watched != watchedInodes.end()) watchedInodes.erase(watched);
+        return;
+    }
+    bool listed = watcher.files().contains(QString::fromStdString(path));
+    if (listed && watched != watchedInodes.end() && watched->second == stamp.inode) return;
+    if (listed) watcher.removePath(QString::fromStdString(path));
+    watcher.addPath(QString::fromStdString(path));
+    if (watched != watchedInodes.end()) watched->second = stamp.inode;
+    else watchedInodes.emplace_back(path, stamp.inode);
+}
+
+void ConfigWatcher::rearm() {
+    for (const auto& file : configFiles) watchPath(file);
+    if (!manifestPath.empty()) watchPath(manifestPath);
+}
+
+void ConfigWatcher::onFileChanged(const QString& path) {
+    std::string changed = path.toStdString();
+    if (changed == manifestPath) backupTimer.start();
+    else configTimer.start();
+}
+
+void ConfigWatcher::onDirectoryChanged(const QString& path) {
+    std::string changed = path.toStdString();
+    if (changed == backupDirectory) backupTimer.start();
+    // A watched config path may itself be a directory (fish's functions/), whose mtime moves as files come and go.
+    if (std::find(directories.begin(), directories.end(), changed) != directories.end() || std::find(configFiles.begin(), configFiles.end(), changed) != configFiles.end()) configTimer.start();
+}
+
+void ConfigWatcher::onConfigSettled() {
+    // Bursts of events (an editor's write-rename-chmod, a dotfile sync touching many files) collapse into one
+    // check here, and only a real change in identity, size or mtime of a watched file is reported.
+    rearm();
+    std::vector<Stamp> current = currentStamps();
+    if (current == stamps) return;
+    stamps = std::move(current);
+    emit configChanged();
+}
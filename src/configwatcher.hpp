@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QTimer>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+class ConfigWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ConfigWatcher(QObject* parent = nullptr);
+    void watchConfig(const std::vector<std::string>& files);
+    void watchBackups(const std::string& directory, const std::string& manifestPath);
+    void markCurrent();
+
+signals:
+    void configChanged();
+    void backupsChanged();
+
+private:
+    struct Stamp {
+        dev_t device = 0;
+        ino_t inode = 0;
+        int64_t mtime = 0;
+        off_t size = -1;
+        bool operator==(const Stamp&) const = default;
+    };
+    QFileSystemWatcher watcher;
+    QTimer configTimer;
+    QTimer backupTimer;
+    std::vector<std::string> configFiles;
+    std::vector<Stamp> stamps;
+    std::vector<std::string> directories;
+    std::string backupDirectory;
+    std::string manifestPath;
+    std::vector<std::pair<std::string, ino_t>> watchedInodes;
+    static Stamp stampOf(const std::string& path);
+    std::vector<Stamp> currentStamps() const;
+    void watchPath(const std::string& path);
+    void rearm();
+    void onFileChanged(const QString& path);
+    void onDirectoryChanged(const QString& path);
+    void onConfigSettled();
+};
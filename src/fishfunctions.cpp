@@ -0,0 +1,132 @@
+#include "fishfunctions.hpp"
+#include "fishparser.hpp"
+#include "mappedfile.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+struct FileStamp {
+    dev_t device = 0;
+    ino_t inode = 0;
+    int64_t mtime = 0;
+    off_t size = -1;
+    bool operator==(const FileStamp&) const = default;
+};
+struct CachedFunction {
+    FileStamp stamp;
+    Alias alias;
+};
+// Keyed by directory, then by file path; shared by every FishFunctions instance in the process.
+static std::mutex cacheMutex;
+static std::unordered_map<std::string, std::unordered_map<std::string, CachedFunction>> cache;
+
+static bool writeFully(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+    return true;
+}
+static Alias parseFile(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) return {};
+    Alias alias = FishParser::parseFunction(file.view());
+    // fish autoloads NAME only from NAME.fish; a function defined under another file name isn't reachable.
+    if (alias.name != fs::path(path).stem().string()) return {};
+    return alias;
+}
+
+FishFunctions::FishFunctions(const std::string& directory) : directory(directory) {}
+std::string FishFunctions::directoryFor(const std::string& configFilePath) { return (fs::path(configFilePath).parent_path() / "functions").string(); }
+// Mirrors fish's own `alias` output: --wraps keeps completions working, and the description carries the exact
+// command so the file still reads back when the body spans several lines.
+std::string FishFunctions::format(const Alias& alias) {
+    std::string firstWord = alias.command.substr(0, alias.command.find_first_of(" \t\n"));
+    std::string header = "function " + alias.name;
+    if (firstWord != alias.name) header += " --wraps=" + FishParser::quote(alias.command);
+    return header + " --description " + FishParser::quote("alias " + alias.name + "=" + alias.command) + "\n    " + alias.command + " $argv\nend\n";
+}
+std::string FishFunctions::pathFor(std::string_view name) const { return (fs::path(directory) / (std::string(name) + ".fish")).string(); }
+std::vector<FishFunctions::Function> FishFunctions::load() {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (entry.path().extension() == ".fish") paths.push_back(entry.path().string());
+    }
+    std::sort(paths.begin(), paths.end());
+    std::unordered_map<std::string, CachedFunction> previous;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (auto it = cache.find(directory); it != cache.end()) previous = std::move(it->second);
+    }
+    std::vector<CachedFunction> parsed(paths.size());
+    std::vector<char> present(paths.size(), 0);
+    ThreadPool::shared().parallelFor(paths.size(), [&](size_t i) {
+        struct stat sb;
+        if (::stat(paths[i].c_str(), &sb) != 0 || !S_ISREG(sb.st_mode)) return;
+        FileStamp stamp{sb.st_dev, sb.st_ino, static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec, sb.st_size};
+        present[i] = 1;
+        if (auto it = previous.find(paths[i]); it != previous.end() && it->second.stamp == stamp) {
+            parsed[i] = it->second;
+            return;
+        }
+        parsed[i] = CachedFunction{stamp, parseFile(paths[i])};
+    });
+    std::vector<Function> functions;
+    std::unordered_map<std::string, CachedFunction> current;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!present[i]) continue;
+        if (!parsed[i].alias.name.empty()) functions.push_back(Function{parsed[i].alias, paths[i]});
+        current.emplace(std::move(paths[i]), std::move(parsed[i]));
+    }
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache[directory] = std::move(current);
+    return functions;
+}
+Alias FishFunctions::read(const std::string& name) const { return parseFile(pathFor(name)); }
+bool FishFunctions::defines(const std::string& name) const { return !read(name).name.empty(); }
+bool FishFunctions::save(const Alias& alias) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        lastError = "Cannot create functions directory: " + directory;
+        return false;
+    }
+    std::string path = pathFor(alias.name);
+    std::string tempPath = (fs::path(directory) / ("." + alias.name + ".fish.aliacan-XXXXXX")).string();
+    int fd = mkstemp(tempPath.data());
+    if (fd < 0) {
+        lastError = "Cannot create temporary file: " + std::string(std::strerror(errno));
+        return false;
+    }
+    bool ok = writeFully(fd, format(alias)) && fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) == 0 && fsync(fd) == 0;
+    if (::close(fd) != 0) ok = false;
+    if (!ok || ::rename(tempPath.c_str(), path.c_str()) != 0) {
+        lastError = "Failed to write function file: " + std::string(std::strerror(errno));
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+bool FishFunctions::remove(const std::string& name) {
+    if (::unlink(pathFor(name).c_str()) != 0) {
+        lastError = "Cannot remove function file " + pathFor(name) + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+std::string FishFunctions::getDirectory() const { return directory; }
+std::string FishFunctions::getLastError() const { return lastError; }
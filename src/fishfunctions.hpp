@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "aliasmanager.hpp"
+
+// Aliases kept the way fish keeps them once saved: one NAME.fish function file per alias in the functions
+// directory next to config.fish (what `funcsave` and `alias --save` write). load() parses the directory in
+// parallel and reuses the previous result for every file whose inode, size and mtime are unchanged, so an
+// install with hundreds of function files only re-reads the ones that were edited.
+class FishFunctions {
+public:
+    struct Function {
+        Alias alias;
+        std::string path;
+    };
+    explicit FishFunctions(const std::string& directory);
+    static std::string directoryFor(const std::string& configFilePath);
+    static std::string format(const Alias& alias);
+    std::vector<Function> load();
+    Alias read(const std::string& name) const;
+    bool defines(const std::string& name) const;
+    bool save(const Alias& alias);
+    bool remove(const std::string& name);
+    std::string pathFor(std::string_view name) const;
+    std::string getDirectory() const;
+    std::string getLastError() const;
+private:
+    std::string directory;
+    std::string lastError;
+};
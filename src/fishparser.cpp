@@ -0,0 +1,304 @@
+#include "fishparser.hpp"
+#include <cstdint>
+#include <cstring>
+
+static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+static bool isOperator(char c) { return c == '|' || c == '&' || c == '<' || c == '>'; }
+static int hexValue(char c) { return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1; }
+static bool startsWithKeyword(std::string_view text, std::string_view keyword) {
+    return text.starts_with(keyword) && (text.size() == keyword.size() || isBlank(text[keyword.size()]) || text[keyword.size()] == '\n');
+}
+static void appendUtf8(std::string& out, uint32_t value) {
+    if (value < 0x80) {
+        out += static_cast<char>(value);
+        return;
+    }
+    char utf8[4];
+    size_t length = value < 0x800 ? 2 : value < 0x10000 ? 3 : 4;
+    for (size_t i = length - 1; i > 0; --i, value >>= 6) utf8[i] = static_cast<char>(0x80 | (value & 0x3f));
+    utf8[0] = static_cast<char>((length == 2 ? 0xc0 : length == 3 ? 0xe0 : 0xf0) | value);
+    out.append(utf8, length);
+}
+
+FishParser::FishParser(std::string_view buffer) : buffer(buffer) {}
+const std::vector<FishParser::Definition>& FishParser::definitions() const { return parsed; }
+size_t FishParser::prefixEnd() const { return prefix; }
+size_t FishParser::end() const { return statementEnd; }
+std::string_view FishParser::text(const Word& word) const { return std::string_view(scratch).substr(word.begin, word.end - word.begin); }
+// Always single-quoted: inside '...' fish only interprets \\ and \', so escaping those two is enough for any
+// byte string, newlines included, to come back unchanged.
+std::string FishParser::quote(std::string_view text) {
+    std::string quoted;
+    quoted.reserve(text.size() + 2);
+    quoted += '\'';
+    for (char c : text) {
+        if (c == '\\' || c == '\'') quoted += '\\';
+        quoted += c;
+    }
+    quoted += '\'';
+    return quoted;
+}
+size_t FishParser::readEscape(size_t pos) {
+    if (pos >= buffer.size()) {
+        scratch += '\\';
+        return pos;
+    }
+    char c = buffer[pos];
+    switch (c) {
+        case '\n': return pos + 1;
+        case 'a': scratch += '\a'; return pos + 1;
+        case 'b': scratch += '\b'; return pos + 1;
+        case 'e': scratch += '\x1b'; return pos + 1;
+        case 'f': scratch += '\f'; return pos + 1;
+        case 'n': scratch += '\n'; return pos + 1;
+        case 'r': scratch += '\r'; return pos + 1;
+        case 't': scratch += '\t'; return pos + 1;
+        case 'v': scratch += '\v'; return pos + 1;
+        case 'c':
+            if (pos + 1 < buffer.size()) {
+                scratch += static_cast<char>(buffer[pos + 1] & 0x1f);
+                return pos + 2;
+            }
+            break;
+        case 'x': case 'X': case 'u': case 'U': {
+            size_t limit = c == 'u' ? 4 : c == 'U' ? 8 : 2, digits = 0;
+            uint32_t value = 0;
+            while (digits < limit && pos + 1 + digits < buffer.size() && hexValue(buffer[pos + 1 + digits]) >= 0) value = value * 16 + static_cast<uint32_t>(hexValue(buffer[pos + 1 + digits++]));
+            if (digits == 0) break;
+            if (c == 'x' || c == 'X') scratch += static_cast<char>(value);
+            else appendUtf8(scratch, value);
+            return pos + 1 + digits;
+        }
+        default:
+            if (c >= '0' && c <= '7') {
+                size_t digits = 0;
+                unsigned value = 0;
+                while (digits < 3 && pos + digits < buffer.size() && buffer[pos + digits] >= '0' && buffer[pos + digits] <= '7') value = value * 8 + static_cast<unsigned>(buffer[pos + digits++] - '0');
+                scratch += static_cast<char>(value);
+                return pos + digits;
+            }
+            break;
+    }
+    scratch += c;
+    return pos + 1;
+}
+size_t FishParser::readWord(size_t pos, Word& word, bool operators) {
+    const size_t size = buffer.size();
+    word.rawBegin = pos;
+    word.begin = scratch.size();
+    size_t i = pos;
+    while (i < size) {
+        char c = buffer[i];
+        if (isBlank(c) || c == '\n' || c == ';' || (operators && isOperator(c))) break;
+        if (c == '\'' || c == '"') {
+            const size_t quoteStart = i, mark = scratch.size();
+            bool closed = false;
+            for (++i; i < size; ++i) {
+                char q = buffer[i];
+                if (q == c) {
+                    closed = true;
+                    ++i;
+                    break;
+                }
+                if (q == '\\' && i + 1 < size) {
+                    char next = buffer[i + 1];
+                    if (next == c || next == '\\' || (c == '"' && next == '$')) {
+                        scratch += next;
+                        ++i;
+                        continue;
+                    }
+                    if (c == '"' && next == '\n') {
+                        ++i;
+                        continue;
+                    }
+                }
+                scratch += q;
+            }
+            if (!closed) {
+                // Same recovery as AliasParser: an unterminated quote takes the rest of its line literally.
+                scratch.resize(mark);
+                auto* newline = static_cast<const char*>(std::memchr(buffer.data() + quoteStart, '\n', size - quoteStart));
+                size_t lineEnd = newline != nullptr ? static_cast<size_t>(newline - buffer.data()) : size;
+                size_t contentEnd = lineEnd > quoteStart + 1 && buffer[lineEnd - 1] == '\r' ? lineEnd - 1 : lineEnd;
+                if (contentEnd > quoteStart + 1) scratch.append(buffer.substr(quoteStart + 1, contentEnd - quoteStart - 1));
+                i = lineEnd;
+                break;
+            }
+        } else if (c == '\\') {
+            i = readEscape(i + 1);
+        } else if (c == '(') {
+            // Command substitutions are part of the word in fish and kept verbatim.
+            size_t depth = 0, from = i;
+            for (; i < size; ++i) {
+                if (buffer[i] == '(') ++depth;
+                else if (buffer[i] == ')' && --depth == 0) break;
+            }
+            i = i < size ? i + 1 : size;
+            scratch.append(buffer.substr(from, i - from));
+        } else {
+            scratch += c;
+            ++i;
+        }
+    }
+    word.rawEnd = i;
+    word.end = scratch.size();
+    return i;
+}
+// Splits one statement into words. `operators` ends it at | & < > as well as ; and newlines; function bodies are
+// read without it so a pipeline stays one statement.
+size_t FishParser::readStatement(size_t pos, bool operators) {
+    words.clear();
+    scratch.clear();
+    const size_t size = buffer.size();
+    size_t i = pos;
+    while (i < size) {
+        char c = buffer[i];
+        if (isBlank(c)) {
+            ++i;
+        } else if (c == '\\' && i + 1 < size && buffer[i + 1] == '\n') {
+            i += 2;
+        } else if (c == '\n') {
+            statementEnd = i + 1;
+            return i + 1;
+        } else if (c == '#') {
+            auto* newline = static_cast<const char*>(std::memchr(buffer.data() + i, '\n', size - i));
+            statementEnd = newline != nullptr ? static_cast<size_t>(newline - buffer.data()) + 1 : size;
+            return statementEnd;
+        } else if (c == ';' || (operators && isOperator(c))) {
+            statementEnd = i;
+            return i + 1;
+        } else {
+            Word word;
+            i = readWord(i, word, operators);
+            words.push_back(word);
+        }
+    }
+    statementEnd = size;
+    return size;
+}
+// Options before the name are skipped; `alias` only has flags (-s, -h), so the first other word is the name.
+size_t FishParser::aliasName() const {
+    for (size_t w = 0; w < words.size(); ++w) {
+        std::string_view word = text(words[w]);
+        if (word == "--") return w + 1;
+        if (!word.starts_with('-')) return w;
+    }
+    return words.size();
+}
+// `abbr` also takes --position/--regex/--function/--set-cursor values and has subcommands that define nothing
+// (--erase, --list, --show, --query, --rename). Abbreviations computed by --regex or --function aren't aliases.
+size_t FishParser::abbrName() const {
+    for (size_t w = 0; w < words.size(); ++w) {
+        std::string_view word = text(words[w]);
+        if (word == "--") return w + 1;
+        if (!word.starts_with('-') || word == "-") return w;
+        if (word.starts_with("--")) {
+            std::string_view option = word.substr(2, word.find('=') - 2);
+            if (option == "erase" || option == "list" || option == "show" || option == "query" || option == "rename" || option == "help" || option == "regex" || option == "function") return words.size();
+            if (option == "position" && word.find('=') == std::string_view::npos) ++w;
+            continue;
+        }
+        for (size_t k = 1; k < word.size(); ++k) {
+            char flag = word[k];
+            if (std::strchr("elsqhrf", flag) != nullptr) return words.size();
+            if (flag == 'p') {
+                if (k + 1 == word.size()) ++w;
+                break;
+            }
+        }
+    }
+    return words.size();
+}
+bool FishParser::parse(size_t keyword) {
+    parsed.clear();
+    words.clear();
+    scratch.clear();
+    if (keyword > buffer.size()) return false;
+    std::string_view rest = buffer.substr(keyword);
+    const bool abbr = startsWithKeyword(rest, ABBR);
+    if (!abbr && !startsWithKeyword(rest, ALIAS)) return false;
+    readStatement(keyword + (abbr ? ABBR : ALIAS).size(), true);
+    size_t name = abbr ? abbrName() : aliasName();
+    prefix = name < words.size() ? words[name].rawBegin : statementEnd;
+    if (name >= words.size()) return true;
+    size_t nameBegin = words[name].begin, nameEnd = words[name].end, commandBegin, commandEnd;
+    if (name + 1 < words.size()) {
+        commandBegin = words[name + 1].begin;
+        commandEnd = words[name + 1].end;
+        if (name + 2 < words.size()) {
+            // fish joins the remaining arguments with spaces; copy them once past the decoded words.
+            size_t length = 0;
+            for (size_t w = name + 1; w < words.size(); ++w) length += words[w].end - words[w].begin + 1;
+            scratch.reserve(scratch.size() + length);
+            commandBegin = scratch.size();
+            for (size_t w = name + 1; w < words.size(); ++w) {
+                if (w > name + 1) scratch += ' ';
+                scratch.append(scratch.data() + words[w].begin, words[w].end - words[w].begin);
+            }
+            commandEnd = scratch.size();
+        }
+    } else {
+        size_t equals = text(words[name]).find('=');
+        if (abbr || equals == std::string_view::npos || equals == 0) return true;
+        nameEnd = nameBegin + equals;
+        commandBegin = nameEnd + 1;
+        commandEnd = words[name].end;
+    }
+    std::string_view decoded(scratch);
+    parsed.push_back(Definition{decoded.substr(nameBegin, nameEnd - nameBegin), decoded.substr(commandBegin, commandEnd - commandBegin), words[name].rawBegin, words.back().rawEnd - words[name].rawBegin});
+    return true;
+}
+// Recognises the files `funcsave` writes for an alias: `function NAME ...` with a one-statement body, whose
+// trailing `$argv` is dropped. Longer bodies still count when the description is fish's own `alias NAME=...`.
+Alias FishParser::parseFunction(std::string_view content) {
+    FishParser parser(content);
+    size_t pos = 0;
+    while (pos < content.size()) {
+        pos = parser.readStatement(pos, false);
+        if (!parser.words.empty()) break;
+    }
+    if (parser.words.size() < 2 || parser.text(parser.words[0]) != "function") return {};
+    Alias alias{std::string(parser.text(parser.words[1])), {}};
+    std::string description;
+    for (size_t w = 2; w < parser.words.size(); ++w) {
+        std::string_view word = parser.text(parser.words[w]);
+        if ((word == "-d" || word == "--description") && w + 1 < parser.words.size()) description = parser.text(parser.words[++w]);
+        else if (word.starts_with("--description=")) description = word.substr(14);
+    }
+    size_t depth = 1, statements = 0;
+    bool blocks = false;
+    std::string_view body;
+    while (pos < content.size() && depth > 0) {
+        pos = parser.readStatement(pos, false);
+        if (parser.words.empty()) continue;
+        std::string_view first = parser.text(parser.words[0]);
+        if (first == "end") {
+            --depth;
+            continue;
+        }
+        if (depth == 1) {
+            ++statements;
+            body = content.substr(parser.words.front().rawBegin, parser.words.back().rawEnd - parser.words.front().rawBegin);
+        }
+        if (first == "if" || first == "for" || first == "while" || first == "switch" || first == "begin" || first == "function") {
+            blocks = true;
+            ++depth;
+        }
+    }
+    if (depth != 0 || alias.name.empty()) return {};
+    if (statements == 1 && !blocks && body.find('\n') == std::string_view::npos) {
+        if (body == "$argv") body = {};
+        else if (body.ends_with("$argv") && isBlank(body[body.size() - 6])) body.remove_suffix(6);
+        while (!body.empty() && isBlank(body.back())) body.remove_suffix(1);
+        if (!body.empty()) {
+            alias.command = body;
+            return alias;
+        }
+    }
+    std::string prefix = "alias " + alias.name + "=";
+    if (description.starts_with(prefix) && description.size() > prefix.size()) {
+        alias.command = description.substr(prefix.size());
+        return alias;
+    }
+    return {};
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "aliasmanager.hpp"
+#include "aliasparser.hpp"
+
+// Tokenizer for fish `alias NAME DEFINITION...`, `alias NAME=DEFINITION` and `abbr [-a] NAME EXPANSION...`
+// statements, with the same interface as AliasParser so AliasScanner can drive either. Quote removal follows
+// fish rather than POSIX: '...' only knows \' and \\, "..." knows \" \$ \\ and line continuations, and there is
+// no $'...'. Definitions spread over several words are joined with single spaces, as fish itself does.
+class FishParser {
+public:
+    using Definition = AliasParser::Definition;
+    static constexpr std::string_view ALIAS = "alias";
+    static constexpr std::string_view ABBR = "abbr";
+    explicit FishParser(std::string_view buffer);
+    bool parse(size_t keyword);
+    const std::vector<Definition>& definitions() const;
+    size_t prefixEnd() const;
+    size_t end() const;
+    static bool startsStatement(char c) { return c == ALIAS[0] || c == ABBR[0]; }
+    static std::string quote(std::string_view text);
+    static Alias parseFunction(std::string_view content);
+private:
+    struct Word {
+        size_t rawBegin = 0;
+        size_t rawEnd = 0;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+    std::string_view buffer;
+    std::string scratch;
+    std::vector<Word> words;
+    std::vector<Definition> parsed;
+    size_t prefix = 0;
+    size_t statementEnd = 0;
+    size_t readStatement(size_t pos, bool operators);
+    size_t readWord(size_t pos, Word& word, bool operators);
+    size_t readEscape(size_t pos);
+    std::string_view text(const Word& word) const;
+    size_t aliasName() const;
+    size_t abbrName() const;
+};
@@ -0,0 +1,73 @@
+#include "fleet.hpp"
+#include "backupmanager.hpp"
+#include "configfilehandler.hpp"
+#include "threadpool.hpp"
+#include <chrono>
+#include <filesystem>
+#include <exception>
+
+namespace fs = std::filesystem;
+FleetReport Fleet::run(const FleetOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    FleetReport report;
+    report.results.resize(options.homes.size());
+    ThreadPool pool(options.jobs);
+    pool.parallelFor(options.homes.size(), [&](size_t i) { report.results[i] = processHome(options.homes[i], options); });
+    for (const auto& result : report.results) {
+        result.ok ? ++report.succeeded : ++report.failed;
+        report.totalAliases += result.aliasCount;
+        report.totalChanged += result.changed;
+    }
+    report.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+FleetResult Fleet::processHome(const std::string& home, const FleetOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    FleetResult result;
+    result.home = home;
+    auto finish = [&](bool ok, std::string error = "") {
+        result.ok = ok;
+        result.error = std::move(error);
+        result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    };
+    try {
+        std::error_code ec;
+        if (!fs::is_directory(home, ec)) return finish(false, "Home directory does not exist: " + home);
+        result.shell = ShellDetector::detectShellForHome(home);
+        result.configPath = ShellDetector::getConfigFilePath(result.shell, home);
+        ConfigFileHandler handler(result.configPath, result.shell, home);
+        if (!handler.configFileExists()) return finish(false, "Config file does not exist: " + result.configPath);
+        if (!options.additions.empty() || !options.removals.empty()) {
+            BackupManager backups(result.configPath, (fs::path(home) / ".shellbackup").string());
+            bool staged = handler.beginTransaction(options.backup ? &backups : nullptr);
+            for (const auto& alias : options.additions) {
+                if (!staged) break;
+                staged = handler.stageAdd(alias);
+            }
+            for (const auto& name : options.removals) {
+                if (staged) handler.stageRemove(name);
+            }
+            if (!staged || !handler.commitTransaction()) {
+                handler.rollbackTransaction();
+                return finish(false, handler.getLastError());
+            }
+            result.changed = handler.changedCount();
+        }
+        result.aliasCount = handler.loadAliases().size();
+        return finish(true);
+    } catch (const std::exception& e) {
+        return finish(false, e.what());
+    }
+}
+std::vector<std::string> Fleet::readHomeList(std::istream& input) {
+    std::vector<std::string> homes;
+    std::string line;
+    while (std::getline(input, line)) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#') continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        homes.push_back(line.substr(start, end - start + 1));
+    }
+    return homes;
+}
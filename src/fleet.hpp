@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+#include "aliasmanager.hpp"
+#include "shelldetector.hpp"
+
+struct FleetOptions {
+    std::vector<std::string> homes;
+    std::vector<Alias> additions;
+    std::vector<std::string> removals;
+    bool backup = true;
+    size_t jobs = 0;
+};
+struct FleetResult {
+    std::string home;
+    ShellDetector::Shell shell = ShellDetector::Shell::UNKNOWN;
+    std::string configPath;
+    size_t aliasCount = 0;
+    size_t changed = 0;
+    bool ok = false;
+    std::string error;
+    double elapsedMs = 0;
+};
+struct FleetReport {
+    std::vector<FleetResult> results;
+    size_t succeeded = 0;
+    size_t failed = 0;
+    size_t totalAliases = 0;
+    size_t totalChanged = 0;
+    double elapsedMs = 0;
+};
+class Fleet {
+public:
+    static FleetReport run(const FleetOptions& options);
+    static FleetResult processHome(const std::string& home, const FleetOptions& options);
+    static std::vector<std::string> readHomeList(std::istream& input);
+};
@@ -0,0 +1,265 @@
+#include "historyusage.hpp"
+#include "mappedfile.hpp"
+#include "pathindex.hpp"
+#include "sha256.hpp"
+#include "threadpool.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+static constexpr std::string_view CACHE_MAGIC = "alia-can-history-usage";
+// Enough of the already-counted file to notice a rewrite without hashing all of it on every update.
+static constexpr size_t DIGEST_BYTES = 4096;
+
+static int64_t number(std::string_view text) {
+    int64_t value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+static bool isTimestampLine(std::string_view line) {
+    return line.size() > 1 && line[0] == '#' && std::all_of(line.begin() + 1, line.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+}
+static size_t nextLine(std::string_view text, size_t position) {
+    size_t newline = text.find('\n', position);
+    return newline == std::string_view::npos ? text.size() : newline + 1;
+}
+
+HistoryUsage::HistoryUsage(ShellDetector::Shell shell, std::string historyPath, std::string cachePath)
+    : shell(shell), historyPath(historyPath.empty() ? defaultHistoryPath(shell) : std::move(historyPath)),
+      cachePath(cachePath.empty() ? defaultCachePath(shell) : std::move(cachePath)) {}
+// $HISTFILE is a shell variable that is rarely exported, so it only counts when it is.
+std::string HistoryUsage::defaultHistoryPath(ShellDetector::Shell shell, const std::string& home) {
+    if (shell == ShellDetector::Shell::FISH) {
+        const char* data = home.empty() ? std::getenv("XDG_DATA_HOME") : nullptr;
+        if (data != nullptr && *data == '/') return std::string(data) + "/fish/fish_history";
+        return ShellDetector::expandHome("~/.local/share/fish/fish_history", home);
+    }
+    const char* histfile = home.empty() ? std::getenv("HISTFILE") : nullptr;
+    if (histfile != nullptr && *histfile == '/') return histfile;
+    return ShellDetector::expandHome(shell == ShellDetector::Shell::ZSH ? "~/.zsh_history" : "~/.bash_history", home);
+}
+std::string HistoryUsage::defaultCachePath(ShellDetector::Shell shell) {
+    std::string name = ShellDetector::getShellName(shell);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ShellDetector::cacheDirectory() + "/history-" + name;
+}
+void HistoryUsage::count(std::string_view text, ShellDetector::Shell shell, Counts& counts) {
+    forEachEntry(text, shell, [&counts](std::string_view command, int64_t when) {
+        std::string_view word = PathIndex::commandWord(command);
+        if (word.empty()) return;
+        auto it = counts.find(word);
+        if (it == counts.end()) it = counts.emplace(std::string(word), Usage{}).first;
+        ++it->second.count;
+        it->second.lastUsed = std::max(it->second.lastUsed, when);
+    });
+}
+// `text` starts at an entry and ends after a whole line. Multi-line entries are reported once, by their first
+// line: zsh marks continued lines with a trailing backslash, fish escapes newlines, and bash's extra lines
+// (which it does not mark) come out as entries of their own.
+void HistoryUsage::forEachEntry(std::string_view text, ShellDetector::Shell shell, const std::function<void(std::string_view command, int64_t when)>& onEntry) {
+    int64_t when = 0;
+    std::string_view pending;
+    bool hasPending = false;
+    bool continued = false;
+    for (size_t begin = 0; begin < text.size();) {
+        size_t end = nextLine(text, begin);
+        std::string_view line = text.substr(begin, end - begin);
+        if (line.ends_with('\n')) line.remove_suffix(1);
+        begin = end;
+        if (shell == ShellDetector::Shell::FISH) {
+            if (line.starts_with("- cmd: ")) {
+                if (hasPending) onEntry(pending, when);
+                pending = line.substr(7);
+                hasPending = true;
+                when = 0;
+            } else if (line.starts_with("  when: ")) {
+                when = number(line.substr(8));
+            }
+        } else if (shell == ShellDetector::Shell::ZSH) {
+            const bool partOfPrevious = continued;
+            continued = line.ends_with('\\');
+            if (partOfPrevious) continue;
+            when = 0;
+            if (size_t colon = line.find(':', 2), semicolon = line.find(';'); line.starts_with(": ") && colon < semicolon && semicolon != std::string_view::npos) {
+                when = number(line.substr(2, colon - 2));
+                line.remove_prefix(semicolon + 1);
+            }
+            onEntry(line, when);
+        } else if (isTimestampLine(line)) {
+            when = number(line.substr(1));
+        } else {
+            onEntry(line, when);
+            when = 0;
+        }
+    }
+    if (hasPending) onEntry(pending, when);
+}
+// The start of the first entry at or after `position`, so no chunk begins in the middle of one. For bash it can
+// be the line before `position`, when a chunk would otherwise start between a timestamp and its command.
+size_t HistoryUsage::entryBoundary(std::string_view text, size_t position, ShellDetector::Shell shell) {
+    size_t start = position == 0 ? 0 : nextLine(text, position - 1);
+    if (shell == ShellDetector::Shell::FISH) {
+        while (start < text.size() && !text.substr(start).starts_with("- cmd:")) start = nextLine(text, start);
+    } else if (shell == ShellDetector::Shell::ZSH) {
+        while (start < text.size() && start >= 2 && text[start - 2] == '\\') start = nextLine(text, start);
+    } else if (start > 0 && start < text.size() && !isTimestampLine(text.substr(start, nextLine(text, start) - start - 1))) {
+        // A command belongs with the `#epoch` line before it.
+        size_t previous = start >= 2 ? text.rfind('\n', start - 2) : std::string_view::npos;
+        previous = previous == std::string_view::npos ? 0 : previous + 1;
+        if (isTimestampLine(text.substr(previous, start - 1 - previous))) start = previous;
+    }
+    return start;
+}
+// `parts` chunks of about equal size that each start at an entry, as `parts + 1` offsets into `text`.
+std::vector<size_t> HistoryUsage::chunkBounds(std::string_view text, ShellDetector::Shell shell, size_t parts) {
+    parts = std::max<size_t>(parts, 1);
+    std::vector<size_t> bounds(parts + 1, text.size());
+    bounds[0] = 0;
+    for (size_t i = 1; i < parts; ++i) bounds[i] = std::max(bounds[i - 1], entryBoundary(text, i * (text.size() / parts), shell));
+    return bounds;
+}
+std::string HistoryUsage::digestBefore(std::string_view text, size_t end) {
+    const size_t length = std::min(end, DIGEST_BYTES);
+    return Sha256::hex(text.substr(end - length, length));
+}
+void HistoryUsage::reset() {
+    counts.clear();
+    device = 0;
+    inode = 0;
+    offset = 0;
+    tailDigest.clear();
+}
+// A missing history file is not an error: the shell may not have written one yet, or keeps none.
+bool HistoryUsage::update() {
+    TRACE_SCOPE(span, "HistoryUsage::update");
+    std::lock_guard<std::mutex> lock(mutex);
+    scanned = 0;
+    if (!cacheLoaded) {
+        cacheLoaded = true;
+        loadCache();
+    }
+    struct stat sb;
+    if (::stat(historyPath.c_str(), &sb) != 0) {
+        if (errno != ENOENT) {
+            lastError = "Cannot stat " + historyPath + ": " + std::strerror(errno);
+            return false;
+        }
+        reset();
+        return true;
+    }
+    MappedFile file;
+    if (!file.open(historyPath)) {
+        lastError = file.getLastError();
+        return false;
+    }
+    const std::string_view text = file.view();
+    if (sb.st_dev != device || sb.st_ino != inode || offset > text.size() || (offset > 0 && digestBefore(text, offset) != tailDigest)) {
+        reset();
+        device = sb.st_dev;
+        inode = sb.st_ino;
+    }
+    // Only whole lines; a line still being written is read next time.
+    size_t newline = text.rfind('\n');
+    const size_t end = newline == std::string_view::npos || newline < offset ? offset : newline + 1;
+    const std::string_view fresh = text.substr(offset, end - offset);
+    if (fresh.empty()) return true;
+    TRACE_ARG(span, "bytes", fresh.size());
+
+    const size_t parts = fresh.size() / CHUNK_SIZE + 1;
+    const std::vector<size_t> bounds = chunkBounds(fresh, shell, parts);
+    std::vector<Counts> partial(parts);
+    ThreadPool::shared().parallelFor(parts, [&](size_t i) { count(fresh.substr(bounds[i], bounds[i + 1] - bounds[i]), shell, partial[i]); });
+    for (const Counts& part : partial) {
+        for (const auto& [word, usage] : part) {
+            Usage& total = counts[word];
+            total.count += usage.count;
+            total.lastUsed = std::max(total.lastUsed, usage.lastUsed);
+        }
+    }
+    scanned = fresh.size();
+    offset = end;
+    tailDigest = digestBefore(text, end);
+    return saveCache();
+}
+HistoryUsage::Usage HistoryUsage::usage(std::string_view word) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = counts.find(word);
+    return it == counts.end() ? Usage{} : it->second;
+}
+// Indexed by alias id, like PathIndex::checkAll.
+std::vector<HistoryUsage::Usage> HistoryUsage::forAliases(const AliasStore& aliases) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Usage> usages(aliases.slotCount());
+    for (const auto& alias : aliases) {
+        if (auto it = counts.find(alias.name); it != counts.end()) usages[alias.id] = it->second;
+    }
+    return usages;
+}
+size_t HistoryUsage::wordCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counts.size();
+}
+uint64_t HistoryUsage::lastScannedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return scanned;
+}
+const std::string& HistoryUsage::getHistoryPath() const { return historyPath; }
+std::string HistoryUsage::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastError;
+}
+// Text, one word per line after a header naming the history file and how far it was read; a cache for another
+// history file, an older version or a damaged one is ignored and the history is counted from the start.
+bool HistoryUsage::loadCache() {
+    std::ifstream in(cachePath);
+    std::string magic, path;
+    uint32_t version = 0;
+    if (!(in >> magic >> version) || magic != CACHE_MAGIC || version != VERSION) return false;
+    in.ignore(1);
+    if (!std::getline(in, path, '\t') || path != historyPath || !(in >> device >> inode >> offset >> tailDigest)) {
+        reset();
+        return false;
+    }
+    in.ignore(1);
+    for (std::string line; std::getline(in, line);) {
+        size_t first = line.find('\t'), second = line.rfind('\t');
+        if (first == std::string::npos || first == second) {
+            reset();
+            return false;
+        }
+        Usage& usage = counts[line.substr(0, first)];
+        usage.count = static_cast<uint64_t>(number(std::string_view(line).substr(first + 1, second - first - 1)));
+        usage.lastUsed = number(std::string_view(line).substr(second + 1));
+    }
+    return true;
+}
+bool HistoryUsage::saveCache() {
+    std::error_code ec;
+    fs::create_directories(fs::path(cachePath).parent_path(), ec);
+    const std::string tempPath = cachePath + "." + std::to_string(::getpid()) + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        out << CACHE_MAGIC << ' ' << VERSION << '\n' << historyPath << '\t' << device << ' ' << inode << ' ' << offset << ' ' << (tailDigest.empty() ? "-" : tailDigest) << '\n';
+        for (const auto& [word, usage] : counts) out << word << '\t' << usage.count << '\t' << usage.lastUsed << '\n';
+        if (!out.flush()) {
+            lastError = "Failed to write history cache: " + tempPath;
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+    if (::rename(tempPath.c_str(), cachePath.c_str()) != 0) {
+        lastError = "Failed to write history cache: " + std::string(std::strerror(errno));
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
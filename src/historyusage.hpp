@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "aliasstore.hpp"
+#include "shelldetector.hpp"
+
+// How often, and when last, each command word starts an entry of the shell's history file: bash (with `#epoch`
+// lines when HISTTIMEFORMAT is set), zsh (plain or EXTENDED_HISTORY `: epoch:duration;command`) and fish's
+// `- cmd:`/`when:` records. The file is mapped and cut at entry boundaries into chunks that are counted in
+// parallel on the shared pool. Counts are kept per word rather than per alias, so they stay valid when aliases
+// change, and are cached on disk together with how far the file was read; update() then only reads what was
+// appended since. A history file that was rewritten rather than appended to (a different inode, a shorter
+// file, or different bytes before the old end) is counted again from the start. Safe to use from any thread.
+class HistoryUsage {
+public:
+    struct Usage {
+        uint64_t count = 0;
+        // Seconds since the epoch; 0 when the history has no timestamps.
+        int64_t lastUsed = 0;
+    };
+    struct WordHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view word) const { return std::hash<std::string_view>{}(word); }
+    };
+    using Counts = std::unordered_map<std::string, Usage, WordHash, std::equal_to<>>;
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t CHUNK_SIZE = size_t{1} << 20;
+    explicit HistoryUsage(ShellDetector::Shell shell, std::string historyPath = "", std::string cachePath = "");
+    static std::string defaultHistoryPath(ShellDetector::Shell shell, const std::string& home = "");
+    static std::string defaultCachePath(ShellDetector::Shell shell);
+    static void count(std::string_view text, ShellDetector::Shell shell, Counts& counts);
+    static void forEachEntry(std::string_view text, ShellDetector::Shell shell, const std::function<void(std::string_view command, int64_t when)>& onEntry);
+    static std::vector<size_t> chunkBounds(std::string_view text, ShellDetector::Shell shell, size_t parts);
+    bool update();
+    Usage usage(std::string_view word) const;
+    std::vector<Usage> forAliases(const AliasStore& aliases) const;
+    size_t wordCount() const;
+    uint64_t lastScannedBytes() const;
+    const std::string& getHistoryPath() const;
+    std::string getLastError() const;
+private:
+    ShellDetector::Shell shell;
+    std::string historyPath;
+    std::string cachePath;
+    mutable std::mutex mutex;
+    Counts counts;
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    uint64_t offset = 0;
+    std::string tailDigest;
+    uint64_t scanned = 0;
+    bool cacheLoaded = false;
+    std::string lastError;
+    void reset();
+    bool loadCache();
+    bool saveCache();
+    static size_t entryBoundary(std::string_view text, size_t position, ShellDetector::Shell shell);
+    static std::string digestBefore(std::string_view text, size_t end);
+};
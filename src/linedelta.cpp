@@ -0,0 +1,93 @@
+#include "linedelta.hpp"
+#include <charconv>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+static std::vector<std::string_view> splitLines(std::string_view text) {
+    std::vector<std::string_view> lines;
+    while (!text.empty()) {
+        size_t newline = text.find('\n');
+        size_t length = newline == std::string_view::npos ? text.size() : newline + 1;
+        lines.push_back(text.substr(0, length));
+        text.remove_prefix(length);
+    }
+    return lines;
+}
+static void emitCopy(std::string& delta, size_t start, size_t count) {
+    if (count > 0) delta += "C " + std::to_string(start) + ' ' + std::to_string(count) + '\n';
+}
+static void emitInsert(std::string& delta, std::string_view literal) {
+    if (literal.empty()) return;
+    delta += "I " + std::to_string(literal.size()) + '\n';
+    delta += literal;
+}
+static bool readNumber(std::string_view& text, size_t& value) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc()) return false;
+    text.remove_prefix(static_cast<size_t>(end - text.data()));
+    return true;
+}
+
+std::string LineDelta::encode(std::string_view base, std::string_view target) {
+    std::vector<std::string_view> baseLines = splitLines(base);
+    std::vector<std::string_view> targetLines = splitLines(target);
+    std::unordered_map<std::string_view, uint32_t> firstOccurrence;
+    firstOccurrence.reserve(baseLines.size());
+    for (uint32_t i = 0; i < baseLines.size(); ++i) firstOccurrence.try_emplace(baseLines[i], i);
+    std::string delta;
+    size_t copyStart = 0, copyCount = 0;
+    const char* literalStart = nullptr;
+    size_t literalLength = 0;
+    auto flushLiteral = [&] { emitInsert(delta, std::string_view(literalStart, literalLength)); literalStart = nullptr; literalLength = 0; };
+    for (std::string_view line : targetLines) {
+        size_t next = copyStart + copyCount;
+        if (copyCount > 0 && next < baseLines.size() && baseLines[next] == line) {
+            ++copyCount;
+            continue;
+        }
+        auto match = firstOccurrence.find(line);
+        if (match != firstOccurrence.end() && line.size() > 8) {
+            flushLiteral();
+            emitCopy(delta, copyStart, copyCount);
+            copyStart = match->second;
+            copyCount = 1;
+            continue;
+        }
+        emitCopy(delta, copyStart, copyCount);
+        copyCount = 0;
+        if (literalStart == nullptr) literalStart = line.data();
+        literalLength += line.size();
+    }
+    flushLiteral();
+    emitCopy(delta, copyStart, copyCount);
+    return delta;
+}
+bool LineDelta::apply(std::string_view base, std::string_view delta, std::string& output) {
+    std::vector<std::string_view> baseLines = splitLines(base);
+    output.clear();
+    while (!delta.empty()) {
+        char op = delta.front();
+        if (delta.size() < 2 || delta[1] != ' ') return false;
+        delta.remove_prefix(2);
+        if (op == 'C') {
+            size_t start = 0, count = 0;
+            if (!readNumber(delta, start) || delta.empty() || delta.front() != ' ') return false;
+            delta.remove_prefix(1);
+            if (!readNumber(delta, count) || delta.empty() || delta.front() != '\n') return false;
+            delta.remove_prefix(1);
+            if (start + count > baseLines.size()) return false;
+            for (size_t i = start; i < start + count; ++i) output += baseLines[i];
+        } else if (op == 'I') {
+            size_t length = 0;
+            if (!readNumber(delta, length) || delta.empty() || delta.front() != '\n') return false;
+            delta.remove_prefix(1);
+            if (length > delta.size()) return false;
+            output += delta.substr(0, length);
+            delta.remove_prefix(length);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
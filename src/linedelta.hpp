@@ -0,0 +1,9 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+class LineDelta {
+public:
+    static std::string encode(std::string_view base, std::string_view target);
+    static bool apply(std::string_view base, std::string_view delta, std::string& output);
+};
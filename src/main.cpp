@@ -1,15 +1,31 @@
 #include <QApplication>
+#include "cli.hpp"
 #include "mainwindow.hpp"
+#include "startuptrace.hpp"
+#include "trace.hpp"
 #include <iostream>
 
-int main(int argc, char* argv[]) {
+static int run(int argc, char* argv[]) {
+    if (Cli::isCliInvocation(argc, argv)) return Cli::run(std::vector<std::string>(argv + 1, argv + argc), std::cout, std::cerr);
     QApplication app(argc, argv);
+    StartupTrace::instance().mark("qapplication");
     try {
         MainWindow window;
+        StartupTrace::instance().mark("window-constructed");
         window.show();
+        StartupTrace::instance().mark("shown");
         return app.exec();
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << '\n';
         return 1;
     }
 }
+
+// `--trace FILE` works for the GUI and the CLI alike: the spans recorded during the run are written on exit.
+int main(int argc, char* argv[]) {
+    const std::string tracePath = Trace::consumeFlag(argc, argv);
+    if (StartupTrace::consumeFlag(argc, argv)) StartupTrace::instance().start();
+    int status = run(argc, argv);
+    if (!tracePath.empty() && !Trace::instance().writeChromeTrace(tracePath)) std::cerr << "Cannot write trace: " << tracePath << '\n';
+    return status;
+}
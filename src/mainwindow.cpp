@@ -12,10 +12,40 @@
 #include <QIcon>
 #include <QPixmap>
 #include <QPainter>
+#include <QDateTime>
 #include <QDialog>
+#include <QDialogButtonBox>
+#include <QPlainTextEdit>
 #include <QFont>
+#include <QFontDatabase>
+#include <QFileDialog>
+#include <QLocale>
 #include <QGraphicsOpacityEffect>
 #include <QPropertyAnimation>
+#include <QProgressBar>
+#include <QTableView>
+#include <QHeaderView>
+#include <QComboBox>
+#include <QFutureWatcher>
+#include <QPromise>
+#include <QtConcurrent/QtConcurrentRun>
+#include <filesystem>
+#include <set>
+#include <tuple>
+#include <utility>
+#include "aliasscanner.hpp"
+#include "aliasfiltermodel.hpp"
+#include "configwatcher.hpp"
+#include "fishfunctions.hpp"
+#include "pathindex.hpp"
+#include "syntaxchecker.hpp"
+#include "aliastablemodel.hpp"
+#include "startuptrace.hpp"
+#include "trace.hpp"
+#include <iostream>
+
+static constexpr size_t LOAD_BATCH_SIZE = 2000;
+static constexpr int SEARCH_DEBOUNCE_MS = 120;
 
 MainWindow::MainWindow(QWidget* parent)
 : QMainWindow(parent), isDarkTheme(false) {
@@ -24,21 +54,70 @@ MainWindow::MainWindow(QWidget* parent)
     setGeometry(100, 100, 1000, 750);
     setMinimumSize(900, 650);
 
-    initializeShellDetection();
+    ioPool.setMaxThreadCount(1);
+    // Shell detection and creating the backup directory run on the I/O thread while the widgets are built.
+    QFuture<StartupInfo> startup = QtConcurrent::run(&ioPool, []() {
+        StartupInfo info;
+        info.shell = ShellDetector::detectShellCached();
+        info.configFilePath = ShellDetector::getConfigFilePath(info.shell);
+        BackupManager backups(info.configFilePath);
+        info.backupDirectory = backups.getBackupDirectory();
+        info.manifestPath = backups.getManifestPath();
+        return info;
+    });
+    configWatcher = new ConfigWatcher(this);
+    // Styling an application that has no widgets yet is free; done afterwards it re-polishes every one of them.
+    applyStylesheet();
     initializeUI();
     setupConnections();
-    loadAliasesFromFile();
-    updateShellInfo();
-    applyStylesheet();
+    markStartup("ui-built");
+    initializeShellDetection(std::move(startup));
 }
 
-MainWindow::~MainWindow() = default;
+MainWindow::~MainWindow() {
+    loadFuture.cancel();
+    ioPool.waitForDone();
+}
 
-void MainWindow::initializeShellDetection() {
-    currentShell = ShellDetector::detectShell();
-    configFilePath = ShellDetector::getConfigFilePath(currentShell);
-    configHandler = std::make_unique<ConfigFileHandler>(configFilePath, currentShell);
-    backupManager = std::make_unique<BackupManager>(configFilePath);
+void MainWindow::initializeShellDetection(QFuture<StartupInfo> startup) {
+    setWriteInFlight(true, "Detecting shell...");
+    shellInfoLabel->setText("🖥️  Detecting shell...");
+    auto* watcher = new QFutureWatcher<StartupInfo>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        StartupInfo info = watcher->result();
+        watcher->deleteLater();
+        markStartup("shell-detected");
+        currentShell = info.shell;
+        configFilePath = info.configFilePath;
+        configHandler = std::make_unique<ConfigFileHandler>(configFilePath, currentShell);
+        backupManager = std::make_unique<BackupManager>(configFilePath, info.backupDirectory);
+        historyUsage = std::make_shared<HistoryUsage>(currentShell);
+        watchSources({configFilePath});
+        configWatcher->watchBackups(info.backupDirectory, info.manifestPath);
+        updateShellInfo();
+        setWriteInFlight(false);
+        loadAliasesFromFile();
+        // Built off the GUI thread so neither the first command check nor the first bulk check has to wait.
+        QtConcurrent::run([shell = currentShell]() {
+            PathIndex::shared().refresh();
+            SyntaxChecker::forShell(shell).warmUp();
+        });
+    });
+    watcher->setFuture(startup);
+}
+
+void MainWindow::paintEvent(QPaintEvent* event) {
+    QMainWindow::paintEvent(event);
+    markStartup(StartupTrace::FIRST_PAINT);
+}
+
+// With --startup-trace the run ends as soon as the window has painted and loaded; the exit status says whether
+// both happened within budget.
+void MainWindow::markStartup(std::string_view phase) {
+    StartupTrace& trace = StartupTrace::instance();
+    if (!trace.isEnabled() || trace.complete()) return;
+    trace.mark(phase);
+    if (trace.complete()) QCoreApplication::exit(trace.report(std::cerr) ? 0 : 1);
 }
 
 void MainWindow::initializeUI() {
@@ -55,6 +134,13 @@ void MainWindow::initializeUI() {
     headerLayout->addWidget(shellInfoLabel);
     headerLayout->addStretch();
 
+    diagnosticsButton = new QPushButton("📊", this);
+    diagnosticsButton->setMaximumSize(40, 40);
+    diagnosticsButton->setCursor(Qt::PointingHandCursor);
+    diagnosticsButton->setToolTip("Diagnostics");
+    diagnosticsButton->setStyleSheet("QPushButton { border-radius: 20px; font-size: 18px; border: none; }");
+    headerLayout->addWidget(diagnosticsButton);
+
     themeToggle = new QPushButton("🌙", this);
     themeToggle->setMaximumSize(40, 40);
     themeToggle->setCursor(Qt::PointingHandCursor);
@@ -108,30 +194,66 @@ void MainWindow::initializeUI() {
     auto* searchLabel = new QLabel("🔍 Search Aliases", this);
     searchLabel->setStyleSheet("font-weight: 600; font-size: 12px; letter-spacing: 0.3px;");
     searchLayout->addWidget(searchLabel);
+    auto* searchRow = new QHBoxLayout();
+    searchRow->setSpacing(8);
     searchInput = new QLineEdit(this);
     searchInput->setPlaceholderText("Type alias name or command to filter...");
     searchInput->setMaximumHeight(38);
     searchInput->setCursor(Qt::IBeamCursor);
-    searchLayout->addWidget(searchInput);
+    searchMode = new QComboBox(this);
+    searchMode->addItems({"All", "Name", "Command"});
+    searchMode->setMinimumHeight(34);
+    searchMode->setCursor(Qt::PointingHandCursor);
+    searchTimer = new QTimer(this);
+    searchTimer->setSingleShot(true);
+    searchTimer->setInterval(SEARCH_DEBOUNCE_MS);
+    searchRow->addWidget(searchInput);
+    searchRow->addWidget(searchMode);
+    searchLayout->addLayout(searchRow);
     mainLayout->addLayout(searchLayout);
 
     auto* listGroup = new QGroupBox("📋 Current Aliases", this);
     listGroup->setCursor(Qt::ArrowCursor);
     auto* listLayout = new QVBoxLayout(listGroup);
     listLayout->setSpacing(12);
-    aliasList = new QListWidget(this);
-    aliasList->setMinimumHeight(280);
-    aliasList->setCursor(Qt::PointingHandCursor);
-    listLayout->addWidget(aliasList);
+    aliasModel = new AliasTableModel(this);
+    aliasFilter = new AliasFilterModel(this);
+    aliasFilter->setSourceModel(aliasModel);
+    aliasView = new QTableView(this);
+    aliasView->setModel(aliasFilter);
+    aliasView->setMinimumHeight(280);
+    aliasView->setCursor(Qt::PointingHandCursor);
+    aliasView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    aliasView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    aliasView->setShowGrid(false);
+    aliasView->setWordWrap(false);
+    aliasView->setTextElideMode(Qt::ElideRight);
+    aliasView->verticalHeader()->hide();
+    aliasView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    aliasView->verticalHeader()->setDefaultSectionSize(aliasView->fontMetrics().height() + 14);
+    aliasView->horizontalHeader()->setSectionResizeMode(AliasTableModel::NAME, QHeaderView::Interactive);
+    aliasView->horizontalHeader()->setSectionResizeMode(AliasTableModel::COMMAND, QHeaderView::Stretch);
+    aliasView->horizontalHeader()->setSectionResizeMode(AliasTableModel::USES, QHeaderView::ResizeToContents);
+    aliasView->horizontalHeader()->setSectionResizeMode(AliasTableModel::LAST_USED, QHeaderView::ResizeToContents);
+    aliasView->horizontalHeader()->setSectionResizeMode(AliasTableModel::CHECK, QHeaderView::ResizeToContents);
+    aliasView->setColumnWidth(AliasTableModel::NAME, 200);
+    listLayout->addWidget(aliasView);
 
     auto* listButtonLayout = new QHBoxLayout();
     listButtonLayout->setSpacing(10);
     removeButton = new QPushButton("❌ Remove", this);
     removeButton->setMinimumHeight(34);
     removeButton->setCursor(Qt::PointingHandCursor);
+    bulkEditButton = new QPushButton("📝 Bulk Edit", this);
+    bulkEditButton->setMinimumHeight(34);
+    bulkEditButton->setCursor(Qt::PointingHandCursor);
     refreshButton = new QPushButton("🔄 Refresh", this);
     refreshButton->setMinimumHeight(34);
     refreshButton->setCursor(Qt::PointingHandCursor);
+    suggestButton = new QPushButton("💡 Suggest", this);
+    suggestButton->setMinimumHeight(34);
+    suggestButton->setCursor(Qt::PointingHandCursor);
+    suggestButton->setToolTip("Propose aliases for long commands you type often");
     backupButton = new QPushButton("💾 View Backups", this);
     backupButton->setMinimumHeight(34);
     backupButton->setCursor(Qt::PointingHandCursor);
@@ -139,37 +261,207 @@ void MainWindow::initializeUI() {
     restoreButton->setMinimumHeight(34);
     restoreButton->setCursor(Qt::PointingHandCursor);
     listButtonLayout->addWidget(removeButton);
+    listButtonLayout->addWidget(bulkEditButton);
     listButtonLayout->addWidget(refreshButton);
+    listButtonLayout->addWidget(suggestButton);
     listButtonLayout->addStretch();
     listButtonLayout->addWidget(backupButton);
     listButtonLayout->addWidget(restoreButton);
     listLayout->addLayout(listButtonLayout);
     mainLayout->addWidget(listGroup);
 
+    auto* statusLayout = new QHBoxLayout();
     statusLabel = new QLabel(this);
     statusLabel->setStyleSheet("font-size: 12px; font-weight: 500;");
-    mainLayout->addWidget(statusLabel);
+    progressBar = new QProgressBar(this);
+    progressBar->setMaximumWidth(220);
+    progressBar->setMaximumHeight(14);
+    progressBar->setTextVisible(false);
+    progressBar->hide();
+    cancelButton = new QPushButton("✖ Cancel", this);
+    cancelButton->setMinimumHeight(26);
+    cancelButton->setCursor(Qt::PointingHandCursor);
+    cancelButton->hide();
+    statusLayout->addWidget(statusLabel);
+    statusLayout->addStretch();
+    statusLayout->addWidget(progressBar);
+    statusLayout->addWidget(cancelButton);
+    mainLayout->addLayout(statusLayout);
 }
 
 void MainWindow::setupConnections() {
     connect(addButton, &QPushButton::clicked, this, &MainWindow::onAddAlias);
     connect(removeButton, &QPushButton::clicked, this, &MainWindow::onRemoveAlias);
+    connect(bulkEditButton, &QPushButton::clicked, this, &MainWindow::onBulkEdit);
     connect(refreshButton, &QPushButton::clicked, this, &MainWindow::onRefresh);
+    connect(suggestButton, &QPushButton::clicked, this, &MainWindow::onSuggestAliases);
     connect(backupButton, &QPushButton::clicked, this, &MainWindow::onShowBackups);
     connect(restoreButton, &QPushButton::clicked, this, &MainWindow::onRestoreBackup);
-    connect(aliasList, &QListWidget::itemSelectionChanged, this, &MainWindow::onAliasSelected);
+    connect(aliasView->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &MainWindow::onAliasSelected);
     connect(aliasNameInput, &QLineEdit::textChanged, this, &MainWindow::onNameChanged);
     connect(commandInput, &QLineEdit::textChanged, this, &MainWindow::onCommandChanged);
     connect(themeToggle, &QPushButton::clicked, this, &MainWindow::toggleTheme);
+    connect(diagnosticsButton, &QPushButton::clicked, this, &MainWindow::onShowDiagnostics);
     connect(searchInput, &QLineEdit::textChanged, this, &MainWindow::onSearchTextChanged);
+    connect(searchMode, &QComboBox::currentIndexChanged, this, [this]() { filterAliasList(); });
+    connect(searchTimer, &QTimer::timeout, this, &MainWindow::filterAliasList);
+    connect(aliasModel, &QAbstractItemModel::modelReset, this, &MainWindow::onAliasesChanged);
+    connect(aliasModel, &QAbstractItemModel::rowsInserted, this, &MainWindow::onAliasesChanged);
+    connect(aliasModel, &QAbstractItemModel::rowsRemoved, this, &MainWindow::onAliasesChanged);
+    connect(aliasModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex& topLeft) {
+        if (topLeft.column() == AliasTableModel::NAME || topLeft.column() == AliasTableModel::COMMAND) onAliasesChanged();
+    });
+    connect(cancelButton, &QPushButton::clicked, this, &MainWindow::onCancelLoad);
+    connect(configWatcher, &ConfigWatcher::configChanged, this, &MainWindow::onConfigChangedExternally);
+    connect(configWatcher, &ConfigWatcher::backupsChanged, this, &MainWindow::onBackupsChanged);
 }
 
 void MainWindow::loadAliasesFromFile() {
-    try {
-        currentAliases = configHandler->loadAliases();
-        updateAliasList();
-    } catch (const std::exception& e) {
-        showError("Error", QString("Failed to load aliases: ") + e.what());
+    if (!configHandler) return;
+    loadFuture.cancel();
+    configWatcher->markCurrent();
+    const int generation = ++loadGeneration;
+    incrementalLoad = aliasModel->rowCount() > 0;
+    loadFailed = false;
+    stagedAliases.clear();
+    progressBar->setRange(0, 0);
+    progressBar->show();
+    cancelButton->show();
+
+    auto* watcher = new QFutureWatcher<AliasBatch>(this);
+    connect(watcher, &QFutureWatcherBase::resultsReadyAt, this, [this, watcher, generation](int begin, int end) {
+        if (generation != loadGeneration) return;
+        for (int i = begin; i < end; ++i) appendAliasBatch(watcher->resultAt(i));
+    });
+    connect(watcher, &QFutureWatcherBase::progressRangeChanged, this, [this, generation](int minimum, int maximum) {
+        if (generation == loadGeneration) progressBar->setRange(minimum, maximum);
+    });
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, this, [this, generation](int value) {
+        if (generation == loadGeneration) progressBar->setValue(value);
+    });
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation != loadGeneration) return;
+        bool canceled = watcher->isCanceled();
+        loadFuture = QFuture<AliasBatch>();
+        cancelButton->hide();
+        if (!writeInFlight) progressBar->hide();
+        if (!canceled && incrementalLoad && !loadFailed) aliasModel->applyStore(stagedAliases);
+        if (!canceled) markStartup(StartupTrace::INTERACTIVE);
+        if (!canceled && !loadFailed) {
+            checkAliasTargets();
+            updateAliasUsage();
+        }
+        stagedAliases.clear();
+        if (canceled) statusLabel->setText(QString("Loading cancelled (%1 aliases shown)").arg(aliasModel->rowCount()));
+        else if (!pendingSuccess.isEmpty()) showSuccess(std::exchange(pendingSuccess, QString()));
+        else statusLabel->setText(QString("Total aliases: %1").arg(aliasModel->rowCount()));
+    });
+
+    ConfigFileHandler* handler = configHandler.get();
+    loadFuture = QtConcurrent::run(&ioPool, [handler](QPromise<AliasBatch>& promise) {
+        AliasBatch batch;
+        AliasStore store;
+        try {
+            store = handler->loadAliases();
+        } catch (const std::exception& e) {
+            batch.error = e.what();
+            promise.addResult(std::move(batch));
+            return;
+        }
+        batch.total = store.size();
+        batch.sources = store.origins();
+        promise.setProgressRange(0, static_cast<int>(store.size()));
+        size_t done = 0;
+        for (const auto& alias : store) {
+            if (promise.isCanceled()) return;
+            batch.aliases.push_back(alias.materialize());
+            batch.lines.push_back(alias.line);
+            batch.origins.emplace_back(alias.origin);
+            if (batch.aliases.size() < LOAD_BATCH_SIZE) continue;
+            done += batch.aliases.size();
+            promise.addResult(std::exchange(batch, AliasBatch{{}, {}, {}, {}, store.size(), ""}));
+            promise.setProgressValue(static_cast<int>(done));
+        }
+        promise.addResult(std::move(batch));
+        promise.setProgressValue(static_cast<int>(store.size()));
+    });
+    watcher->setFuture(loadFuture);
+}
+
+void MainWindow::appendAliasBatch(const AliasBatch& batch) {
+    TRACE_SCOPE(span, "MainWindow::appendAliasBatch");
+    TRACE_ARG(span, "aliases", batch.aliases.size());
+    if (!batch.error.empty()) {
+        loadFailed = true;
+        showError("Error", QString::fromStdString("Failed to load aliases: " + batch.error));
+        return;
+    }
+    // The first batch lists every file the config sources, so edits to any of them reload the view.
+    if (!batch.sources.empty()) watchSources(batch.sources);
+    if (incrementalLoad) {
+        for (size_t i = 0; i < batch.aliases.size(); ++i) stagedAliases.insert(batch.aliases[i].name, batch.aliases[i].command, batch.lines[i], stagedAliases.addOrigin(batch.origins[i]));
+    } else {
+        aliasModel->append(batch.aliases, batch.lines, batch.origins);
+    }
+    size_t loaded = incrementalLoad ? stagedAliases.size() : aliasModel->aliases().size();
+    statusLabel->setText(QString("Loading aliases... %1 of %2").arg(loaded).arg(batch.total));
+}
+
+void MainWindow::watchSources(std::vector<std::string> files) {
+    if (currentShell == ShellDetector::Shell::FISH) files.push_back(FishFunctions::directoryFor(configFilePath));
+    configWatcher->watchConfig(files);
+}
+
+void MainWindow::onCancelLoad() { loadFuture.cancel(); }
+
+void MainWindow::onConfigChangedExternally() {
+    TRACE_SCOPE(span, "MainWindow::onConfigChangedExternally");
+    // A write in flight reloads the file when it finishes, which picks up the external edit as well.
+    if (writeInFlight || !configHandler) return;
+    pendingSuccess = "🔄 Reloaded changes made outside AliaCan";
+    loadAliasesFromFile();
+}
+
+void MainWindow::onBackupsChanged() {
+    TRACE_SCOPE(span, "MainWindow::onBackupsChanged");
+    if (!backupList || !backupManager) return;
+    BackupManager* manager = backupManager.get();
+    auto* watcher = new QFutureWatcher<std::vector<BackupManager::Snapshot>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        if (backupList) populateBackupList(backupList, watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run(&ioPool, [manager]() { return manager->listSnapshots(); }));
+}
+
+void MainWindow::runWrite(const QString& busyMessage, std::function<std::string()> job, const QString& successMessage, std::function<void()> onSuccess) {
+    setWriteInFlight(true, busyMessage);
+    auto* watcher = new QFutureWatcher<std::string>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, successMessage, onSuccess]() {
+        std::string error = watcher->result();
+        watcher->deleteLater();
+        setWriteInFlight(false);
+        if (!error.empty()) {
+            showError("Error", QString::fromStdString(error));
+            return;
+        }
+        if (onSuccess) onSuccess();
+        pendingSuccess = successMessage;
+        loadAliasesFromFile();
+    });
+    watcher->setFuture(QtConcurrent::run(&ioPool, std::move(job)));
+}
+
+void MainWindow::setWriteInFlight(bool busy, const QString& message) {
+    writeInFlight = busy;
+    for (QPushButton* button : {addButton, removeButton, bulkEditButton, refreshButton, backupButton, restoreButton}) button->setEnabled(!busy);
+    if (busy) {
+        progressBar->setRange(0, 0);
+        progressBar->show();
+        statusLabel->setText(message);
+    } else if (!loadFuture.isRunning()) {
+        progressBar->hide();
     }
 }
 
@@ -178,24 +470,62 @@ void MainWindow::updateShellInfo() {
     shellInfoLabel->setText(QString::fromStdString("🖥️  Detected: " + shellName + " | Config: " + configFilePath));
 }
 
-void MainWindow::updateAliasList() {
-    aliasList->clear();
-    for (const auto& alias : currentAliases) {
-        aliasList->addItem(QString::fromStdString(alias.name + " = " + alias.command));
+void MainWindow::filterAliasList() {
+    TRACE_SCOPE(span, "MainWindow::filterAliasList");
+    searchTimer->stop();
+    const int generation = ++searchGeneration;
+    const std::string query = searchInput->text().toStdString();
+    if (query.empty()) {
+        lastSearch.reset();
+        aliasFilter->clearMatches();
+        return;
     }
-    statusLabel->setText(QString("Total aliases: %1").arg(currentAliases.size()));
-}
+    // The index is rebuilt on the worker from a snapshot whenever the aliases changed since it was built;
+    // otherwise the previous result is passed along so a longer query only rescans its matches.
+    const int revision = aliasRevision;
+    const auto mode = static_cast<AliasSearch::Mode>(searchMode->currentIndex());
+    std::shared_ptr<const AliasSearch> index = searchIndexRevision == revision ? searchIndex : nullptr;
+    std::shared_ptr<const AliasSearch::Result> previous = index ? lastSearch : nullptr;
+    std::shared_ptr<const AliasStore> snapshot = index ? nullptr : std::make_shared<const AliasStore>(aliasModel->aliases());
+    std::vector<size_t> rowIds = index ? std::vector<size_t>() : aliasModel->rowIds();
 
-void MainWindow::filterAliasList(const QString& searchText) {
-    for (int i = 0; i < aliasList->count(); ++i) {
-        QListWidgetItem* item = aliasList->item(i);
-        item->setHidden(!item->text().contains(searchText, Qt::CaseInsensitive));
-    }
+    auto* watcher = new QFutureWatcher<SearchOutcome>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation, revision]() {
+        watcher->deleteLater();
+        if (generation != searchGeneration) return;
+        if (revision != aliasRevision) {
+            filterAliasList();
+            return;
+        }
+        SearchOutcome outcome = watcher->result();
+        searchIndex = std::move(outcome.index);
+        searchIndexRevision = revision;
+        lastSearch = std::move(outcome.result);
+        aliasFilter->setMatches(lastSearch->matches);
+    });
+    watcher->setFuture(QtConcurrent::run([index, previous, snapshot, rowIds = std::move(rowIds), query, mode]() {
+        TRACE_SCOPE(span, "AliasSearch::search");
+        std::shared_ptr<const AliasSearch> active = index;
+        if (!active) {
+            auto built = std::make_shared<AliasSearch>();
+            built->build(*snapshot, rowIds);
+            active = std::move(built);
+        }
+        auto result = std::make_shared<const AliasSearch::Result>(active->search(query, mode, previous.get()));
+        TRACE_ARG(span, "matches", result->matches.size());
+        return SearchOutcome{std::move(active), std::move(result)};
+    }));
 }
 
-void MainWindow::onSearchTextChanged(const QString& text) { filterAliasList(text); }
+void MainWindow::onSearchTextChanged(const QString&) { searchTimer->start(); }
+
+void MainWindow::onAliasesChanged() {
+    ++aliasRevision;
+    if (aliasFilter->isFiltering()) searchTimer->start();
+}
 
 void MainWindow::toggleTheme() {
+    TRACE_SCOPE(span, "MainWindow::toggleTheme");
     isDarkTheme = !isDarkTheme;
     themeToggle->setText(isDarkTheme ? "☀️" : "🌙");
     applyStylesheet();
@@ -210,91 +540,327 @@ void MainWindow::toggleTheme() {
 }
 
 void MainWindow::onAddAlias() {
+    TRACE_SCOPE(span, "MainWindow::onAddAlias");
     QString aliasName = aliasNameInput->text().trimmed();
     QString command = commandInput->text().trimmed();
 
     if (!validateInput(aliasName, command)) return;
 
-    std::string backupPath = backupManager->createBackup();
-    if (backupPath.empty()) {
-        showError("Backup Error", "Failed to create backup. Operation cancelled.");
-        return;
-    }
-
     Alias newAlias{aliasName.toStdString(), command.toStdString()};
-    if (!configHandler->addAlias(newAlias)) {
-        showError("Error", QString::fromStdString("Failed to add alias: " + configHandler->getLastError()));
-        return;
-    }
-
-    showSuccess("✨ Alias added successfully!");
-    clearInputFields();
-    loadAliasesFromFile();
+    ConfigFileHandler* handler = configHandler.get();
+    BackupManager* backups = backupManager.get();
+    SyntaxChecker* checker = &SyntaxChecker::forShell(currentShell);
+    const std::string shellName = ShellDetector::getShellName(currentShell);
+    // The shell's verdict may have to wait for a coprocess to spawn or for a bulk check to release one, so it is
+    // asked for on ioPool along with the write rather than here.
+    runWrite("Saving alias...", [handler, backups, checker, shellName, newAlias]() -> std::string {
+        SyntaxChecker::Result syntax = checker->check(newAlias, SyntaxChecker::BULK_TIMEOUT);
+        if (syntax.verdict == SyntaxChecker::Verdict::INVALID) return shellName + " can't parse this command: " + syntax.message;
+        if (handler->beginTransaction(backups) && handler->stageAdd(newAlias) && handler->commitTransaction()) return "";
+        handler->rollbackTransaction();
+        return "Failed to add alias: " + handler->getLastError();
+    }, "✨ Alias added successfully!", [this]() { clearInputFields(); });
 }
 
 void MainWindow::onRemoveAlias() {
-    QListWidgetItem* currentItem = aliasList->currentItem();
-    if (!currentItem) {
+    QStringList names = selectedAliasNames();
+    if (names.isEmpty()) {
         showError("Error", "Please select an alias to remove.");
         return;
     }
 
-    QString aliasName = currentItem->text().split(" = ")[0].trimmed();
-    if (QMessageBox::question(this, "Confirm Deletion", QString("Remove alias '%1'?").arg(aliasName), QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) return;
+    QString prompt = names.size() == 1 ? QString("Remove alias '%1'?").arg(names.front()) : QString("Remove %1 selected aliases?").arg(names.size());
+    if (QMessageBox::question(this, "Confirm Deletion", prompt, QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) return;
+    TRACE_SCOPE(span, "MainWindow::onRemoveAlias");
 
-    std::string backupPath = backupManager->createBackup();
-    if (backupPath.empty()) {
-        showError("Backup Error", "Failed to create backup. Operation cancelled.");
-        return;
+    std::vector<std::string> removals;
+    for (const QString& name : names) removals.push_back(name.toStdString());
+    ConfigFileHandler* handler = configHandler.get();
+    BackupManager* backups = backupManager.get();
+    runWrite("Removing aliases...", [handler, backups, removals]() -> std::string {
+        bool staged = handler->beginTransaction(backups);
+        for (const auto& name : removals) {
+            if (!staged) break;
+            staged = handler->stageRemove(name);
+        }
+        if (staged && handler->commitTransaction()) return "";
+        handler->rollbackTransaction();
+        return "Failed to remove alias: " + handler->getLastError();
+    }, names.size() == 1 ? "❌ Alias removed successfully!" : QString("❌ %1 aliases removed successfully!").arg(names.size()));
+}
+
+void MainWindow::onBulkEdit() {
+    QStringList names = selectedAliasNames();
+    AliasManager formatter(currentShell);
+    QString text;
+    for (const QString& name : names) {
+        if (size_t id = aliasModel->aliases().find(name.toStdString()); id != AliasStore::npos) {
+            text += QString::fromStdString(formatter.formatAlias(aliasModel->aliases().at(id).materialize())) + "\n";
+        }
     }
 
-    if (!configHandler->removeAlias(aliasName.toStdString())) {
-        showError("Error", QString::fromStdString("Failed to remove alias: " + configHandler->getLastError()));
-        return;
+    QDialog dialog(this);
+    dialog.setWindowTitle("Bulk Edit Aliases");
+    dialog.resize(650, 450);
+    auto* layout = new QVBoxLayout(&dialog);
+    layout->setSpacing(12);
+    layout->setContentsMargins(20, 20, 20, 20);
+    auto* hintLabel = new QLabel(names.isEmpty()
+        ? "Paste alias definitions to add, one per line."
+        : "Edit the selected aliases. Deleted lines remove the alias; new lines add one.", &dialog);
+    hintLabel->setStyleSheet("font-size: 11px; font-style: italic;");
+    layout->addWidget(hintLabel);
+    auto* editor = new QPlainTextEdit(text, &dialog);
+    editor->setLineWrapMode(QPlainTextEdit::NoWrap);
+    layout->addWidget(editor);
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted) return;
+    TRACE_SCOPE(span, "MainWindow::onBulkEdit");
+
+    std::string edited = editor->toPlainText().toStdString();
+    std::vector<Alias> parsed = AliasScanner::scanAll(edited, currentShell);
+    std::set<std::string> kept;
+    std::vector<Alias> additions;
+    std::vector<std::string> removals;
+    for (const auto& alias : parsed) {
+        kept.insert(alias.name);
+        if (size_t id = aliasModel->aliases().find(alias.name); id != AliasStore::npos && aliasModel->aliases().command(id) == alias.command) continue;
+        additions.push_back(alias);
+    }
+    for (const QString& name : names) {
+        if (!kept.contains(name.toStdString())) removals.push_back(name.toStdString());
     }
 
-    showSuccess("❌ Alias removed successfully!");
-    loadAliasesFromFile();
+    ConfigFileHandler* handler = configHandler.get();
+    BackupManager* backups = backupManager.get();
+    SyntaxChecker* checker = &SyntaxChecker::forShell(currentShell);
+    runWrite("Applying bulk edit...", [handler, backups, checker, additions, removals]() -> std::string {
+        std::vector<SyntaxChecker::Result> syntax = checker->checkAll(additions);
+        for (size_t i = 0; i < syntax.size(); ++i) {
+            if (syntax[i].verdict == SyntaxChecker::Verdict::INVALID) return "Bulk edit rejected, " + additions[i].name + ": " + syntax[i].message;
+        }
+        bool staged = handler->beginTransaction(backups);
+        for (const auto& alias : additions) {
+            if (!staged) break;
+            staged = handler->stageAdd(alias);
+        }
+        for (const auto& name : removals) {
+            if (!staged) break;
+            staged = handler->stageRemove(name);
+        }
+        if (staged && handler->commitTransaction()) return "";
+        handler->rollbackTransaction();
+        return "Bulk edit failed: " + handler->getLastError();
+    }, QString("📝 Bulk edit applied (%1 aliases)").arg(parsed.size()));
+}
+
+QStringList MainWindow::selectedAliasNames() const {
+    QStringList names;
+    for (const QModelIndex& index : aliasView->selectionModel()->selectedRows(AliasTableModel::NAME)) names << index.data(Qt::UserRole).toString();
+    return names;
 }
 
 void MainWindow::onRefresh() {
+    TRACE_SCOPE(span, "MainWindow::onRefresh");
+    pendingSuccess = "🔄 Alias list refreshed!";
     loadAliasesFromFile();
-    showSuccess("🔄 Alias list refreshed!");
 }
 
-void MainWindow::onAliasSelected() {
-    QListWidgetItem* currentItem = aliasList->currentItem();
-    if (!currentItem) return;
-
-    QStringList parts = currentItem->text().split(" = ");
-    if (parts.size() == 2) {
-        isModifying = true;
-        aliasNameInput->setText(parts[0].trimmed());
-        commandInput->setText(parts[1].trimmed());
-        isModifying = false;
+// Mining reads the whole history, which can take a second or two on years of it, so it runs on the global
+// pool against a snapshot of the aliases, like checkAliasTargets.
+void MainWindow::onSuggestAliases() {
+    TRACE_SCOPE(span, "MainWindow::onSuggestAliases");
+    const std::string historyPath = historyUsage ? historyUsage->getHistoryPath() : HistoryUsage::defaultHistoryPath(currentShell);
+    auto snapshot = std::make_shared<const AliasStore>(aliasModel->aliases());
+    const ShellDetector::Shell shell = currentShell;
+    suggestButton->setEnabled(false);
+    auto* watcher = new QFutureWatcher<std::pair<std::vector<SuggestionMiner::Suggestion>, std::string>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        auto [suggestions, error] = watcher->result();
+        watcher->deleteLater();
+        suggestButton->setEnabled(true);
+        if (!error.empty()) showError("Suggestion Error", QString::fromStdString(error));
+        else showSuggestionsDialog(suggestions);
+    });
+    watcher->setFuture(QtConcurrent::run([shell, historyPath, snapshot]() {
+        SuggestionMiner miner(shell);
+        std::vector<SuggestionMiner::Suggestion> suggestions;
+        if (!miner.mineFile(historyPath, *snapshot, PathIndex::shared(), suggestions)) return std::make_pair(suggestions, miner.getLastError());
+        return std::make_pair(suggestions, std::string());
+    }));
+}
+
+void MainWindow::showSuggestionsDialog(const std::vector<SuggestionMiner::Suggestion>& suggestions) {
+    if (suggestions.empty()) {
+        showSuccess("💡 No alias suggestions: nothing long is typed often enough");
+        return;
     }
+
+    auto* dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle("Suggested Aliases");
+    dialog->resize(650, 420);
+    dialog->setModal(true);
+
+    auto* layout = new QVBoxLayout(dialog);
+    layout->setSpacing(15);
+    layout->setContentsMargins(20, 20, 20, 20);
+
+    auto* titleLabel = new QLabel("💡 Suggested Aliases", dialog);
+    titleLabel->setStyleSheet("font-size: 14px; font-weight: 600;");
+    layout->addWidget(titleLabel);
+
+    auto* list = new QListWidget(dialog);
+    for (const auto& suggestion : suggestions) {
+        auto* item = new QListWidgetItem(list);
+        auto* row = new QWidget(list);
+        auto* rowLayout = new QHBoxLayout(row);
+        rowLayout->setContentsMargins(6, 4, 6, 4);
+        auto* text = new QLabel(QString("<b>%1</b> = %2  <i>(%3×)</i>")
+            .arg(QString::fromStdString(suggestion.name).toHtmlEscaped(), QString::fromStdString(suggestion.command).toHtmlEscaped())
+            .arg(suggestion.count), row);
+        text->setToolTip(QString::fromStdString(suggestion.command));
+        auto* accept = new QPushButton("✨ Add", row);
+        accept->setCursor(Qt::PointingHandCursor);
+        rowLayout->addWidget(text, 1);
+        rowLayout->addWidget(accept);
+        item->setSizeHint(row->sizeHint());
+        list->setItemWidget(item, row);
+
+        Alias alias{suggestion.name, suggestion.command};
+        connect(accept, &QPushButton::clicked, this, [this, accept, alias]() {
+            accept->setEnabled(false);
+            ConfigFileHandler* handler = configHandler.get();
+            BackupManager* backups = backupManager.get();
+            SyntaxChecker* checker = &SyntaxChecker::forShell(currentShell);
+            runWrite("Saving alias...", [handler, backups, checker, alias]() -> std::string {
+                SyntaxChecker::Result syntax = checker->check(alias);
+                if (syntax.verdict == SyntaxChecker::Verdict::INVALID) return "Suggestion rejected, " + alias.name + ": " + syntax.message;
+                if (handler->beginTransaction(backups) && handler->stageAdd(alias) && handler->commitTransaction()) return "";
+                handler->rollbackTransaction();
+                return "Failed to add alias: " + handler->getLastError();
+            }, QString("✨ Alias %1 added!").arg(QString::fromStdString(alias.name)), [button = QPointer<QPushButton>(accept)]() {
+                if (button) button->setText("✓ Added");
+            });
+        });
+    }
+    layout->addWidget(list);
+
+    auto* hintLabel = new QLabel("Commands are ranked by the characters an alias would save.", dialog);
+    hintLabel->setStyleSheet("font-size: 11px; font-style: italic;");
+    layout->addWidget(hintLabel);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close, dialog);
+    connect(buttons, &QDialogButtonBox::rejected, dialog, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    dialog->exec();
+}
+
+void MainWindow::onAliasSelected() {
+    TRACE_SCOPE(span, "MainWindow::onAliasSelected");
+    QModelIndex current = aliasFilter->mapToSource(aliasView->currentIndex());
+    if (!current.isValid()) return;
+
+    isModifying = true;
+    aliasNameInput->setText(aliasModel->index(current.row(), AliasTableModel::NAME).data().toString());
+    commandInput->setText(aliasModel->index(current.row(), AliasTableModel::COMMAND).data().toString());
+    isModifying = false;
 }
 
 void MainWindow::onNameChanged(const QString& text) {
+    TRACE_SCOPE(span, "MainWindow::onNameChanged");
     if (isModifying) return;
     addButton->setText(text.isEmpty() ? "✨ Add Alias" : "⚙️  Update Alias");
+    if (!commandInput->text().isEmpty()) updateCommandStatus();
 }
 
 void MainWindow::onCommandChanged(const QString& text) {
-    addButton->setEnabled(!aliasNameInput->text().isEmpty() && !text.isEmpty());
-    bool valid = AliasManager::validateCommand(text.toStdString());
-    commandStatus->setText(valid ? "✅ Valid command" : "❌ Invalid command");
-    commandStatus->setStyleSheet(QString("color: %1; font-size: 11px; font-weight: 500;").arg(valid ? "#51cf66" : "#ff6b6b"));
+    TRACE_SCOPE(span, "MainWindow::onCommandChanged");
+    addButton->setEnabled(!writeInFlight && !aliasNameInput->text().isEmpty() && !text.isEmpty());
+    updateCommandStatus();
+}
+
+// Length limits and what the shell refuses to parse make a command invalid; a command word that resolves to
+// nothing, or a name that hides an executable, only warns, since the alias may well call a shell function or a
+// tool that gets installed later. A syntax check that can't answer within a frame leaves the verdict to the rest.
+void MainWindow::updateCommandStatus() {
+    const std::string command = commandInput->text().toStdString();
+    const std::string name = aliasNameInput->text().trimmed().toStdString();
+    QString text = "❌ Invalid command";
+    QString color = "#ff6b6b";
+    const bool valid = AliasManager::validateCommand(command);
+    // The name field gets its own verdict; a half-typed name must not turn into a syntax error of the command.
+    SyntaxChecker::Result syntax;
+    if (valid) syntax = SyntaxChecker::forShell(currentShell).check(Alias{AliasManager::validateAliasName(name) ? name : "x", command});
+    if (syntax.verdict == SyntaxChecker::Verdict::INVALID) {
+        text = QString("❌ %1").arg(QString::fromStdString(syntax.message));
+    } else if (valid) {
+        PathIndex::Check check = PathIndex::shared().check(name, command, &aliasModel->aliases());
+        if (check.status == PathIndex::Status::SHADOWS) text = QString("⚠️ Hides %1").arg(QString::fromStdString(check.target));
+        else if (check.status == PathIndex::Status::MISSING) text = QString("⚠️ '%1' not found on $PATH").arg(QString::fromStdString(check.target));
+        else text = "✅ Valid command";
+        color = check.status == PathIndex::Status::OK ? "#51cf66" : "#f0a020";
+    }
+    commandStatus->setText(text);
+    commandStatus->setStyleSheet(QString("color: %1; font-size: 11px; font-weight: 500;").arg(color));
+}
+
+// Runs against a snapshot after every load; a result that arrives after the aliases changed again is dropped,
+// since the load that changed them schedules its own check.
+void MainWindow::checkAliasTargets() {
+    const int revision = aliasRevision;
+    auto snapshot = std::make_shared<const AliasStore>(aliasModel->aliases());
+    auto* watcher = new QFutureWatcher<std::vector<PathIndex::Check>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, revision]() {
+        watcher->deleteLater();
+        if (revision == aliasRevision) aliasModel->setChecks(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([snapshot]() { return PathIndex::shared().checkAll(*snapshot); }));
+}
+
+// Same snapshot scheme as checkAliasTargets. After the first load only history appended since the previous
+// update is read, so running this after every load stays cheap even for very large history files.
+void MainWindow::updateAliasUsage() {
+    if (!historyUsage) return;
+    const int revision = aliasRevision;
+    auto snapshot = std::make_shared<const AliasStore>(aliasModel->aliases());
+    auto* watcher = new QFutureWatcher<std::vector<HistoryUsage::Usage>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, revision]() {
+        watcher->deleteLater();
+        if (revision == aliasRevision) aliasModel->setUsage(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([history = historyUsage, snapshot]() {
+        history->update();
+        return history->forAliases(*snapshot);
+    }));
 }
 
 void MainWindow::onShowBackups() {
-    std::vector<std::string> backups = backupManager->listBackups();
+    TRACE_SCOPE(span, "MainWindow::onShowBackups");
+    BackupManager* manager = backupManager.get();
+    backupButton->setEnabled(false);
+    auto* watcher = new QFutureWatcher<std::vector<BackupManager::Snapshot>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        std::vector<BackupManager::Snapshot> backups = watcher->result();
+        watcher->deleteLater();
+        backupButton->setEnabled(!writeInFlight);
+        showBackupsDialog(backups);
+    });
+    watcher->setFuture(QtConcurrent::run(&ioPool, [manager]() { return manager->listSnapshots(); }));
+}
+
+void MainWindow::showBackupsDialog(const std::vector<BackupManager::Snapshot>& backups) {
     if (backups.empty()) {
         showError("No Backups", "No backup files found for this configuration.");
         return;
     }
 
     auto* backupDialog = new QDialog(this);
+    backupDialog->setAttribute(Qt::WA_DeleteOnClose);
     backupDialog->setWindowTitle("Available Backups");
     backupDialog->setGeometry(150, 150, 550, 450);
     backupDialog->setModal(true);
@@ -307,41 +873,119 @@ void MainWindow::onShowBackups() {
     titleLabel->setStyleSheet("font-size: 14px; font-weight: 600;");
     layout->addWidget(titleLabel);
 
-    auto* backupList = new QListWidget(backupDialog);
+    backupList = new QListWidget(backupDialog);
     backupList->setCursor(Qt::PointingHandCursor);
-    for (const auto& backup : backups) backupList->addItem(QString::fromStdString(backup));
+    populateBackupList(backupList, backups);
     layout->addWidget(backupList);
 
     auto* hintLabel = new QLabel("⬆️ Double-click to restore a backup", backupDialog);
     hintLabel->setStyleSheet("font-size: 11px; font-style: italic;");
     layout->addWidget(hintLabel);
 
-    connect(backupList, &QListWidget::itemDoubleClicked, [this, backupDialog, backupList]() {
-        if (!backupList->currentItem()) return;
-        std::string backup = backupList->currentItem()->text().toStdString();
-        if (backupManager->restoreFromBackup(backup)) {
-            showSuccess("⚡ Restored from backup!");
-            loadAliasesFromFile();
-            backupDialog->close();
-        } else showError("Error", QString::fromStdString("Failed to restore: " + backupManager->getLastError()));
+    connect(backupList, &QListWidget::itemDoubleClicked, [this, backupDialog]() {
+        if (!backupList || !backupList->currentItem()) return;
+        std::string backup = backupList->currentItem()->data(Qt::UserRole).toString().toStdString();
+        BackupManager* manager = backupManager.get();
+        runWrite("Restoring backup...", [manager, backup]() -> std::string {
+            return manager->restoreFromBackup(backup) ? "" : "Failed to restore: " + manager->getLastError();
+        }, "⚡ Restored from backup!");
+        backupDialog->close();
     });
 
         backupDialog->exec();
 }
 
-void MainWindow::onRestoreBackup() {
-    std::string lastBackup = backupManager->getLastBackupPath();
-    if (lastBackup.empty()) {
-        showError("Error", "No backup found to restore.");
-        return;
+void MainWindow::populateBackupList(QListWidget* list, const std::vector<BackupManager::Snapshot>& backups) {
+    QString current = list->currentItem() ? list->currentItem()->data(Qt::UserRole).toString() : QString();
+    list->clear();
+    for (const auto& backup : backups) {
+        QDateTime time = QDateTime::fromMSecsSinceEpoch(backup.timestamp / 1000000);
+        auto* item = new QListWidgetItem(QString("%1  ·  %2 bytes").arg(time.toString("yyyy-MM-dd HH:mm:ss.zzz")).arg(backup.size), list);
+        item->setData(Qt::UserRole, QString::fromStdString(backup.path));
+        item->setToolTip(QString::fromStdString(backup.path));
+        if (item->data(Qt::UserRole).toString() == current) list->setCurrentItem(item);
     }
+}
 
-    if (QMessageBox::question(this, "Confirm Restore", "Restore from most recent backup?", QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
-        if (backupManager->restoreFromLastBackup()) {
-            showSuccess("⚡ Restored from backup successfully!");
-            loadAliasesFromFile();
-        } else showError("Error", QString::fromStdString("Failed to restore: " + backupManager->getLastError()));
+// Sizes are gathered off the GUI thread, on the global pool rather than ioPool so a long load doesn't hold
+// the dialog back; everything else comes from the trace buffer and the model.
+void MainWindow::onShowDiagnostics() {
+    std::vector<std::string> files = aliasModel->aliases().origins();
+    if (files.empty() && !configFilePath.empty()) files.push_back(configFilePath);
+    BackupManager* manager = backupManager.get();
+    diagnosticsButton->setEnabled(false);
+    auto* watcher = new QFutureWatcher<DiagnosticsInfo>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        DiagnosticsInfo info = watcher->result();
+        watcher->deleteLater();
+        diagnosticsButton->setEnabled(true);
+        showDiagnosticsDialog(info);
+    });
+    watcher->setFuture(QtConcurrent::run([files, manager]() {
+        DiagnosticsInfo info;
+        for (const auto& file : files) {
+            std::error_code ec;
+            uint64_t size = std::filesystem::file_size(file, ec);
+            info.files.emplace_back(file, ec ? 0 : size);
+        }
+        if (manager != nullptr) {
+            info.backupDirectory = manager->getBackupDirectory();
+            info.backupBytes = manager->getBackupDirectorySize();
+            info.backupCount = manager->listSnapshots().size();
+        }
+        return info;
+    }));
+}
+
+void MainWindow::showDiagnosticsDialog(const DiagnosticsInfo& info) {
+    QLocale locale;
+    QString report = QString("Shell: %1\nAliases: %2\n\nConfig files\n").arg(QString::fromStdString(ShellDetector::getShellName(currentShell))).arg(aliasModel->rowCount());
+    for (const auto& [path, size] : info.files) report += QString("  %1  %2\n").arg(locale.formattedDataSize(static_cast<qint64>(size)), 10).arg(QString::fromStdString(path));
+    if (!info.backupDirectory.empty()) report += QString("\nBackups: %1 snapshots, %2 in %3\n").arg(info.backupCount).arg(locale.formattedDataSize(static_cast<qint64>(info.backupBytes))).arg(QString::fromStdString(info.backupDirectory));
+    report += QString("\nRecent operations\n%1 %2 %3 %4 %5\n").arg(QString("operation"), -48).arg(QString("count"), 6).arg(QString("last ms"), 10).arg(QString("mean ms"), 10).arg(QString("max ms"), 10);
+    for (const auto& summary : Trace::instance().summarize()) {
+        report += QString("%1 %2 %3 %4 %5\n").arg(QString::fromStdString(summary.name), -48).arg(summary.count, 6).arg(summary.lastMs, 10, 'f', 2).arg(summary.meanMs, 10, 'f', 2).arg(summary.maxMs, 10, 'f', 2);
     }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Diagnostics");
+    dialog.resize(760, 520);
+    auto* layout = new QVBoxLayout(&dialog);
+    layout->setSpacing(12);
+    layout->setContentsMargins(20, 20, 20, 20);
+    auto* titleLabel = new QLabel("📊 Diagnostics", &dialog);
+    titleLabel->setStyleSheet("font-size: 14px; font-weight: 600;");
+    layout->addWidget(titleLabel);
+    auto* text = new QPlainTextEdit(report, &dialog);
+    text->setReadOnly(true);
+    text->setLineWrapMode(QPlainTextEdit::NoWrap);
+    text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    layout->addWidget(text);
+    auto* hintLabel = new QLabel("Copy this text, or export the trace for chrome://tracing or Perfetto, when reporting a slowdown.", &dialog);
+    hintLabel->setStyleSheet("font-size: 11px; font-style: italic;");
+    layout->addWidget(hintLabel);
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
+    QPushButton* exportButton = buttons->addButton("Export Trace...", QDialogButtonBox::ActionRole);
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    connect(exportButton, &QPushButton::clicked, &dialog, [this, &dialog]() {
+        QString path = QFileDialog::getSaveFileName(&dialog, "Export Trace", "alia-can-trace.json", "Chrome trace (*.json)");
+        if (path.isEmpty()) return;
+        if (Trace::instance().writeChromeTrace(path.toStdString())) showSuccess("📊 Trace exported");
+        else showError("Error", "Cannot write " + path);
+    });
+    dialog.exec();
+}
+
+void MainWindow::onRestoreBackup() {
+    if (QMessageBox::question(this, "Confirm Restore", "Restore from most recent backup?", QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) return;
+    TRACE_SCOPE(span, "MainWindow::onRestoreBackup");
+
+    BackupManager* manager = backupManager.get();
+    runWrite("Restoring backup...", [manager]() -> std::string {
+        if (manager->getLastBackupPath().empty()) return "No backup found to restore.";
+        return manager->restoreFromLastBackup() ? "" : "Failed to restore: " + manager->getLastError();
+    }, "⚡ Restored from backup successfully!");
 }
 
 bool MainWindow::validateInput(QString& aliasName, QString& command) {
@@ -385,6 +1029,7 @@ QGroupBox::title{subcontrol-origin:margin;left:12px;padding:0 5px 0 5px}
 QLineEdit{border:2px solid #e0e0e0;border-radius:6px;padding:8px 12px;background-color:#ffffff;selection-background-color:#2196F3;color:#1a1a1a;font-size:13px}
 QLineEdit:focus{border:2px solid #2196F3;background-color:#f0f7ff}
 QLineEdit:hover{border:2px solid #90caf9}
+QComboBox{border:2px solid #e0e0e0;border-radius:6px;padding:4px 10px;background-color:#ffffff;color:#1a1a1a;font-size:13px}
 QPushButton{background:qlineargradient(x1:0,y1:0,x2:0,y2:1,stop:0 #2196F3,stop:1 #1976D2);color:white;border:none;border-radius:6px;padding:8px 16px;font-weight:600;font-size:12px}
 QPushButton:hover{background:qlineargradient(x1:0,y1:0,x2:0,y2:1,stop:0 #42a5f5,stop:1 #1565C0)}
 QPushButton:pressed{background:qlineargradient(x1:0,y1:0,x2:0,y2:1,stop:0 #1565C0,stop:1 #0d47a1)}
@@ -393,6 +1038,11 @@ QListWidget{border:2px solid #e0e0e0;border-radius:6px;background-color:#ffffff;
 QListWidget::item{padding:8px;border-radius:4px;margin:2px}
 QListWidget::item:selected{background:qlineargradient(x1:0,y1:0,x2:0,y2:1,stop:0 #42a5f5,stop:1 #2196F3);color:white;border-radius:4px}
 QListWidget::item:hover{background-color:#f0f7ff}
+QTableView{border:2px solid #e0e0e0;border-radius:6px;background-color:#ffffff;color:#1a1a1a;outline:0}
+QTableView::item{padding:0 8px}
+QTableView::item:selected{background:qlineargradient(x1:0,y1:0,x2:0,y2:1,stop:0 #42a5f5,stop:1 #2196F3);color:white}
+QTableView::item:hover{background-color:#f0f7ff}
+QHeaderView::section{background-color:#f5f5f5;color:#1a1a1a;border:none;border-bottom:1px solid #e0e0e0;padding:6px 8px;font-weight:600}
 QLabel{color:#1a1a1a})";
 }
 
@@ -404,6 +1054,7 @@ QGroupBox::title{subcontrol-origin:margin;left:12px;padding:0 5px 0 5px}
 QLineEdit{border:2px solid #30363d;border-radius:6px;padding:8px 12px;background-color:#0d1117;selection-background-color:#1f6feb;color:#e0e0e0;font-size:13px}
 QLineEdit:focus{border:2px solid #1f6feb;background-color:#0d1117}
 QLineEdit:hover{border:2px solid #388bfd}
+QComboBox{border:2px solid #30363d;border-radius:6px;padding:4px 10px;background-color:#0d1117;color:#e0e0e0;font-size:13px}
 QPushButton{background:qlineargradient(x1:0,y1:0,x2:0,y2:1,stop:0 #1f6feb,stop:1 #1555d6);color:#ffffff;border:none;border-radius:6px;padding:8px 16px;font-weight:600;font-size:12px}
 QPushButton:hover{background:qlineargradient(x1:0,y1:0,x2:0,y2:1,stop:0 #388bfd,stop:1 #1f6feb)}
 QPushButton:pressed{background:qlineargradient(x1:0,y1:0,x2:0,y2:1,stop:0 #0969da,stop:1 #0860ca)}
@@ -412,6 +1063,11 @@ QListWidget{border:2px solid #30363d;border-radius:6px;background-color:#0d1117;
 QListWidget::item{padding:8px;border-radius:4px;margin:2px}
 QListWidget::item:selected{background:qlineargradient(x1:0,y1:0,x2:0,y2:1,stop:0 #388bfd,stop:1 #1f6feb);color:white;border-radius:4px}
 QListWidget::item:hover{background-color:#161b22}
+QTableView{border:2px solid #30363d;border-radius:6px;background-color:#0d1117;color:#e0e0e0;outline:0}
+QTableView::item{padding:0 8px}
+QTableView::item:selected{background:qlineargradient(x1:0,y1:0,x2:0,y2:1,stop:0 #388bfd,stop:1 #1f6feb);color:white}
+QTableView::item:hover{background-color:#161b22}
+QHeaderView::section{background-color:#161b22;color:#e0e0e0;border:none;border-bottom:1px solid #30363d;padding:6px 8px;font-weight:600}
 QLabel{color:#e0e0e0})";
 }
 
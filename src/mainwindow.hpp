@@ -1,17 +1,62 @@
 #pragma once
 
 #include <QMainWindow>
+#include <QFuture>
+#include <QPointer>
+#include <QThreadPool>
+#include <functional>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 #include "shelldetector.hpp"
 #include "aliasmanager.hpp"
+#include "aliasstore.hpp"
+#include "aliassearch.hpp"
 #include "configfilehandler.hpp"
 #include "backupmanager.hpp"
+#include "historyusage.hpp"
+#include "suggestionminer.hpp"
 
+class QComboBox;
 class QLabel;
-class QLineEdit;
 class QListWidget;
+class QLineEdit;
+class QProgressBar;
 class QPushButton;
+class QTableView;
+class QTimer;
+class AliasFilterModel;
+class ConfigWatcher;
+class AliasTableModel;
+
+struct AliasBatch {
+    std::vector<Alias> aliases;
+    std::vector<size_t> lines;
+    std::vector<std::string> origins;
+    std::vector<std::string> sources;
+    size_t total = 0;
+    std::string error;
+};
+
+struct StartupInfo {
+    ShellDetector::Shell shell = ShellDetector::Shell::UNKNOWN;
+    std::string configFilePath;
+    std::string backupDirectory;
+    std::string manifestPath;
+};
+
+struct DiagnosticsInfo {
+    std::vector<std::pair<std::string, uint64_t>> files;
+    std::string backupDirectory;
+    uint64_t backupBytes = 0;
+    size_t backupCount = 0;
+};
+
+struct SearchOutcome {
+    std::shared_ptr<const AliasSearch> index;
+    std::shared_ptr<const AliasSearch::Result> result;
+};
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -20,10 +65,15 @@ public:
     explicit MainWindow(QWidget* parent = nullptr);
     ~MainWindow() override;
 
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
 private slots:
     void onAddAlias();
     void onRemoveAlias();
+    void onBulkEdit();
     void onRefresh();
+    void onSuggestAliases();
     void onAliasSelected();
     void onNameChanged(const QString& text);
     void onCommandChanged(const QString& text);
@@ -31,11 +81,16 @@ private slots:
     void onRestoreBackup();
     void toggleTheme();
     void onSearchTextChanged(const QString& text);
+    void onCancelLoad();
+    void onConfigChangedExternally();
+    void onBackupsChanged();
+    void onShowDiagnostics();
 
 private:
     std::unique_ptr<ConfigFileHandler> configHandler;
     std::unique_ptr<BackupManager> backupManager;
-    ShellDetector::Shell currentShell;
+    std::shared_ptr<HistoryUsage> historyUsage;
+    ShellDetector::Shell currentShell = ShellDetector::Shell::UNKNOWN;
     std::string configFilePath;
     QLabel* shellInfoLabel;
     QLineEdit* aliasNameInput;
@@ -43,26 +98,62 @@ private:
     QLabel* commandStatus;
     QPushButton* addButton;
     QPushButton* removeButton;
+    QPushButton* bulkEditButton;
     QPushButton* refreshButton;
+    QPushButton* suggestButton;
     QPushButton* backupButton;
     QPushButton* restoreButton;
     QPushButton* themeToggle;
-    QListWidget* aliasList;
+    QPushButton* diagnosticsButton;
+    QTableView* aliasView;
+    AliasTableModel* aliasModel;
+    AliasFilterModel* aliasFilter;
     QLabel* statusLabel;
+    QProgressBar* progressBar;
+    QPushButton* cancelButton;
     QLineEdit* searchInput;
-    std::vector<Alias> currentAliases;
+    ConfigWatcher* configWatcher;
+    QPointer<QListWidget> backupList;
+    QComboBox* searchMode;
+    QTimer* searchTimer;
+    std::shared_ptr<const AliasSearch> searchIndex;
+    std::shared_ptr<const AliasSearch::Result> lastSearch;
+    int searchGeneration = 0;
+    int aliasRevision = 0;
+    int searchIndexRevision = -1;
+    AliasStore stagedAliases;
+    QThreadPool ioPool;
+    QFuture<AliasBatch> loadFuture;
+    int loadGeneration = 0;
+    bool incrementalLoad = false;
+    bool loadFailed = false;
+    QString pendingSuccess;
+    bool writeInFlight = false;
     bool isModifying = false;
     bool isDarkTheme = false;
     void initializeUI();
     void setupConnections();
-    void initializeShellDetection();
+    void initializeShellDetection(QFuture<StartupInfo> startup);
+    void markStartup(std::string_view phase);
     void loadAliasesFromFile();
+    void appendAliasBatch(const AliasBatch& batch);
+    void watchSources(std::vector<std::string> files);
+    void runWrite(const QString& busyMessage, std::function<std::string()> job, const QString& successMessage, std::function<void()> onSuccess = {});
+    void showBackupsDialog(const std::vector<BackupManager::Snapshot>& backups);
+    void showDiagnosticsDialog(const DiagnosticsInfo& info);
+    void showSuggestionsDialog(const std::vector<SuggestionMiner::Suggestion>& suggestions);
+    static void populateBackupList(QListWidget* list, const std::vector<BackupManager::Snapshot>& backups);
+    void setWriteInFlight(bool busy, const QString& message = QString());
     void updateShellInfo();
-    void updateAliasList();
-    void filterAliasList(const QString& searchText);
+    void filterAliasList();
+    void onAliasesChanged();
+    void updateCommandStatus();
+    void checkAliasTargets();
+    void updateAliasUsage();
     void showError(const QString& title, const QString& message);
     void showSuccess(const QString& message);
     bool validateInput(QString& aliasName, QString& command);
+    QStringList selectedAliasNames() const;
     void clearInputFields();
     void applyStylesheet();
     QString getLightTheme() const;
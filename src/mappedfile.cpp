@@ -0,0 +1,50 @@
+#include "mappedfile.hpp"
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) { open(path); }
+MappedFile::~MappedFile() { close(); }
+MappedFile::MappedFile(MappedFile&& other) noexcept
+: data(std::exchange(other.data, nullptr)), length(std::exchange(other.length, 0)), opened(std::exchange(other.opened, false)), lastError(std::move(other.lastError)) {}
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data = std::exchange(other.data, nullptr);
+        length = std::exchange(other.length, 0);
+        opened = std::exchange(other.opened, false);
+        lastError = std::move(other.lastError);
+    }
+    return *this;
+}
+bool MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { lastError = "Cannot open " + path + ": " + std::strerror(errno); return false; }
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) { lastError = "Cannot stat " + path + ": " + std::strerror(errno); ::close(fd); return false; }
+    length = static_cast<size_t>(sb.st_size);
+    if (length > 0) {
+        void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) { lastError = "Cannot map " + path + ": " + std::strerror(errno); length = 0; ::close(fd); return false; }
+        madvise(mapping, length, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapping);
+    }
+    ::close(fd);
+    opened = true;
+    return true;
+}
+void MappedFile::close() {
+    if (data != nullptr) munmap(const_cast<char*>(data), length);
+    data = nullptr;
+    length = 0;
+    opened = false;
+}
+bool MappedFile::isOpen() const { return opened; }
+std::string_view MappedFile::view() const { return data != nullptr ? std::string_view(data, length) : std::string_view(); }
+size_t MappedFile::size() const { return length; }
+std::string MappedFile::getLastError() const { return lastError; }
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+    std::string_view view() const;
+    size_t size() const;
+    std::string getLastError() const;
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    bool opened = false;
+    std::string lastError;
+};
@@ -0,0 +1,171 @@
+#include "parsecache.hpp"
+#include "shelldetector.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <unordered_set>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+static constexpr char MAGIC[8] = {'A', 'L', 'I', 'A', 'C', 'A', 'N', 'P'};
+struct ParseCache::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t fileCount;
+    uint64_t recordsOffset;
+    uint64_t totalSize;
+};
+struct ParseCache::FileRecord {
+    uint64_t device;
+    uint64_t inode;
+    int64_t mtime;
+    uint64_t size;
+    uint64_t pathOffset;
+    uint64_t poolOffset;
+    uint64_t poolLength;
+    uint64_t aliasOffset;
+    uint64_t includeOffset;
+    uint64_t environmentOffset;
+    uint32_t pathLength;
+    uint32_t aliasCount;
+    uint32_t includeCount;
+    uint32_t environmentCount;
+};
+
+static bool writeFully(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+    return true;
+}
+static bool fits(uint64_t offset, uint64_t length, size_t total) { return offset <= total && length <= total - offset; }
+static void align(std::string& out) { out.resize((out.size() + 7) & ~size_t{7}, '\0'); }
+template <typename T> static uint64_t appendArray(std::string& out, const T* items, size_t count) {
+    align(out);
+    uint64_t offset = out.size();
+    out.append(reinterpret_cast<const char*>(items), count * sizeof(T));
+    return offset;
+}
+
+ParseCache::ParseCache(std::string path) : path(std::move(path)) {}
+std::string ParseCache::defaultPath() {
+    return ShellDetector::cacheDirectory() + "/parse-cache";
+}
+bool ParseCache::stampOf(const std::string& path, Stamp& stamp) {
+    struct stat sb;
+    if (::stat(path.c_str(), &sb) != 0) return false;
+    stamp = Stamp{sb.st_dev, sb.st_ino, static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec, static_cast<uint64_t>(sb.st_size)};
+    return true;
+}
+// A missing, truncated or foreign file just leaves the cache empty; every lookup then misses.
+bool ParseCache::open() {
+    records = nullptr;
+    count = 0;
+    if (!file.open(path)) {
+        lastError = file.getLastError();
+        return false;
+    }
+    std::string_view data = file.view();
+    Header header;
+    if (data.size() < sizeof(header)) return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.totalSize != data.size() || header.recordsOffset % 8 != 0 || !fits(header.recordsOffset, uint64_t{header.fileCount} * sizeof(FileRecord), data.size())) {
+        lastError = "Ignoring invalid parse cache: " + path;
+        return false;
+    }
+    records = reinterpret_cast<const FileRecord*>(data.data() + header.recordsOffset);
+    count = header.fileCount;
+    return true;
+}
+bool ParseCache::entryAt(size_t index, Entry& entry) const {
+    const FileRecord& record = records[index];
+    std::string_view data = file.view();
+    if (!fits(record.pathOffset, record.pathLength, data.size()) || !fits(record.poolOffset, record.poolLength, data.size()) || record.aliasOffset % 8 != 0 || record.includeOffset % 8 != 0 || record.environmentOffset % 8 != 0 || !fits(record.aliasOffset, uint64_t{record.aliasCount} * sizeof(AliasRecord), data.size()) || !fits(record.includeOffset, uint64_t{record.includeCount} * sizeof(IncludeRecord), data.size()) || !fits(record.environmentOffset, uint64_t{record.environmentCount} * sizeof(EnvironmentRecord), data.size())) return false;
+    entry.path = data.substr(record.pathOffset, record.pathLength);
+    entry.stamp = Stamp{record.device, record.inode, record.mtime, record.size};
+    entry.pool = data.substr(record.poolOffset, record.poolLength);
+    entry.aliases = std::span(reinterpret_cast<const AliasRecord*>(data.data() + record.aliasOffset), record.aliasCount);
+    entry.includes = std::span(reinterpret_cast<const IncludeRecord*>(data.data() + record.includeOffset), record.includeCount);
+    entry.environment = std::span(reinterpret_cast<const EnvironmentRecord*>(data.data() + record.environmentOffset), record.environmentCount);
+    const size_t pool = entry.pool.size();
+    return std::all_of(entry.aliases.begin(), entry.aliases.end(), [pool](const AliasRecord& alias) { return fits(alias.nameOffset, alias.nameLength, pool) && fits(alias.commandOffset, alias.commandLength, pool); })
+        && std::all_of(entry.includes.begin(), entry.includes.end(), [pool](const IncludeRecord& include) { return fits(include.patternOffset, include.patternLength, pool); })
+        && std::all_of(entry.environment.begin(), entry.environment.end(), [pool](const EnvironmentRecord& variable) { return fits(variable.nameOffset, variable.nameLength, pool) && fits(variable.valueOffset, variable.valueLength, pool); });
+}
+bool ParseCache::lookup(std::string_view wanted, const Stamp& stamp, Entry& entry) const {
+    std::string_view data = file.view();
+    auto pathOf = [&](size_t index) { const FileRecord& r = records[index]; return fits(r.pathOffset, r.pathLength, data.size()) ? data.substr(r.pathOffset, r.pathLength) : std::string_view(); };
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (pathOf(middle) < wanted) low = middle + 1;
+        else high = middle;
+    }
+    if (low == count || pathOf(low) != wanted) return false;
+    const FileRecord& record = records[low];
+    if (Stamp{record.device, record.inode, record.mtime, record.size} != stamp) return false;
+    return entryAt(low, entry);
+}
+// `entries` take precedence; entries of the current cache for other paths are carried over while their file
+// is unchanged on disk, up to MAX_FILES in total.
+bool ParseCache::write(const std::vector<Entry>& entries) {
+    std::vector<Entry> all;
+    std::unordered_set<std::string_view> seen;
+    for (const Entry& entry : entries) {
+        if (seen.insert(entry.path).second) all.push_back(entry);
+    }
+    for (size_t i = 0; i < count && all.size() < MAX_FILES; ++i) {
+        Entry old;
+        Stamp current;
+        if (entryAt(i, old) && !seen.contains(old.path) && stampOf(std::string(old.path), current) && current == old.stamp) all.push_back(old);
+    }
+    all.resize(std::min(all.size(), MAX_FILES));
+    std::sort(all.begin(), all.end(), [](const Entry& a, const Entry& b) { return a.path < b.path; });
+    std::string out(sizeof(Header), '\0');
+    std::vector<FileRecord> table;
+    table.reserve(all.size());
+    for (const Entry& entry : all) {
+        FileRecord record{entry.stamp.device, entry.stamp.inode, entry.stamp.mtime, entry.stamp.size, 0, 0, entry.pool.size(), 0, 0, 0, static_cast<uint32_t>(entry.path.size()), static_cast<uint32_t>(entry.aliases.size()), static_cast<uint32_t>(entry.includes.size()), static_cast<uint32_t>(entry.environment.size())};
+        record.poolOffset = appendArray(out, entry.pool.data(), entry.pool.size());
+        record.aliasOffset = appendArray(out, entry.aliases.data(), entry.aliases.size());
+        record.includeOffset = appendArray(out, entry.includes.data(), entry.includes.size());
+        record.environmentOffset = appendArray(out, entry.environment.data(), entry.environment.size());
+        record.pathOffset = appendArray(out, entry.path.data(), entry.path.size());
+        table.push_back(record);
+    }
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.fileCount = static_cast<uint32_t>(table.size());
+    header.recordsOffset = appendArray(out, table.data(), table.size());
+    header.totalSize = out.size();
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    std::string tempPath = path + ".XXXXXX";
+    int fd = mkstemp(tempPath.data());
+    if (fd < 0) {
+        lastError = "Cannot create parse cache: " + std::string(std::strerror(errno));
+        return false;
+    }
+    bool ok = writeFully(fd, out);
+    if (::close(fd) != 0) ok = false;
+    if (!ok || ::rename(tempPath.c_str(), path.c_str()) != 0) {
+        lastError = "Failed to write parse cache: " + std::string(std::strerror(errno));
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+size_t ParseCache::size() const { return count; }
+const std::string& ParseCache::getPath() const { return path; }
+std::string ParseCache::getLastError() const { return lastError; }
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mappedfile.hpp"
+
+// What SourceGraph parsed out of each file, kept on disk in a layout that is used straight from the mapping:
+// a header, fixed-size file records sorted by path, and per file its alias and include records plus a string
+// pool they point into. A file's entry is only used while its device, inode, mtime and size all still match,
+// and every variable from outside the file that its include patterns were expanded with still has the value it
+// had, so a warm load costs a stat and a binary search per file. The cache is rewritten as a whole (temp file +
+// rename) whenever a load had to parse something; readers that still map the old one are unaffected.
+class ParseCache {
+public:
+    struct Stamp {
+        uint64_t device = 0;
+        uint64_t inode = 0;
+        int64_t mtime = 0;
+        uint64_t size = 0;
+        bool operator==(const Stamp&) const = default;
+    };
+    // Offsets are into the owning file's pool; `offset` is the statement's byte position in the source file.
+    // An UNALIAS record has no command and drops whatever definition of the name came before it.
+    static constexpr uint32_t UNALIAS = 1;
+    struct AliasRecord {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t commandOffset;
+        uint32_t commandLength;
+        uint32_t line;
+        uint32_t flags;
+        uint64_t offset;
+    };
+    struct IncludeRecord {
+        uint64_t offset;
+        uint32_t patternOffset;
+        uint32_t patternLength;
+    };
+    // A variable the file reads without assigning it, in `name` and `value` of the owning file's pool; SET is
+    // clear for a variable that was unset.
+    static constexpr uint32_t SET = 1;
+    struct EnvironmentRecord {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t valueOffset;
+        uint32_t valueLength;
+        uint32_t flags;
+        uint32_t reserved;
+    };
+    struct Entry {
+        std::string_view path;
+        Stamp stamp;
+        std::string_view pool;
+        std::span<const AliasRecord> aliases;
+        std::span<const IncludeRecord> includes;
+        std::span<const EnvironmentRecord> environment;
+    };
+    static constexpr uint32_t VERSION = 3;
+    static constexpr size_t MAX_FILES = 4096;
+    explicit ParseCache(std::string path = defaultPath());
+    static std::string defaultPath();
+    static bool stampOf(const std::string& path, Stamp& stamp);
+    bool open();
+    bool lookup(std::string_view path, const Stamp& stamp, Entry& entry) const;
+    bool write(const std::vector<Entry>& entries);
+    size_t size() const;
+    const std::string& getPath() const;
+    std::string getLastError() const;
+private:
+    struct Header;
+    struct FileRecord;
+    std::string path;
+    MappedFile file;
+    const FileRecord* records = nullptr;
+    size_t count = 0;
+    std::string lastError;
+    bool entryAt(size_t index, Entry& entry) const;
+};
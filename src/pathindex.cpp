@@ -0,0 +1,160 @@
+#include "pathindex.hpp"
+#include "shelldetector.hpp"
+#include "threadpool.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Builtins and reserved words of bash, zsh and fish, sorted: a command starting with one of them always runs.
+static constexpr std::string_view BUILTINS[] = {
+    "!", ".", ":", "[", "[[", "abbr", "alias", "and", "autoload", "begin", "bg", "bind", "break", "builtin", "caller",
+    "case", "cd", "command", "compgen", "complete", "contains", "continue", "declare", "dirs", "disown", "echo",
+    "emulate", "enable", "eval", "exec", "exit", "export", "false", "fc", "fg", "for", "function", "functions",
+    "getopts", "hash", "help", "history", "if", "jobs", "kill", "let", "local", "logout", "mapfile", "math", "noglob",
+    "not", "or", "popd", "print", "printf", "pushd", "pwd", "read", "readarray", "readonly", "return", "select",
+    "set", "set_color", "setopt", "shift", "shopt", "source", "status", "string", "suspend", "test", "time", "times",
+    "trap", "true", "type", "typeset", "ulimit", "umask", "unalias", "unfunction", "unset", "unsetopt", "until",
+    "wait", "whence", "while", "{"};
+
+PathIndex::PathIndex(std::string searchPath) {
+    for (size_t begin = 0; begin <= searchPath.size();) {
+        size_t end = std::min(searchPath.find(':', begin), searchPath.size());
+        std::string directory = searchPath.substr(begin, end - begin);
+        // An empty entry means the current directory, which says nothing about where aliases will run.
+        if (!directory.empty() && std::none_of(directories.begin(), directories.end(), [&](const Directory& d) { return d.path == directory; })) directories.push_back(Directory{directory, -1, 0, {}});
+        begin = end + 1;
+    }
+}
+PathIndex& PathIndex::shared() {
+    static PathIndex index(std::getenv("PATH") != nullptr ? std::getenv("PATH") : "/usr/local/bin:/usr/bin:/bin");
+    return index;
+}
+void PathIndex::refresh() {
+    std::lock_guard<std::mutex> lock(mutex);
+    refreshLocked();
+}
+std::shared_ptr<const PathIndex::Index> PathIndex::refreshIfDue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!built || std::chrono::steady_clock::now() - lastRefresh >= REFRESH_INTERVAL) refreshLocked();
+    }
+    return published.load(std::memory_order_acquire);
+}
+void PathIndex::refreshLocked() {
+    TRACE_SCOPE(span, "PathIndex::refresh");
+    lastRefresh = std::chrono::steady_clock::now();
+    std::vector<size_t> stale;
+    for (size_t i = 0; i < directories.size(); ++i) {
+        struct stat sb;
+        int64_t mtime = ::stat(directories[i].path.c_str(), &sb) == 0 && S_ISDIR(sb.st_mode) ? static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec : -1;
+        // A change in the same timestamp tick as the last listing leaves the mtime as it was, so a directory
+        // listed less than a second after its mtime is listed again, as git does for racily clean files.
+        if (built && mtime == directories[i].mtime && mtime + 1000000000 < directories[i].listed) continue;
+        directories[i].mtime = mtime;
+        stale.push_back(i);
+    }
+    if (built && stale.empty()) return;
+    built = true;
+    TRACE_ARG(span, "directories", stale.size());
+    ThreadPool::shared().parallelFor(stale.size(), [&](size_t i) { list(directories[stale[i]]); });
+    // Earlier directories win, as they do for the shell, so they are inserted last.
+    auto index = std::make_shared<Index>();
+    for (const Directory& directory : directories) index->paths.push_back(directory.path);
+    for (size_t i = directories.size(); i-- > 0;) {
+        for (const std::string& name : directories[i].names) index->executables.insert_or_assign(name, static_cast<uint32_t>(i));
+    }
+    published.store(std::move(index), std::memory_order_release);
+}
+void PathIndex::list(Directory& directory) {
+    directory.names.clear();
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    directory.listed = static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+    if (directory.mtime < 0) return;
+    DIR* dir = opendir(directory.path.c_str());
+    if (dir == nullptr) return;
+    const int fd = dirfd(dir);
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.' && (entry->d_name[1] == '\0' || (entry->d_name[1] == '.' && entry->d_name[2] == '\0'))) continue;
+        if (entry->d_type != DT_REG && entry->d_type != DT_LNK && entry->d_type != DT_UNKNOWN) continue;
+        struct stat sb;
+        if (fstatat(fd, entry->d_name, &sb, 0) == 0 && S_ISREG(sb.st_mode) && (sb.st_mode & (S_IXUSR | S_IXGRP | S_IXOTH)) != 0) directory.names.emplace_back(entry->d_name);
+    }
+    closedir(dir);
+}
+std::string PathIndex::find(std::string_view name) {
+    return findIn(*refreshIfDue(), name);
+}
+std::string PathIndex::findIn(const Index& index, std::string_view name) {
+    auto it = index.executables.find(name);
+    return it == index.executables.end() ? std::string() : index.paths[it->second] + "/" + std::string(name);
+}
+size_t PathIndex::size() {
+    return refreshIfDue()->executables.size();
+}
+bool PathIndex::isBuiltin(std::string_view word) {
+    return std::binary_search(std::begin(BUILTINS), std::end(BUILTINS), word);
+}
+// The word the shell would look up to run `command`: leading VAR=value assignments are skipped, and simple
+// quoting or a leading backslash (which only bypasses alias expansion) is removed.
+std::string_view PathIndex::commandWord(std::string_view command, size_t* wordEnd) {
+    constexpr std::string_view separators = " \t\n;|&()<>";
+    size_t begin = command.find_first_not_of(" \t\n");
+    while (begin != std::string_view::npos) {
+        size_t end = std::min(command.find_first_of(separators, begin), command.size());
+        if (end == begin) return {};
+        std::string_view word = command.substr(begin, end - begin);
+        size_t equals = word.find('=');
+        bool assignment = equals != std::string_view::npos && equals > 0 && std::all_of(word.begin(), word.begin() + static_cast<std::ptrdiff_t>(equals), [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+        if (!assignment) {
+            if (wordEnd != nullptr) *wordEnd = end;
+            if (word.size() >= 2 && (word.front() == '\'' || word.front() == '"') && word.back() == word.front()) word = word.substr(1, word.size() - 2);
+            if (word.starts_with('\\')) word.remove_prefix(1);
+            return word;
+        }
+        begin = command.find_first_not_of(" \t\n", end);
+    }
+    return {};
+}
+// Before the first refresh there is nothing to tell, so every command passes.
+PathIndex::Check PathIndex::check(std::string_view name, std::string_view command, const AliasStore* aliases) {
+    std::shared_ptr<const Index> index = published.load(std::memory_order_acquire);
+    return index != nullptr ? checkIn(*index, name, command, aliases) : Check{};
+}
+// An alias named like an executable is fine when it wraps that same command (`alias ls='ls --color'`, or via
+// `command ls`); otherwise it hides it. A command word is fine if it is a builtin, another alias, an existing
+// executable path, or on the search path. Functions defined in the rc files can't be told apart from missing
+// tools here, so those show up as MISSING too.
+PathIndex::Check PathIndex::checkIn(const Index& index, std::string_view name, std::string_view command, const AliasStore* aliases) {
+    size_t end = 0;
+    std::string_view word = commandWord(command, &end);
+    if (word == "command" || word == "builtin" || word == "exec") word = commandWord(command.substr(end));
+    if (std::string shadowed = findIn(index, name); !shadowed.empty()) {
+        bool wraps = word == name || (word.find('/') != std::string_view::npos && word.substr(word.rfind('/') + 1) == name);
+        if (!wraps) return Check{Status::SHADOWS, shadowed};
+    }
+    if (word.empty() || isBuiltin(word) || (word != name && aliases != nullptr && aliases->contains(word))) return Check{};
+    if (word.find('/') != std::string_view::npos) {
+        std::string path = ShellDetector::expandHome(std::string(word));
+        return ::access(path.c_str(), X_OK) == 0 ? Check{} : Check{Status::MISSING, std::string(word)};
+    }
+    // Words with expansions or globs are decided at run time.
+    if (word.find_first_of("$`*?[{~") != std::string_view::npos) return Check{};
+    return index.executables.contains(word) ? Check{} : Check{Status::MISSING, std::string(word)};
+}
+// Indexed by alias id; one refresh for the whole set, whose checks (an access() per path-like command) then
+// run against the published index without holding the lock.
+std::vector<PathIndex::Check> PathIndex::checkAll(const AliasStore& aliases) {
+    TRACE_SCOPE(span, "PathIndex::checkAll");
+    std::shared_ptr<const Index> index = refreshIfDue();
+    std::vector<Check> checks(aliases.slotCount());
+    for (const auto& alias : aliases) checks[alias.id] = checkIn(*index, alias.name, alias.command, &aliases);
+    TRACE_ARG(span, "aliases", checks.size());
+    return checks;
+}
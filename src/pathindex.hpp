@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "aliasstore.hpp"
+
+// Every executable on a search path by name, for telling what an alias name or an alias's command would run.
+// The first build lists all directories in parallel on the shared pool. A directory's mtime moves whenever an
+// entry is added, removed or renamed in it, so refresh() afterwards only re-lists directories whose mtime
+// changed, which costs one stat per directory when nothing did. find(), size() and checkAll() refresh at most
+// once per REFRESH_INTERVAL. Each refresh publishes an immutable index that lookups read without a lock;
+// check() never refreshes and only sees the last published one, so it is cheap enough for every keystroke.
+// Safe to use from any thread.
+class PathIndex {
+public:
+    enum class Status { OK, SHADOWS, MISSING };
+    // For SHADOWS `target` is the executable the alias hides, for MISSING the word that resolves to nothing.
+    struct Check {
+        Status status = Status::OK;
+        std::string target;
+    };
+    static constexpr std::chrono::milliseconds REFRESH_INTERVAL{1000};
+    explicit PathIndex(std::string searchPath);
+    static PathIndex& shared();
+    void refresh();
+    std::string find(std::string_view name);
+    size_t size();
+    Check check(std::string_view name, std::string_view command, const AliasStore* aliases = nullptr);
+    std::vector<Check> checkAll(const AliasStore& aliases);
+    static std::string_view commandWord(std::string_view command, size_t* wordEnd = nullptr);
+    static bool isBuiltin(std::string_view word);
+private:
+    struct Directory {
+        std::string path;
+        int64_t mtime = -1;
+        int64_t listed = 0;
+        std::vector<std::string> names;
+    };
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+    // What lookups see: the directories in search order and, per executable name, the first one holding it.
+    struct Index {
+        std::vector<std::string> paths;
+        std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> executables;
+    };
+    // Guards the directory listings and the refresh clock; only refreshes take it.
+    std::mutex mutex;
+    std::vector<Directory> directories;
+    std::chrono::steady_clock::time_point lastRefresh;
+    bool built = false;
+    std::atomic<std::shared_ptr<const Index>> published;
+    void refreshLocked();
+    std::shared_ptr<const Index> refreshIfDue();
+    static std::string findIn(const Index& index, std::string_view name);
+    static Check checkIn(const Index& index, std::string_view name, std::string_view command, const AliasStore* aliases);
+    static void list(Directory& directory);
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class Sha256 {
+public:
+    Sha256();
+    void update(std::string_view data);
+    std::array<uint8_t, 32> finish();
+    static std::string hex(std::string_view data);
+private:
+    std::array<uint32_t, 8> state;
+    std::array<uint8_t, 64> buffer;
+    size_t buffered = 0;
+    uint64_t totalBytes = 0;
+    void compress(const uint8_t* block);
+};
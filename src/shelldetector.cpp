@@ -1,4 +1,6 @@
 #include "shelldetector.hpp"
+#include "trace.hpp"
+#include <cctype>
 #include <cstdlib>
 #include <utility>
 #include <filesystem>
@@ -8,30 +10,68 @@
 #include <vector>
 #include <unistd.h>
 #include <pwd.h>
+#include <sys/stat.h>
 #include <string_view>
 
 namespace fs = std::filesystem;
 ShellDetector::Shell ShellDetector::detectShell() {
+    TRACE_SCOPE(span, "ShellDetector::detectShell");
     if (auto shell = detectFromEnvironment(); shell != Shell::UNKNOWN) return shell;
     if (auto shell = detectFromConfigFiles(); shell != Shell::UNKNOWN) return shell;
     if (std::string parent = getParentProcess(); !parent.empty()) {
-        if (parent.find("zsh") != std::string::npos) return Shell::ZSH;
-        if (parent.find("bash") != std::string::npos) return Shell::BASH;
-        if (parent.find("fish") != std::string::npos) return Shell::FISH;
+        if (auto shell = shellFromPath(parent); shell != Shell::UNKNOWN) return shell;
     }
     return Shell::BASH;
 }
-ShellDetector::Shell ShellDetector::detectFromEnvironment() {
-    if (const char* shellEnv = std::getenv("SHELL"); shellEnv != nullptr) {
-        std::string_view shellPath(shellEnv);
-        if (shellPath.find("zsh") != std::string_view::npos) return Shell::ZSH;
-        if (shellPath.find("bash") != std::string_view::npos) return Shell::BASH;
-        if (shellPath.find("fish") != std::string_view::npos) return Shell::FISH;
+// $SHELL answers without touching the disk. Otherwise the answer from the last start for this $HOME is reused
+// while its config file still exists, which skips probing the rc files and reading /proc at every start.
+ShellDetector::Shell ShellDetector::detectShellCached(const std::string& cachePath) {
+    if (auto shell = detectFromEnvironment(); shell != Shell::UNKNOWN) return shell;
+    const std::string home = expandHome("~");
+    const std::string path = cachePath.empty() ? cacheDirectory() + "/shell" : cachePath;
+    if (std::ifstream cache(path); cache.is_open()) {
+        std::string cachedHome, name;
+        if (std::getline(cache, cachedHome, '\t') && std::getline(cache, name) && cachedHome == home) {
+            Shell shell = shellFromPath(name);
+            if (shell != Shell::UNKNOWN && fs::exists(getConfigFilePath(shell))) return shell;
+        }
     }
+    Shell shell = detectShell();
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    std::string name = getShellName(shell);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (std::ofstream cache(path, std::ios::trunc); cache.is_open()) cache << home << '\t' << name << '\n';
+    return shell;
+}
+ShellDetector::Shell ShellDetector::detectShellForHome(const std::string& home) {
+    if (auto shell = detectFromLoginShell(home); shell != Shell::UNKNOWN) return shell;
+    if (auto shell = detectFromConfigFiles(home); shell != Shell::UNKNOWN) return shell;
+    return Shell::BASH;
+}
+ShellDetector::Shell ShellDetector::shellFromPath(std::string_view path) {
+    if (path.find("zsh") != std::string_view::npos) return Shell::ZSH;
+    if (path.find("bash") != std::string_view::npos) return Shell::BASH;
+    if (path.find("fish") != std::string_view::npos) return Shell::FISH;
     return Shell::UNKNOWN;
 }
-ShellDetector::Shell ShellDetector::detectFromConfigFiles() {
-    std::string home = expandHome("~");
+ShellDetector::Shell ShellDetector::detectFromEnvironment() {
+    if (const char* shellEnv = std::getenv("SHELL"); shellEnv != nullptr) return shellFromPath(shellEnv);
+    return Shell::UNKNOWN;
+}
+ShellDetector::Shell ShellDetector::detectFromLoginShell(const std::string& home) {
+    struct stat sb;
+    if (stat(home.c_str(), &sb) != 0) return Shell::UNKNOWN;
+    struct passwd pwd;
+    struct passwd* result = nullptr;
+    char buffer[4096];
+    if (getpwuid_r(sb.st_uid, &pwd, buffer, sizeof(buffer), &result) != 0 || result == nullptr || result->pw_shell == nullptr) return Shell::UNKNOWN;
+    std::error_code ec;
+    if (!fs::equivalent(home, result->pw_dir, ec)) return Shell::UNKNOWN;
+    return shellFromPath(result->pw_shell);
+}
+ShellDetector::Shell ShellDetector::detectFromConfigFiles(const std::string& homeDir) {
+    std::string home = expandHome("~", homeDir);
     constexpr std::pair<Shell, std::string_view> configs[] = {
         {Shell::ZSH, ZSHRC},
         {Shell::BASH, BASHRC},
@@ -52,17 +92,23 @@ std::string ShellDetector::getParentProcess() {
     }
     return "";
 }
-std::string ShellDetector::expandHome(const std::string& path) {
+std::string ShellDetector::expandHome(const std::string& path, const std::string& home) {
     if (path.empty() || path[0] != '~') return path;
-    const char* homeDir = std::getenv("HOME");
+    const char* homeDir = home.empty() ? std::getenv("HOME") : home.c_str();
     if (homeDir == nullptr) {
         if (struct passwd* pw = getpwuid(getuid()); pw != nullptr) homeDir = pw->pw_dir;
         else return path;
     }
     return path.length() > 1 ? std::string(homeDir) + path.substr(1) : homeDir;
 }
-std::string ShellDetector::getConfigFilePath(Shell shell) {
-    std::string home = expandHome("~");
+std::string ShellDetector::cacheDirectory() {
+    const char* cache = std::getenv("XDG_CACHE_HOME");
+    if (cache != nullptr && *cache == '/') return std::string(cache) + "/alia-can";
+    const char* home = std::getenv("HOME");
+    return std::string(home != nullptr ? home : "/tmp") + "/.cache/alia-can";
+}
+std::string ShellDetector::getConfigFilePath(Shell shell, const std::string& homeDir) {
+    std::string home = expandHome("~", homeDir);
     switch (shell) {
         case Shell::BASH: return home + "/" + std::string(BASHRC);
         case Shell::ZSH:  return home + "/" + std::string(ZSHRC);
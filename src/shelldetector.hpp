@@ -6,13 +6,18 @@ class ShellDetector {
 public:
     enum class Shell { BASH, ZSH, FISH, UNKNOWN };
     static Shell detectShell();
-    static std::string getConfigFilePath(Shell shell);
+    static Shell detectShellCached(const std::string& cachePath = "");
+    static Shell detectShellForHome(const std::string& home);
+    static std::string getConfigFilePath(Shell shell, const std::string& home = "");
     static std::string getShellName(Shell shell);
     static Shell detectFromEnvironment();
-    static Shell detectFromConfigFiles();
+    static Shell detectFromConfigFiles(const std::string& home = "");
+    static Shell detectFromLoginShell(const std::string& home);
     static std::string getParentProcess();
-    static std::string expandHome(const std::string& path);
+    static std::string expandHome(const std::string& path, const std::string& home = "");
+    static std::string cacheDirectory();
 private:
+    static Shell shellFromPath(std::string_view path);
     static constexpr std::string_view BASHRC = ".bashrc";
     static constexpr std::string_view ZSHRC = ".zshrc";
     static constexpr std::string_view FISH_CONFIG = ".config/fish/config.fish";
@@ -0,0 +1,385 @@
+#include "sourcegraph.hpp"
+#include "aliasparser.hpp"
+#include "aliasscanner.hpp"
+#include "mappedfile.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <glob.h>
+
+namespace fs = std::filesystem;
+// A variable the file assigned, with the variables from outside the file its value was built from; one assigned
+// something that couldn't be evaluated is unknown.
+struct Variable {
+    std::string value;
+    std::vector<std::string> environment;
+    bool known = true;
+};
+using Variables = std::unordered_map<std::string, Variable>;
+struct Block {
+    bool loop = false;
+    std::string variable;
+    std::vector<std::string> patterns;
+};
+
+static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+static bool isSeparator(char c) { return c == ';' || c == '&' || c == '|'; }
+static bool isNameChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+// Raw words of one line, split at unquoted blanks. Runs of `;`, `&` and `|` become a single ";" word so `[ -f x ]
+// && . x` splits into two statements, and an unquoted `#` at the start of a word ends the line.
+static void splitLine(std::string_view line, std::vector<std::string_view>& words) {
+    words.clear();
+    size_t i = 0;
+    while (i < line.size()) {
+        if (isBlank(line[i])) { ++i; continue; }
+        if (line[i] == '#') break;
+        if (isSeparator(line[i])) {
+            words.push_back(";");
+            while (i < line.size() && isSeparator(line[i])) ++i;
+            continue;
+        }
+        size_t start = i;
+        char quote = 0;
+        for (; i < line.size(); ++i) {
+            char c = line[i];
+            if (quote != 0) {
+                if (c == '\\' && quote == '"') ++i;
+                else if (c == quote) quote = 0;
+            } else if (c == '\\') {
+                ++i;
+            } else if (c == '\'' || c == '"') {
+                quote = c;
+            } else if (isBlank(c) || isSeparator(c)) {
+                break;
+            }
+        }
+        i = std::min(i, line.size());
+        words.push_back(line.substr(start, i - start));
+    }
+}
+static constexpr std::string_view PREFIXES[] = {"then", "do", "else", "{", "builtin", "command"};
+static bool isPrefix(std::string_view word) { return std::find(std::begin(PREFIXES), std::end(PREFIXES), word) != std::end(PREFIXES); }
+// Whether a statement whose command is the raw `word` can include a file, open or close a block or assign a
+// variable or unalias a name; every other statement is skipped without decoding its words.
+static bool matters(std::string_view word, bool fish) {
+    static constexpr std::string_view COMMANDS[] = {"source", ".", "for", "while", "until", "done", "unalias", "export", "local", "typeset", "declare", "readonly"};
+    static constexpr std::string_view FISH_COMMANDS[] = {"source", ".", "for", "while", "if", "function", "begin", "switch", "end", "set", "functions"};
+    if (fish) return std::find(std::begin(FISH_COMMANDS), std::end(FISH_COMMANDS), word) != std::end(FISH_COMMANDS);
+    if (std::find(std::begin(COMMANDS), std::end(COMMANDS), word) != std::end(COMMANDS)) return true;
+    size_t equals = word.find('=');
+    return equals != 0 && equals != std::string_view::npos && std::all_of(word.begin(), word.begin() + equals, isNameChar);
+}
+// Longer than any path that could be sourced; rc files that keep prepending to $PATH would otherwise copy an
+// ever-growing value on every line.
+static constexpr size_t MAX_VALUE = 4096;
+// Expands a leading ~ and $NAME / ${NAME}; false if the text needs anything this can't evaluate or the result
+// exceeds MAX_VALUE. Variables the file didn't assign come from `outside`; their names are added to `reads`, as
+// are the ones behind each assigned variable used.
+template <typename Outside> static bool expand(std::string_view text, const Variables& variables, const Outside& outside, std::string& out, std::vector<std::string>& reads) {
+    out.clear();
+    auto external = [&](const std::string& name) {
+        reads.push_back(name);
+        std::optional<std::string> value = outside(name);
+        if (value) out += *value;
+        return value.has_value();
+    };
+    if (text.starts_with('~') && (text.size() == 1 || text[1] == '/')) {
+        external("HOME");
+        text.remove_prefix(1);
+    }
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '`') return false;
+        if (text[i] != '$') {
+            out.push_back(text[i]);
+            continue;
+        }
+        bool braced = i + 1 < text.size() && text[i + 1] == '{';
+        size_t begin = i + 1 + braced, end = begin;
+        while (end < text.size() && isNameChar(text[end])) ++end;
+        if (end == begin || (braced && (end >= text.size() || text[end] != '}'))) return false;
+        std::string name(text.substr(begin, end - begin));
+        if (auto it = variables.find(name); it != variables.end()) {
+            reads.insert(reads.end(), it->second.environment.begin(), it->second.environment.end());
+            if (!it->second.known) return false;
+            out += it->second.value;
+        } else if (!external(name)) {
+            return false;
+        }
+        if (out.size() > MAX_VALUE) return false;
+        i = end - !braced;
+    }
+    return out.size() <= MAX_VALUE;
+}
+// Shells start in $HOME, so that's what relative paths resolve against; a pattern expands like a shell glob,
+// sorted, and only existing regular files are kept.
+static void resolve(const std::string& pattern, const std::string& home, std::vector<std::string>& out) {
+    fs::path path(pattern);
+    if (path.is_relative()) path = fs::path(home) / path;
+    std::vector<std::string> matches;
+    if (pattern.find_first_of("*?[") == std::string::npos) {
+        matches.push_back(path.string());
+    } else {
+        glob_t found;
+        if (glob(path.c_str(), 0, nullptr, &found) == 0) matches.assign(found.gl_pathv, found.gl_pathv + found.gl_pathc);
+        globfree(&found);
+    }
+    for (const auto& match : matches) {
+        std::error_code ec;
+        fs::path canonical = fs::canonical(match, ec);
+        if (!ec && fs::is_regular_file(canonical, ec)) out.push_back(canonical.string());
+    }
+}
+
+SourceGraph::SourceGraph(const std::string& rootPath, ShellDetector::Shell shell, const std::string& homeDirectory)
+    : rootPath(rootPath), shell(shell), home(homeDirectory), inherited(homeDirectory.empty()) {
+    if (!inherited) return;
+    const char* env = std::getenv("HOME");
+    fs::path root = fs::absolute(rootPath).lexically_normal();
+    // A config outside $HOME (fleet runs over other users' homes) gets the home it lives in instead.
+    if (env != nullptr && *env != '\0' && root.string().starts_with(std::string(env) + "/")) home = env;
+    else home = (shell == ShellDetector::Shell::FISH ? root.parent_path().parent_path().parent_path() : root.parent_path()).string();
+}
+// The value expand() uses for a variable the file doesn't assign; nullopt while it is unset. Another user's
+// files see none of the invoking user's environment.
+std::optional<std::string> SourceGraph::environment(const std::string& name) const {
+    if (name == "HOME") return home;
+    if (const char* value = inherited ? std::getenv(name.c_str()) : nullptr; value != nullptr) return std::string(value);
+    if (name == "XDG_CONFIG_HOME") return home + "/.config";
+    return std::nullopt;
+}
+// Decoded names and commands go to the node's pool, as do include patterns once their variables are expanded;
+// the patterns are globbed afresh on every load, so a file dropped into ~/.bashrc.d/ shows up even while the
+// file with the loop is served from the cache. The outside variables the patterns were expanded with are
+// recorded with their values, and the cached entry is only used while they still have them.
+void SourceGraph::parseNode(Node& node, std::string_view content, bool fish) {
+    auto intern = [&node](std::string_view text) {
+        uint32_t offset = static_cast<uint32_t>(node.pool.size());
+        node.pool.append(text);
+        return offset;
+    };
+    AliasScanner::scan(content, shell, [&](const ScannedAlias& scanned) {
+        uint32_t name = intern(scanned.alias.name);
+        uint32_t command = intern(scanned.alias.command);
+        node.aliases.push_back(ParseCache::AliasRecord{name, static_cast<uint32_t>(scanned.alias.name.size()), command, static_cast<uint32_t>(scanned.alias.command.size()), static_cast<uint32_t>(scanned.line), 0, scanned.offset});
+    });
+    Variables variables;
+    std::vector<Block> blocks;
+    std::string expanded;
+    std::vector<std::string> reads;
+    std::unordered_set<std::string> recorded;
+    auto outside = [this](const std::string& name) { return environment(name); };
+    auto record = [&](const std::string& name) {
+        if (!recorded.insert(name).second) return;
+        std::optional<std::string> value = outside(name);
+        uint32_t nameOffset = intern(name);
+        uint32_t valueOffset = intern(value.value_or(""));
+        node.environment.push_back(ParseCache::EnvironmentRecord{nameOffset, static_cast<uint32_t>(name.size()), valueOffset, static_cast<uint32_t>(value.value_or("").size()), value ? ParseCache::SET : 0, 0});
+    };
+    // Sorted and unique, so a value assigned from itself on every line ($PATH) doesn't grow its list.
+    auto assign = [&](const std::string& name, std::string value, bool known) {
+        std::sort(reads.begin(), reads.end());
+        reads.erase(std::unique(reads.begin(), reads.end()), reads.end());
+        variables[name] = Variable{known ? std::move(value) : std::string(), reads, known};
+    };
+    auto include = [&](size_t offset, const std::string& argument) {
+        std::vector<std::string> patterns{argument};
+        // `. "$f"` inside `for f in PATTERNS` sources whatever the loop's patterns match.
+        if (argument.starts_with('$')) {
+            std::string variable = argument.substr(argument[1] == '{' ? 2 : 1);
+            if (argument[1] == '{' && variable.ends_with('}')) variable.pop_back();
+            auto loop = std::find_if(blocks.rbegin(), blocks.rend(), [&](const Block& block) { return block.loop && block.variable == variable; });
+            if (loop != blocks.rend()) patterns = loop->patterns;
+        }
+        for (const auto& pattern : patterns) {
+            reads.clear();
+            if (expand(pattern, variables, outside, expanded, reads)) node.includeRecords.push_back(ParseCache::IncludeRecord{offset, intern(expanded), static_cast<uint32_t>(expanded.size())});
+            for (const auto& name : reads) record(name);
+        }
+    };
+    const size_t scanned = node.aliases.size();
+    auto unalias = [&](size_t offset, size_t line, const std::string& name) {
+        node.aliases.push_back(ParseCache::AliasRecord{intern(name), static_cast<uint32_t>(name.size()), 0, 0, static_cast<uint32_t>(line), ParseCache::UNALIAS, offset});
+    };
+    std::vector<std::string_view> raw;
+    std::vector<std::string> words;
+    size_t lineStart = 0, lineNumber = 0;
+    while (lineStart < content.size()) {
+        size_t lineEnd = content.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) lineEnd = content.size();
+        std::string_view line = content.substr(lineStart, lineEnd - lineStart);
+        const size_t offset = lineStart;
+        lineStart = lineEnd + 1;
+        ++lineNumber;
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string_view::npos || line[first] == '#' || line.substr(first).starts_with(AliasParser::KEYWORD)) continue;
+        // Most lines are plain commands: unless the first word matters or a separator could start another
+        // statement, the line isn't split at all.
+        std::string_view head = line.substr(first, line.find_first_of(" \t;&|", first) - first);
+        if (!matters(head, fish) && !isPrefix(head) && line.find_first_of(";&|", first) == std::string_view::npos) continue;
+        splitLine(line, raw);
+        for (size_t begin = 0; begin < raw.size();) {
+            size_t end = begin;
+            while (end < raw.size() && raw[end] != ";") ++end;
+            size_t start = begin;
+            while (start < end && isPrefix(raw[start])) ++start;
+            const bool decode = start < end && matters(raw[start], fish);
+            words.clear();
+            for (size_t i = start; decode && i < end; ++i) words.push_back(AliasParser::decodeWord(raw[i]));
+            begin = end + 1;
+            if (words.empty()) continue;
+            const std::string& command = words[0];
+            if (command == "for" && words.size() > 2 && words[2] == "in") {
+                Block loop{true, words[1], {}};
+                for (size_t i = 3; i < words.size() && words[i] != "do"; ++i) loop.patterns.push_back(words[i]);
+                blocks.push_back(std::move(loop));
+            } else if (command == "while" || command == "until" || (fish && (command == "if" || command == "function" || command == "begin" || command == "switch"))) {
+                blocks.push_back(Block{});
+            } else if (command == "done" || (fish && command == "end")) {
+                if (!blocks.empty()) blocks.pop_back();
+            } else if (command == "source" || command == ".") {
+                if (words.size() > 1) include(offset, words[1]);
+            } else if (command == "unalias" || (command == "functions" && words.size() > 1 && (words[1] == "-e" || words[1] == "--erase"))) {
+                // Names run up to the first redirection, as in the `unalias NAME 2>/dev/null` the handler writes.
+                for (size_t i = 1; i < words.size() && words[i].find_first_of("<>") == std::string::npos; ++i) {
+                    if (!words[i].starts_with('-')) unalias(offset, lineNumber, words[i]);
+                }
+            } else if (fish && command == "set") {
+                size_t name = 1;
+                while (name < words.size() && words[name].starts_with('-')) ++name;
+                if (name >= words.size()) continue;
+                std::string value;
+                bool ok = true;
+                reads.clear();
+                for (size_t i = name + 1; i < words.size() && ok; ++i) {
+                    ok = expand(words[i], variables, outside, expanded, reads);
+                    value += (i > name + 1 ? " " : "") + expanded;
+                }
+                assign(words[name], std::move(value), ok);
+            } else {
+                size_t assignment = 0;
+                if (command == "export" || command == "local" || command == "typeset" || command == "declare" || command == "readonly") {
+                    ++assignment;
+                    while (assignment < words.size() && words[assignment].starts_with('-')) ++assignment;
+                }
+                if (assignment >= words.size()) continue;
+                const std::string& word = words[assignment];
+                size_t equals = word.find('=');
+                if (equals == 0 || equals == std::string::npos || !std::all_of(word.begin(), word.begin() + equals, isNameChar)) continue;
+                reads.clear();
+                bool known = expand(std::string_view(word).substr(equals + 1), variables, outside, expanded, reads);
+                assign(word.substr(0, equals), expanded, known);
+            }
+        }
+    }
+    auto byOffset = [](const ParseCache::AliasRecord& a, const ParseCache::AliasRecord& b) { return a.offset < b.offset; };
+    std::inplace_merge(node.aliases.begin(), node.aliases.begin() + static_cast<std::ptrdiff_t>(scanned), node.aliases.end(), byOffset);
+}
+bool SourceGraph::readNode(size_t index, const ParseCache* cache) {
+    Node& node = nodes[index];
+    if (!ParseCache::stampOf(paths[index], node.stamp)) return false;
+    ParseCache::Entry entry;
+    auto unchanged = [&] {
+        return std::all_of(entry.environment.begin(), entry.environment.end(), [&](const ParseCache::EnvironmentRecord& variable) {
+            std::optional<std::string> value = environment(std::string(entry.pool.substr(variable.nameOffset, variable.nameLength)));
+            return value.has_value() == ((variable.flags & ParseCache::SET) != 0) && (!value || *value == entry.pool.substr(variable.valueOffset, variable.valueLength));
+        });
+    };
+    if (cache != nullptr && cache->lookup(paths[index], node.stamp, entry) && unchanged()) {
+        node.cached = true;
+        node.cachedPool = entry.pool;
+        node.aliases.assign(entry.aliases.begin(), entry.aliases.end());
+        node.includeRecords.assign(entry.includes.begin(), entry.includes.end());
+        node.environment.assign(entry.environment.begin(), entry.environment.end());
+    } else {
+        MappedFile file;
+        if (!file.open(paths[index])) return false;
+        parseNode(node, file.view(), shell == ShellDetector::Shell::FISH);
+    }
+    if (shell == ShellDetector::Shell::FISH && index == 0) {
+        Include confd;
+        resolve((fs::path(paths[0]).parent_path() / "conf.d" / "*.fish").string(), home, confd.paths);
+        if (!confd.paths.empty()) node.includes.push_back(std::move(confd));
+    }
+    std::string_view text = node.text();
+    for (const auto& record : node.includeRecords) {
+        if (node.includes.empty() || node.includes.back().offset != record.offset) node.includes.push_back(Include{record.offset, {}, {}});
+        resolve(std::string(text.substr(record.patternOffset, record.patternLength)), home, node.includes.back().paths);
+    }
+    return true;
+}
+bool SourceGraph::load(ParseCache* cache) {
+    paths.assign(1, rootPath);
+    nodes.assign(1, Node{});
+    evaluated.clear();
+    cachedFiles = 0;
+    std::error_code ec;
+    std::unordered_map<std::string, size_t> seen{{fs::canonical(rootPath, ec).string(), 0}};
+    std::vector<size_t> level{0};
+    std::vector<char> readable(1, 0);
+    while (!level.empty()) {
+        ThreadPool::shared().parallelFor(level.size(), [&](size_t i) { readable[level[i]] = readNode(level[i], cache); });
+        if (!readable[0]) {
+            lastError = "Cannot open config file for reading: " + rootPath;
+            return false;
+        }
+        std::vector<size_t> next;
+        for (size_t index : level) {
+            for (Include& include : nodes[index].includes) {
+                for (const auto& path : include.paths) {
+                    auto [it, added] = seen.emplace(path, paths.size());
+                    if (added) {
+                        if (paths.size() == MAX_FILES) {
+                            seen.erase(it);
+                            continue;
+                        }
+                        paths.push_back(path);
+                        next.push_back(paths.size() - 1);
+                    }
+                    include.nodes.push_back(it->second);
+                }
+            }
+        }
+        nodes.resize(paths.size());
+        readable.resize(paths.size(), 0);
+        level = std::move(next);
+    }
+    std::vector<char> active(nodes.size(), 0);
+    evaluate(0, active);
+    std::vector<ParseCache::Entry> fresh;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].cached) ++cachedFiles;
+        if (readable[i]) fresh.push_back(ParseCache::Entry{paths[i], nodes[i].stamp, nodes[i].text(), nodes[i].aliases, nodes[i].includeRecords, nodes[i].environment});
+    }
+    if (cache != nullptr && cachedFiles < fresh.size()) cache->write(fresh);
+    return true;
+}
+// Replays one file: its aliases and includes interleaved by position, an include expanding in place. A file
+// that (indirectly) sources itself is not re-entered.
+void SourceGraph::evaluate(size_t index, std::vector<char>& active) {
+    if (active[index]) return;
+    active[index] = 1;
+    const Node& node = nodes[index];
+    std::string_view text = node.text();
+    auto emit = [&](const ParseCache::AliasRecord& alias) {
+        std::string_view name = text.substr(alias.nameOffset, alias.nameLength);
+        if (alias.flags & ParseCache::UNALIAS) std::erase_if(evaluated, [name](const Definition& definition) { return definition.name == name; });
+        else evaluated.push_back(Definition{name, text.substr(alias.commandOffset, alias.commandLength), alias.line, index});
+    };
+    size_t alias = 0;
+    for (const Include& include : node.includes) {
+        for (; alias < node.aliases.size() && node.aliases[alias].offset < include.offset; ++alias) emit(node.aliases[alias]);
+        for (size_t child : include.nodes) evaluate(child, active);
+    }
+    for (; alias < node.aliases.size(); ++alias) emit(node.aliases[alias]);
+    active[index] = 0;
+}
+const std::vector<std::string>& SourceGraph::files() const { return paths; }
+const std::vector<SourceGraph::Definition>& SourceGraph::definitions() const { return evaluated; }
+size_t SourceGraph::cachedFileCount() const { return cachedFiles; }
+const std::string& SourceGraph::homeDirectory() const { return home; }
+std::string SourceGraph::getLastError() const { return lastError; }
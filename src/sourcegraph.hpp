@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "aliasmanager.hpp"
+#include "parsecache.hpp"
+#include "shelldetector.hpp"
+
+// The rc file and everything it pulls in with `source FILE`, `. FILE` or a `for f in DIR/*.sh; do . "$f"; done`
+// loop (plus conf.d/*.fish for fish, which fish sources on its own). Files are read one include level at a
+// time, each level in parallel on the shared pool; the definitions are then replayed in the order the shell
+// would evaluate them, so an alias redefined in a later file wins exactly as it does in a real shell.
+// `unalias NAME` (fish: `functions --erase NAME`) drops the definitions of NAME made before it.
+// Paths may use ~, $HOME and variables assigned earlier in the same file or exported by the invoking user; anything that needs running code to
+// resolve (command substitutions, zsh glob qualifiers) is skipped, as are files that don't exist.
+// With a ParseCache, unchanged files are taken from it instead of being read (unless a variable from the
+// environment that one of their include paths used has changed since), and definitions() then point
+// straight into its mapping; the cache is rewritten after a load that had to parse anything.
+class SourceGraph {
+public:
+    struct Definition {
+        std::string_view name;
+        std::string_view command;
+        size_t line = 0;
+        size_t file = 0;
+        Alias materialize() const { return Alias{std::string(name), std::string(command)}; }
+    };
+    static constexpr size_t MAX_FILES = 512;
+    // `home` is that of the config's owner when it isn't the invoking user (fleet runs): $HOME and $XDG_CONFIG_HOME
+    // then derive from it and nothing is taken from this process's environment.
+    SourceGraph(const std::string& rootPath, ShellDetector::Shell shell, const std::string& home = "");
+    bool load(ParseCache* cache = nullptr);
+    const std::vector<std::string>& files() const;
+    const std::vector<Definition>& definitions() const;
+    size_t cachedFileCount() const;
+    const std::string& homeDirectory() const;
+    std::string getLastError() const;
+private:
+    struct Include {
+        size_t offset = 0;
+        std::vector<std::string> paths;
+        std::vector<size_t> nodes;
+    };
+    // Names, commands and expanded include patterns live in `pool` for a file parsed here and in the cache's
+    // mapping for one taken from it; the records hold offsets into whichever it is.
+    struct Node {
+        ParseCache::Stamp stamp;
+        bool cached = false;
+        std::string_view cachedPool;
+        std::string pool;
+        std::vector<ParseCache::AliasRecord> aliases;
+        std::vector<ParseCache::IncludeRecord> includeRecords;
+        std::vector<ParseCache::EnvironmentRecord> environment;
+        std::vector<Include> includes;
+        std::string_view text() const { return cached ? cachedPool : std::string_view(pool); }
+    };
+    std::string rootPath;
+    ShellDetector::Shell shell;
+    std::string home;
+    bool inherited = true;
+    std::vector<std::string> paths;
+    std::vector<Node> nodes;
+    std::vector<Definition> evaluated;
+    size_t cachedFiles = 0;
+    std::string lastError;
+    std::optional<std::string> environment(const std::string& name) const;
+    bool readNode(size_t index, const ParseCache* cache);
+    void parseNode(Node& node, std::string_view content, bool fish);
+    void evaluate(size_t index, std::vector<char>& active);
+};
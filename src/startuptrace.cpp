@@ -0,0 +1,91 @@
+#include "startuptrace.hpp"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+StartupTrace& StartupTrace::instance() {
+    static StartupTrace trace;
+    return trace;
+}
+// Removes the flag so QApplication never sees it; true if it was given.
+bool StartupTrace::consumeFlag(int& argc, char* argv[]) {
+    bool found = false;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--startup-trace") == 0) found = true;
+        else argv[kept++] = argv[i];
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    return found;
+}
+// How long the process ran before main(): exec, dynamic linking and static initialisers, which for a Qt binary
+// are a real share of startup. /proc only has it in clock ticks, so this is accurate to about 10 ms.
+double StartupTrace::processAge() {
+    std::ifstream stat("/proc/self/stat");
+    std::string content((std::istreambuf_iterator<char>(stat)), {});
+    size_t fields = content.rfind(')');
+    if (fields == std::string::npos) return 0;
+    std::istringstream rest(content.substr(fields + 2));
+    std::string skipped;
+    for (int field = 3; field < 22; ++field) rest >> skipped;
+    unsigned long long startTicks = 0;
+    timespec now;
+    if (!(rest >> startTicks) || clock_gettime(CLOCK_BOOTTIME, &now) != 0) return 0;
+    double age = (now.tv_sec + now.tv_nsec / 1e9 - static_cast<double>(startTicks) / sysconf(_SC_CLK_TCK)) * 1000;
+    return age > 0 ? age : 0;
+}
+void StartupTrace::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled = true;
+    origin = Clock::now();
+    processStartOffset = processAge();
+    recorded.assign(1, Mark{"main", processStartOffset});
+}
+bool StartupTrace::isEnabled() const { return enabled; }
+void StartupTrace::mark(std::string_view phase) {
+    if (!enabled) return;
+    double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - origin).count() + processStartOffset;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (at(phase) < 0) recorded.push_back(Mark{std::string(phase), elapsed});
+}
+std::vector<StartupTrace::Mark> StartupTrace::marks() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recorded;
+}
+double StartupTrace::at(std::string_view phase) const {
+    for (const Mark& mark : recorded) {
+        if (mark.phase == phase) return mark.milliseconds;
+    }
+    return -1;
+}
+bool StartupTrace::complete() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return at(FIRST_PAINT) >= 0 && at(INTERACTIVE) >= 0;
+}
+bool StartupTrace::withinBudget() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    double firstPaint = at(FIRST_PAINT), interactive = at(INTERACTIVE);
+    return firstPaint >= 0 && interactive >= 0 && firstPaint <= FIRST_PAINT_BUDGET_MS && interactive <= INTERACTIVE_BUDGET_MS;
+}
+bool StartupTrace::report(std::ostream& out) const {
+    bool ok = withinBudget();
+    std::lock_guard<std::mutex> lock(mutex);
+    out << "phase\tat_ms\tdelta_ms\n" << std::fixed << std::setprecision(1);
+    double previous = 0;
+    for (const Mark& mark : recorded) {
+        out << mark.phase << '\t' << mark.milliseconds << '\t' << mark.milliseconds - previous << '\n';
+        previous = mark.milliseconds;
+    }
+    auto budget = [&](std::string_view phase, double limit) {
+        double value = at(phase);
+        out << phase << " budget\t" << limit << '\t' << (value < 0 ? "missing" : value <= limit ? "ok" : "over") << '\n';
+    };
+    budget(FIRST_PAINT, FIRST_PAINT_BUDGET_MS);
+    budget(INTERACTIVE, INTERACTIVE_BUDGET_MS);
+    return ok;
+}
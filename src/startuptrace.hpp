@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// `alia-can --startup-trace` timeline: named marks relative to process start, printed once the window has both
+// painted and become interactive, together with the two budgets startup is held to. Each phase is recorded at
+// its first occurrence only, so marks can sit in paths that run repeatedly; they are free when tracing is off.
+class StartupTrace {
+public:
+    static constexpr double FIRST_PAINT_BUDGET_MS = 250;
+    static constexpr double INTERACTIVE_BUDGET_MS = 750;
+    static constexpr std::string_view FIRST_PAINT = "first-paint";
+    static constexpr std::string_view INTERACTIVE = "interactive";
+    struct Mark {
+        std::string phase;
+        double milliseconds;
+    };
+    static StartupTrace& instance();
+    static bool consumeFlag(int& argc, char* argv[]);
+    void start();
+    bool isEnabled() const;
+    void mark(std::string_view phase);
+    std::vector<Mark> marks() const;
+    bool complete() const;
+    bool withinBudget() const;
+    bool report(std::ostream& out) const;
+private:
+    using Clock = std::chrono::steady_clock;
+    bool enabled = false;
+    Clock::time_point origin;
+    double processStartOffset = 0;
+    mutable std::mutex mutex;
+    std::vector<Mark> recorded;
+    static double processAge();
+    double at(std::string_view phase) const;
+};
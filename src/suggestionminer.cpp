@@ -0,0 +1,235 @@
+#include "suggestionminer.hpp"
+#include "aliasmanager.hpp"
+#include "mappedfile.hpp"
+#include "threadpool.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <unordered_set>
+#include <sys/stat.h>
+
+SuggestionMiner::SpaceSaving::SpaceSaving(size_t capacity) : limit(std::max<size_t>(capacity, 1)) {
+    entries.reserve(limit);
+    heap.reserve(limit);
+}
+size_t SuggestionMiner::SpaceSaving::size() const { return heap.size(); }
+size_t SuggestionMiner::SpaceSaving::capacity() const { return limit; }
+// What a key that has no counter may have occurred: nothing while counters are free, the smallest count after.
+uint64_t SuggestionMiner::SpaceSaving::minimum() const {
+    return heap.size() < limit ? 0 : heap[0]->second.count;
+}
+void SuggestionMiner::SpaceSaving::place(size_t slot, Map::value_type* entry) {
+    heap[slot] = entry;
+    entry->second.slot = slot;
+}
+void SuggestionMiner::SpaceSaving::siftUp(size_t slot) {
+    while (slot > 0) {
+        size_t parent = (slot - 1) / 2;
+        if (heap[parent]->second.count <= heap[slot]->second.count) break;
+        Map::value_type* moved = heap[parent];
+        place(parent, heap[slot]);
+        place(slot, moved);
+        slot = parent;
+    }
+}
+void SuggestionMiner::SpaceSaving::siftDown(size_t slot) {
+    for (;;) {
+        size_t smallest = slot;
+        for (size_t child = 2 * slot + 1; child <= 2 * slot + 2 && child < heap.size(); ++child) {
+            if (heap[child]->second.count < heap[smallest]->second.count) smallest = child;
+        }
+        if (smallest == slot) return;
+        Map::value_type* moved = heap[smallest];
+        place(smallest, heap[slot]);
+        place(slot, moved);
+        slot = smallest;
+    }
+}
+void SuggestionMiner::SpaceSaving::add(std::string_view key, uint64_t weight) {
+    if (auto it = entries.find(key); it != entries.end()) {
+        it->second.count += weight;
+        siftDown(it->second.slot);
+        return;
+    }
+    if (heap.size() < limit) {
+        heap.push_back(nullptr);
+        place(heap.size() - 1, &*entries.emplace(std::string(key), Entry{weight, 0, 0}).first);
+        siftUp(heap.size() - 1);
+        return;
+    }
+    const uint64_t floor = heap[0]->second.count;
+    entries.erase(entries.find(heap[0]->first));
+    place(0, &*entries.emplace(std::string(key), Entry{floor + weight, floor, 0}).first);
+    siftDown(0);
+}
+// Mergeable summaries (Agarwal et al.): a key missing from one side may have occurred up to that side's
+// minimum there, which is added to both its count and its error; the largest `capacity` counts are kept.
+void SuggestionMiner::SpaceSaving::merge(const SpaceSaving& other) {
+    const uint64_t ownFloor = minimum();
+    const uint64_t otherFloor = other.minimum();
+    std::vector<Counter> merged;
+    merged.reserve(entries.size() + other.entries.size());
+    for (const auto& [key, entry] : entries) {
+        auto it = other.entries.find(key);
+        merged.push_back(Counter{key, entry.count + (it != other.entries.end() ? it->second.count : otherFloor), entry.error + (it != other.entries.end() ? it->second.error : otherFloor)});
+    }
+    for (const auto& [key, entry] : other.entries) {
+        if (!entries.contains(key)) merged.push_back(Counter{key, entry.count + ownFloor, entry.error + ownFloor});
+    }
+    if (merged.size() > limit) {
+        std::nth_element(merged.begin(), merged.begin() + static_cast<std::ptrdiff_t>(limit), merged.end(), [](const Counter& a, const Counter& b) { return a.count > b.count; });
+        merged.resize(limit);
+    }
+    entries.clear();
+    heap.clear();
+    for (auto& counter : merged) {
+        heap.push_back(nullptr);
+        place(heap.size() - 1, &*entries.emplace(std::move(counter.key), Entry{counter.count, counter.error, 0}).first);
+    }
+    for (size_t slot = heap.size() / 2; slot-- > 0;) siftDown(slot);
+}
+std::vector<SuggestionMiner::SpaceSaving::Counter> SuggestionMiner::SpaceSaving::top() const {
+    std::vector<Counter> counters;
+    counters.reserve(heap.size());
+    for (const auto* entry : heap) counters.push_back(Counter{entry->first, entry->second.count, entry->second.error});
+    std::sort(counters.begin(), counters.end(), [](const Counter& a, const Counter& b) { return a.count != b.count ? a.count > b.count : a.key < b.key; });
+    return counters;
+}
+
+SuggestionMiner::SuggestionMiner(ShellDetector::Shell shell) : SuggestionMiner(shell, Options{}) {}
+SuggestionMiner::SuggestionMiner(ShellDetector::Shell shell, Options options) : shell(shell), options(options) {}
+// The leading words of a command as the shell splits them. Stops at an operator, a comment, a command
+// substitution or an unterminated quote, so every prefix built from the result is a complete simple command.
+std::vector<std::string_view> SuggestionMiner::words(std::string_view command, size_t maxWords) {
+    constexpr std::string_view OPERATORS = "|;&<>()";
+    std::vector<std::string_view> result;
+    size_t i = 0;
+    while (result.size() < maxWords) {
+        while (i < command.size() && std::isspace(static_cast<unsigned char>(command[i]))) ++i;
+        if (i >= command.size() || command[i] == '#' || OPERATORS.find(command[i]) != std::string_view::npos) break;
+        const size_t start = i;
+        char quote = 0;
+        for (; i < command.size(); ++i) {
+            const char c = command[i];
+            if (quote != 0) {
+                if (c == quote) quote = 0;
+                else if (c == '\\' && quote == '"' && i + 1 < command.size()) ++i;
+            } else if (c == '\\' && i + 1 < command.size()) {
+                ++i;
+            } else if (c == '$' && i + 1 < command.size() && command[i + 1] == '(') {
+                return result;
+            } else if (c == '\'' || c == '"') {
+                quote = c;
+            } else if (std::isspace(static_cast<unsigned char>(c)) || OPERATORS.find(c) != std::string_view::npos) {
+                break;
+            }
+        }
+        std::string_view word = command.substr(start, i - start);
+        if (quote != 0 || word.find('`') != std::string_view::npos || word.find("$(") != std::string_view::npos) break;
+        result.push_back(word);
+    }
+    return result;
+}
+std::string SuggestionMiner::suggestName(std::string_view command, const std::function<bool(std::string_view)>& taken) {
+    std::string base;
+    std::vector<std::string_view> parts = words(command, SIZE_MAX);
+    for (std::string_view word : parts) {
+        auto letter = std::find_if(word.begin(), word.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)); });
+        if (letter != word.end()) base += static_cast<char>(std::tolower(static_cast<unsigned char>(*letter)));
+    }
+    // A single word gets its first two letters: `kubectl` -> `ku`, as one letter is too easy to mistype into.
+    if (base.size() < 2 && !parts.empty()) {
+        base.clear();
+        for (char c : parts.front()) {
+            if (std::isalnum(static_cast<unsigned char>(c)) && base.size() < 2) base += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    if (base.empty()) base = "a";
+    if (!taken(base)) return base;
+    for (size_t n = 2;; ++n) {
+        std::string name = base + std::to_string(n);
+        if (!taken(name)) return name;
+    }
+}
+// Entries that start with an alias are already abbreviated and add nothing.
+void SuggestionMiner::summarize(std::string_view text, const AliasStore& aliases, SpaceSaving& sketch) const {
+    std::string prefix;
+    HistoryUsage::forEachEntry(text, shell, [&](std::string_view command, int64_t) {
+        std::vector<std::string_view> parts = words(command, options.maxWords);
+        if (parts.empty() || aliases.contains(parts.front())) return;
+        prefix.clear();
+        for (size_t i = 0; i < parts.size(); ++i) {
+            if (i > 0) prefix += ' ';
+            prefix += parts[i];
+            if (prefix.size() >= options.minSaving + 2) sketch.add(prefix);
+        }
+    });
+}
+std::vector<SuggestionMiner::Suggestion> SuggestionMiner::mine(std::string_view history, const AliasStore& aliases, PathIndex& executables) const {
+    TRACE_SCOPE(span, "SuggestionMiner::mine");
+    TRACE_ARG(span, "bytes", history.size());
+    // One sketch per pool thread at most, so memory stays at threads x capacity counters.
+    const size_t parts = std::min(history.size() / HistoryUsage::CHUNK_SIZE + 1, ThreadPool::shared().threadCount());
+    const std::vector<size_t> bounds = HistoryUsage::chunkBounds(history, shell, parts);
+    std::vector<SpaceSaving> sketches;
+    sketches.reserve(parts);
+    for (size_t i = 0; i < parts; ++i) sketches.emplace_back(options.capacity);
+    ThreadPool::shared().parallelFor(parts, [&](size_t i) { summarize(history.substr(bounds[i], bounds[i + 1] - bounds[i]), aliases, sketches[i]); });
+    for (size_t i = 1; i < parts; ++i) sketches[0].merge(sketches[i]);
+
+    std::unordered_set<std::string> existing;
+    for (const auto& alias : aliases) {
+        std::string normalized;
+        for (std::string_view word : words(alias.command, SIZE_MAX)) normalized += (normalized.empty() ? "" : " ") + std::string(word);
+        existing.insert(std::move(normalized));
+    }
+    std::vector<Suggestion> candidates;
+    for (auto& counter : sketches[0].top()) {
+        const uint64_t certain = counter.count - counter.error;
+        if (certain >= options.minCount && !existing.contains(counter.key)) candidates.push_back(Suggestion{{}, std::move(counter.key), certain});
+    }
+    // Roughly the characters saved, before names are known: a name is about one letter per word.
+    auto estimate = [](const Suggestion& s) { return s.count * (s.command.size() - static_cast<size_t>(std::count(s.command.begin(), s.command.end(), ' ')) - 1); };
+    std::stable_sort(candidates.begin(), candidates.end(), [&](const Suggestion& a, const Suggestion& b) { return estimate(a) > estimate(b); });
+
+    std::vector<Suggestion> suggestions;
+    std::unordered_set<std::string> names;
+    auto taken = [&](std::string_view name) {
+        return !AliasManager::validateAliasName(std::string(name)) || aliases.contains(name) || PathIndex::isBuiltin(name) || names.contains(std::string(name)) || !executables.find(name).empty();
+    };
+    // `git log` and `git log --oneline` would share most of their uses; only the better of the two is offered.
+    auto related = [](std::string_view a, std::string_view b) {
+        if (a.size() > b.size()) std::swap(a, b);
+        return b.starts_with(a) && (b.size() == a.size() || b[a.size()] == ' ');
+    };
+    for (auto& candidate : candidates) {
+        if (suggestions.size() >= options.limit) break;
+        if (std::any_of(suggestions.begin(), suggestions.end(), [&](const Suggestion& s) { return related(s.command, candidate.command); })) continue;
+        candidate.name = suggestName(candidate.command, taken);
+        if (candidate.command.size() < candidate.name.size() + options.minSaving) continue;
+        names.insert(candidate.name);
+        suggestions.push_back(std::move(candidate));
+    }
+    TRACE_ARG(span, "suggestions", suggestions.size());
+    return suggestions;
+}
+// A missing history file gives no suggestions rather than an error.
+bool SuggestionMiner::mineFile(const std::string& path, const AliasStore& aliases, PathIndex& executables, std::vector<Suggestion>& suggestions) {
+    suggestions.clear();
+    struct stat sb;
+    if (::stat(path.c_str(), &sb) != 0) {
+        if (errno == ENOENT) return true;
+        lastError = "Cannot stat " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    MappedFile file;
+    if (!file.open(path)) {
+        lastError = file.getLastError();
+        return false;
+    }
+    suggestions = mine(file.view(), aliases, executables);
+    return true;
+}
+std::string SuggestionMiner::getLastError() const { return lastError; }
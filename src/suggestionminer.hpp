@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "aliasstore.hpp"
+#include "historyusage.hpp"
+#include "pathindex.hpp"
+#include "shelldetector.hpp"
+
+// Proposes aliases for commands that are typed often: every history entry contributes its first one to
+// `maxWords` words (whitespace collapsed, never cut inside quotes or past a pipe or `;`), and the prefixes that
+// occur most are counted with Space-Saving, whose memory is fixed by `capacity` however long the history is.
+// Chunks of the history are summarized in parallel and the summaries merged. A suggestion is ranked by the
+// characters it saves over all its uses, and named after the initials of its words (`git log --oneline` ->
+// `glo`), numbered when the name is taken by an alias, a builtin, an executable or another suggestion.
+class SuggestionMiner {
+public:
+    struct Suggestion {
+        std::string name;
+        std::string command;
+        // Occurrences that are certain; the sketch may have seen a few more.
+        uint64_t count = 0;
+    };
+    struct Options {
+        size_t capacity = 4096;
+        size_t limit = 10;
+        uint64_t minCount = 3;
+        size_t minSaving = 4;
+        size_t maxWords = 4;
+    };
+    // Space-Saving (Metwally et al.): `capacity` counters; a key that isn't counted yet takes over the smallest
+    // counter and inherits its count as error. Any key more frequent than total/capacity is guaranteed a counter.
+    class SpaceSaving {
+    public:
+        struct Counter {
+            std::string key;
+            uint64_t count = 0;
+            uint64_t error = 0;
+        };
+        explicit SpaceSaving(size_t capacity);
+        SpaceSaving(const SpaceSaving&) = delete;
+        SpaceSaving& operator=(const SpaceSaving&) = delete;
+        SpaceSaving(SpaceSaving&&) = default;
+        SpaceSaving& operator=(SpaceSaving&&) = default;
+        void add(std::string_view key, uint64_t weight = 1);
+        void merge(const SpaceSaving& other);
+        std::vector<Counter> top() const;
+        size_t size() const;
+        size_t capacity() const;
+    private:
+        struct Entry {
+            uint64_t count;
+            uint64_t error;
+            size_t slot;
+        };
+        using Map = std::unordered_map<std::string, Entry, HistoryUsage::WordHash, std::equal_to<>>;
+        size_t limit;
+        Map entries;
+        // Min-heap on count; map nodes don't move, so the heap can point into the map.
+        std::vector<Map::value_type*> heap;
+        uint64_t minimum() const;
+        void place(size_t slot, Map::value_type* entry);
+        void siftUp(size_t slot);
+        void siftDown(size_t slot);
+    };
+    explicit SuggestionMiner(ShellDetector::Shell shell);
+    SuggestionMiner(ShellDetector::Shell shell, Options options);
+    static std::vector<std::string_view> words(std::string_view command, size_t maxWords);
+    static std::string suggestName(std::string_view command, const std::function<bool(std::string_view)>& taken);
+    std::vector<Suggestion> mine(std::string_view history, const AliasStore& aliases, PathIndex& executables) const;
+    bool mineFile(const std::string& path, const AliasStore& aliases, PathIndex& executables, std::vector<Suggestion>& suggestions);
+    std::string getLastError() const;
+private:
+    ShellDetector::Shell shell;
+    Options options;
+    std::string lastError;
+    void summarize(std::string_view text, const AliasStore& aliases, SpaceSaving& sketch) const;
+};
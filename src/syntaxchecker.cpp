@@ -0,0 +1,257 @@
+#include "syntaxchecker.hpp"
+#include "threadpool.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <fcntl.h>
+#include <poll.h>
+#include <random>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+extern char** environ;
+
+// Runs in the coprocess. Each request is one line: a tag, a space, and the text with every byte outside printable
+// ASCII (and every backslash) written as a `\0NNN` escape, which `printf %b` turns back into the original text. The
+// subshell of the command substitution takes the `set -n`, so the coprocess itself keeps executing; the reply is
+// the tag, the exit status and the shell's messages on one line.
+static constexpr const char* LOOP =
+    "while IFS= read -r line; do\n"
+    "  tag=${line%% *}\n"
+    "  printf -v text '%b' \"${line#* }\"\n"
+    "  err=$( { eval $'set -n\\n'\"$text\"; } 2>&1 )\n"
+    "  printf '%s %d %s\\n' \"$tag\" \"$?\" \"${err//$'\\n'/$'\\t'}\"\n"
+    "done\n";
+
+static std::string shellProgram(ShellDetector::Shell shell) {
+    return shell == ShellDetector::Shell::ZSH ? "zsh" : "bash";
+}
+
+SyntaxChecker::SyntaxChecker(ShellDetector::Shell shell, std::string program, size_t maxProcesses)
+    : formatter(shell), program(std::move(program)), maxProcesses(maxProcesses) {
+    if (this->program.empty() && isSupported()) this->program = shellProgram(shell);
+    if (this->maxProcesses == 0) this->maxProcesses = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 4);
+}
+SyntaxChecker::~SyntaxChecker() {
+    for (auto& process : idle) stop(*process);
+}
+SyntaxChecker& SyntaxChecker::forShell(ShellDetector::Shell shell) {
+    static SyntaxChecker bash(ShellDetector::Shell::BASH);
+    static SyntaxChecker zsh(ShellDetector::Shell::ZSH);
+    static SyntaxChecker fish(ShellDetector::Shell::FISH);
+    if (shell == ShellDetector::Shell::ZSH) return zsh;
+    return shell == ShellDetector::Shell::FISH ? fish : bash;
+}
+// fish has `--no-execute`, but only for a whole process, which is what the coprocess is there to avoid.
+bool SyntaxChecker::isSupported() const {
+    return formatter.getShell() == ShellDetector::Shell::BASH || formatter.getShell() == ShellDetector::Shell::ZSH;
+}
+// Starts a coprocess ahead of the first keystroke, so that keystroke does not also pay for the shell's startup.
+void SyntaxChecker::warmUp() {
+    if (isSupported()) release(acquire());
+}
+size_t SyntaxChecker::processCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+// Without a deadline this waits as long as it takes for a coprocess; with one it gives up at the deadline, so a
+// keystroke never queues behind a checkAll() that holds every coprocess.
+std::unique_ptr<SyntaxChecker::Process> SyntaxChecker::acquire(std::optional<std::chrono::steady_clock::time_point> deadline) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto ready = [this]() { return unavailable || !idle.empty() || running < maxProcesses; };
+    if (!deadline) released.wait(lock, ready);
+    else if (!released.wait_until(lock, *deadline, ready)) return nullptr;
+    if (unavailable) return nullptr;
+    if (!idle.empty()) {
+        std::unique_ptr<Process> process = std::move(idle.back());
+        idle.pop_back();
+        return process;
+    }
+    ++running;
+    lock.unlock();
+    std::unique_ptr<Process> process = spawn();
+    if (process == nullptr) {
+        lock.lock();
+        --running;
+        unavailable = true;
+        released.notify_all();
+    }
+    return process;
+}
+// A process that timed out or died has been stopped already and only gives its slot back.
+void SyntaxChecker::release(std::unique_ptr<Process> process) {
+    if (process == nullptr) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (process->fd >= 0) idle.push_back(std::move(process));
+    else --running;
+    released.notify_one();
+}
+std::unique_ptr<SyntaxChecker::Process> SyntaxChecker::spawn() {
+    TRACE_SCOPE(span, "SyntaxChecker::spawn");
+    int sockets[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0) return nullptr;
+    // Byte semantics for `read` and `printf %b` whatever the user's locale is. Nothing may run before the loop:
+    // a non-interactive shell still sources $BASH_ENV (or $ENV) and imports exported functions.
+    std::vector<std::string> environment;
+    for (char** entry = environ; *entry != nullptr; ++entry) {
+        std::string_view variable(*entry);
+        if (variable.starts_with("LC_ALL=") || variable.starts_with("BASH_ENV=") || variable.starts_with("ENV=") || variable.starts_with("BASH_FUNC_")) continue;
+        environment.emplace_back(variable);
+    }
+    environment.emplace_back("LC_ALL=C");
+    std::vector<char*> envp;
+    for (auto& entry : environment) envp.push_back(entry.data());
+    envp.push_back(nullptr);
+    std::vector<std::string> arguments{shellProgram(formatter.getShell())};
+    if (formatter.getShell() == ShellDetector::Shell::BASH) arguments.insert(arguments.end(), {"--norc", "--noprofile"});
+    else arguments.emplace_back("-f");
+    arguments.insert(arguments.end(), {"-c", LOOP});
+    std::vector<char*> argv;
+    for (auto& argument : arguments) argv.push_back(argument.data());
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, sockets[1], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, sockets[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    pid_t pid = -1;
+    int error = posix_spawnp(&pid, program.c_str(), &actions, nullptr, argv.data(), envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(sockets[1]);
+    if (error != 0) {
+        ::close(sockets[0]);
+        return nullptr;
+    }
+    auto process = std::make_unique<Process>();
+    process->pid = pid;
+    process->fd = sockets[0];
+    std::random_device random;
+    process->tag = std::to_string(random()) + std::to_string(random());
+    return process;
+}
+void SyntaxChecker::stop(Process& process) {
+    if (process.fd >= 0) ::close(process.fd);
+    if (process.pid > 0) {
+        ::kill(process.pid, SIGKILL);
+        while (::waitpid(process.pid, nullptr, 0) < 0 && errno == EINTR) {}
+    }
+    process.fd = -1;
+    process.pid = -1;
+}
+std::string SyntaxChecker::encode(std::string_view text) {
+    std::string encoded;
+    encoded.reserve(text.size() + 16);
+    for (unsigned char c : text) {
+        if (c >= 0x20 && c < 0x7f && c != '\\') {
+            encoded += static_cast<char>(c);
+            continue;
+        }
+        const char escape[] = {'\\', '0', static_cast<char>('0' + (c >> 6)), static_cast<char>('0' + ((c >> 3) & 7)), static_cast<char>('0' + (c & 7))};
+        encoded.append(escape, sizeof(escape));
+    }
+    encoded += '\n';
+    return encoded;
+}
+// "bash: eval: line 7: syntax error: unexpected end of file" -> "syntax error: unexpected end of file". Line
+// numbers count the coprocess's own script, so they would only mislead. Only the first message is kept.
+std::string SyntaxChecker::cleanMessage(std::string_view message) {
+    message = message.substr(0, message.find('\t'));
+    for (size_t colon; (colon = message.find(": ")) != std::string_view::npos;) {
+        std::string_view prefix = message.substr(0, colon);
+        bool lineNumber = prefix.starts_with("line ") && prefix.size() > 5 && std::all_of(prefix.begin() + 5, prefix.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+        if (prefix != "bash" && prefix != "zsh" && prefix != "eval" && !prefix.starts_with("(eval):") && !lineNumber) break;
+        message.remove_prefix(colon + 2);
+    }
+    return message.empty() ? "syntax error" : std::string(message);
+}
+// Replies carry the request's tag, so anything else the shell prints (a system-wide zshenv, say) is skipped rather
+// than taken for the answer.
+SyntaxChecker::Result SyntaxChecker::run(Process& process, const Alias& alias, std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    const std::string tag = process.tag + "." + std::to_string(++process.requests) + " ";
+    std::string request = tag + encode(formatter.formatAlias(alias) + "\n" + alias.command);
+    for (size_t written = 0; written < request.size();) {
+        ssize_t n = ::send(process.fd, request.data() + written, request.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            stop(process);
+            return Result{Verdict::UNKNOWN, "syntax check failed: the shell exited"};
+        }
+        written += static_cast<size_t>(n);
+    }
+    process.buffer.clear();
+    size_t start = std::string::npos;
+    for (;;) {
+        size_t newline;
+        while ((newline = process.buffer.find('\n')) != std::string::npos) {
+            start = process.buffer.find(tag);
+            if (start < newline) break;
+            process.buffer.erase(0, newline + 1);
+            start = std::string::npos;
+        }
+        if (start != std::string::npos) break;
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        pollfd pfd{process.fd, POLLIN, 0};
+        int ready = left.count() > 0 ? ::poll(&pfd, 1, static_cast<int>(left.count())) : 0;
+        if (ready < 0 && errno == EINTR) continue;
+        char chunk[4096];
+        ssize_t n = ready > 0 ? ::read(process.fd, chunk, sizeof(chunk)) : -1;
+        if (n <= 0) {
+            // The reply may still come, and would then answer the next request; a fresh process is cheaper.
+            stop(process);
+            return Result{Verdict::UNKNOWN, ready == 0 ? "syntax check timed out" : "syntax check failed: the shell exited"};
+        }
+        process.buffer.append(chunk, static_cast<size_t>(n));
+    }
+    std::string_view reply(process.buffer);
+    reply = reply.substr(start + tag.size(), reply.find('\n') - start - tag.size());
+    size_t space = reply.find(' ');
+    if (reply.substr(0, space) == "0") return Result{Verdict::VALID, {}};
+    return Result{Verdict::INVALID, cleanMessage(space == std::string_view::npos ? std::string_view() : reply.substr(space + 1))};
+}
+SyntaxChecker::Result SyntaxChecker::check(const Alias& alias, std::chrono::milliseconds timeout) {
+    TRACE_SCOPE(span, "SyntaxChecker::check");
+    if (!isSupported()) return Result{};
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_ptr<Process> process = acquire(deadline);
+    if (process == nullptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return Result{Verdict::UNKNOWN, unavailable ? program + " is not available" : "syntax check timed out"};
+    }
+    Result result = run(*process, alias, std::max(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()), std::chrono::milliseconds(0)));
+    release(std::move(process));
+    return result;
+}
+// One task per coprocess, each taking every n-th alias, so no pool thread ever waits for a free coprocess that
+// another task of the same call holds.
+std::vector<SyntaxChecker::Result> SyntaxChecker::checkAll(const std::vector<Alias>& aliases, std::chrono::milliseconds timeout) {
+    TRACE_SCOPE(span, "SyntaxChecker::checkAll");
+    TRACE_ARG(span, "aliases", aliases.size());
+    std::vector<Result> results(aliases.size());
+    if (!isSupported() || aliases.empty()) return results;
+    const size_t tasks = std::min(aliases.size(), maxProcesses);
+    ThreadPool::shared().parallelFor(tasks, [&](size_t task) {
+        std::unique_ptr<Process> process = acquire();
+        for (size_t i = task; i < aliases.size() && process != nullptr; i += tasks) {
+            results[i] = run(*process, aliases[i], timeout);
+            if (process->fd < 0) {
+                release(std::move(process));
+                process = acquire();
+            }
+        }
+        release(std::move(process));
+    });
+    for (auto& result : results) {
+        if (result.verdict == Verdict::UNKNOWN && result.message.empty()) result.message = program + " is not available";
+    }
+    return results;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "aliasmanager.hpp"
+#include "shelldetector.hpp"
+
+// Asks the target shell itself whether an alias parses: the formatted `alias` line followed by the command as it
+// will be expanded. Each check is one line written to a long-lived `bash`/`zsh` coprocess, which evaluates it
+// after `set -n` in a subshell of its own, so nothing in the text ever runs and no program is started per check.
+// Up to `maxProcesses` coprocesses are kept per checker so checkAll() can spread an import over them.
+// A shell that is missing, too slow or has no parse-only mode (fish) gives UNKNOWN, never INVALID.
+class SyntaxChecker {
+public:
+    enum class Verdict { VALID, INVALID, UNKNOWN };
+    struct Result {
+        Verdict verdict = Verdict::UNKNOWN;
+        std::string message;
+    };
+    // A keystroke has to get its verdict within a frame; bulk checks can afford to wait for a loaded machine.
+    static constexpr std::chrono::milliseconds KEYSTROKE_TIMEOUT{16};
+    static constexpr std::chrono::milliseconds BULK_TIMEOUT{1000};
+    explicit SyntaxChecker(ShellDetector::Shell shell, std::string program = "", size_t maxProcesses = 0);
+    ~SyntaxChecker();
+    SyntaxChecker(const SyntaxChecker&) = delete;
+    SyntaxChecker& operator=(const SyntaxChecker&) = delete;
+    static SyntaxChecker& forShell(ShellDetector::Shell shell);
+    bool isSupported() const;
+    void warmUp();
+    Result check(const Alias& alias, std::chrono::milliseconds timeout = KEYSTROKE_TIMEOUT);
+    std::vector<Result> checkAll(const std::vector<Alias>& aliases, std::chrono::milliseconds timeout = BULK_TIMEOUT);
+    size_t processCount();
+    static std::string encode(std::string_view text);
+    static std::string cleanMessage(std::string_view message);
+private:
+    struct Process {
+        int pid = -1;
+        int fd = -1;
+        std::string tag;
+        uint64_t requests = 0;
+        std::string buffer;
+    };
+    AliasManager formatter;
+    std::string program;
+    size_t maxProcesses;
+    std::mutex mutex;
+    std::condition_variable released;
+    std::vector<std::unique_ptr<Process>> idle;
+    size_t running = 0;
+    bool unavailable = false;
+    std::unique_ptr<Process> acquire(std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt);
+    void release(std::unique_ptr<Process> process);
+    std::unique_ptr<Process> spawn();
+    static void stop(Process& process);
+    Result run(Process& process, const Alias& alias, std::chrono::milliseconds timeout);
+};
@@ -0,0 +1,81 @@
+#include "threadpool.hpp"
+#include <algorithm>
+#include <chrono>
+
+static thread_local size_t currentWorker = SIZE_MAX;
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < threadCount; ++i) queues.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < threadCount; ++i) threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(signalMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& thread : threads) thread.join();
+}
+size_t ThreadPool::threadCount() const { return threads.size(); }
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+void ThreadPool::push(Task task) {
+    size_t index = currentWorker < queues.size() ? currentWorker : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    queuedTasks.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(signalMutex);
+    }
+    workAvailable.notify_one();
+}
+bool ThreadPool::tryRunOne(size_t preferredQueue) {
+    Task task{};
+    bool found = false;
+    for (size_t attempt = 0; attempt < queues.size() && !found; ++attempt) {
+        Queue& queue = *queues[(preferredQueue + attempt) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        if (attempt == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        found = true;
+    }
+    if (!found) return false;
+    queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    task.run();
+    if (task.batch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(signalMutex);
+        batchFinished.notify_all();
+    }
+    return true;
+}
+void ThreadPool::workerLoop(size_t index) {
+    currentWorker = index;
+    while (true) {
+        if (tryRunOne(index)) continue;
+        std::unique_lock<std::mutex> lock(signalMutex);
+        workAvailable.wait(lock, [this] { return stopping || queuedTasks.load(std::memory_order_acquire) > 0; });
+        if (stopping && queuedTasks.load(std::memory_order_acquire) == 0) return;
+    }
+}
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+    Batch batch{count};
+    for (size_t i = 0; i < count; ++i) push(Task{[&body, i] { body(i); }, &batch});
+    size_t preferred = currentWorker < queues.size() ? currentWorker : 0;
+    while (batch.remaining.load(std::memory_order_acquire) > 0) {
+        if (tryRunOne(preferred)) continue;
+        std::unique_lock<std::mutex> lock(signalMutex);
+        batchFinished.wait_for(lock, std::chrono::milliseconds(1), [&batch] { return batch.remaining.load(std::memory_order_acquire) == 0; });
+    }
+}
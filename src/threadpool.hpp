@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+    size_t threadCount() const;
+    static ThreadPool& shared();
+private:
+    struct Batch {
+        std::atomic<size_t> remaining;
+    };
+    struct Task {
+        std::function<void()> run;
+        Batch* batch;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queuedTasks{0};
+    std::atomic<size_t> nextQueue{0};
+    std::mutex signalMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable batchFinished;
+    bool stopping = false;
+    void push(Task task);
+    bool tryRunOne(size_t preferredQueue);
+    void workerLoop(size_t index);
+};
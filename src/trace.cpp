@@ -0,0 +1,133 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <unistd.h>
+
+Trace& Trace::instance() {
+    static Trace trace;
+    return trace;
+}
+uint64_t Trace::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+// Small sequential ids read better in trace viewers than pthread handles.
+uint32_t Trace::threadId() {
+    static std::atomic<uint32_t> next{1};
+    thread_local const uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+// Removes `--trace FILE` (or `--trace=FILE`) from the arguments and returns FILE, or "" if absent.
+std::string Trace::consumeFlag(int& argc, char* argv[]) {
+    std::string path;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) path = argv[++i];
+        else if (std::strncmp(argv[i], "--trace=", 8) == 0) path = argv[i] + 8;
+        else argv[kept++] = argv[i];
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    return path;
+}
+// Slot n holds event n (mod CAPACITY); its sequence is odd while being written and 2n + 2 once event n is in it.
+// A writer only takes a slot that is idle and holds an older event, so no two ever write one slot at once; an
+// event whose slot was lapped by a writer CAPACITY events later, or is still being written, is dropped.
+void Trace::record(const Event& event) {
+    const uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index % CAPACITY];
+    uint64_t current = slot.sequence.load(std::memory_order_relaxed);
+    do {
+        if ((current & 1) != 0 || current > 2 * index) return;
+    } while (!slot.sequence.compare_exchange_weak(current, 2 * index + 1, std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(event.name, std::memory_order_relaxed);
+    slot.start.store(event.start, std::memory_order_relaxed);
+    slot.duration.store(event.duration, std::memory_order_relaxed);
+    slot.thread.store(event.thread, std::memory_order_relaxed);
+    slot.argName.store(event.argName, std::memory_order_relaxed);
+    slot.argValue.store(event.argValue, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+std::vector<Trace::Event> Trace::snapshot() const {
+    const uint64_t end = head.load(std::memory_order_acquire);
+    const uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+    std::vector<Event> events;
+    events.reserve(end - begin);
+    for (uint64_t index = begin; index < end; ++index) {
+        const Slot& slot = slots[index % CAPACITY];
+        const uint64_t expected = 2 * index + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected) continue;
+        Event event{slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed), slot.duration.load(std::memory_order_relaxed), slot.thread.load(std::memory_order_relaxed), slot.argName.load(std::memory_order_relaxed), slot.argValue.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == expected && event.name != nullptr) events.push_back(event);
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.start < b.start; });
+    return events;
+}
+// Per span name, most frequent first; `lastMs` is the most recent completed span.
+std::vector<Trace::Summary> Trace::summarize() const {
+    std::map<std::string, Summary> byName;
+    std::map<std::string, uint64_t> lastEnd;
+    for (const Event& event : snapshot()) {
+        Summary& summary = byName[event.name];
+        double ms = event.duration / 1e6;
+        summary.name = event.name;
+        summary.meanMs += (ms - summary.meanMs) / static_cast<double>(++summary.count);
+        summary.maxMs = std::max(summary.maxMs, ms);
+        if (uint64_t end = event.start + event.duration; end >= lastEnd[event.name]) {
+            lastEnd[event.name] = end;
+            summary.lastMs = ms;
+        }
+    }
+    std::vector<Summary> summaries;
+    for (auto& [name, summary] : byName) summaries.push_back(std::move(summary));
+    std::stable_sort(summaries.begin(), summaries.end(), [](const Summary& a, const Summary& b) { return a.count > b.count; });
+    return summaries;
+}
+static void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') out << '\\' << *c;
+        else if (static_cast<unsigned char>(*c) >= 0x20) out << *c;
+    }
+    out << '"';
+}
+// Chrome's trace-event format ("X" complete events, microseconds), loadable in about:tracing and Perfetto.
+void Trace::writeChromeTrace(std::ostream& out) const {
+    const std::vector<Event> events = snapshot();
+    const uint64_t origin = events.empty() ? 0 : events.front().start;
+    const long pid = static_cast<long>(getpid());
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& event = events[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(out, event.name);
+        out << ",\"cat\":\"alia-can\",\"ph\":\"X\",\"ts\":" << (event.start - origin) / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << ",\"pid\":" << pid << ",\"tid\":" << event.thread;
+        if (event.argName != nullptr) {
+            out << ",\"args\":{";
+            writeJsonString(out, event.argName);
+            out << ':' << event.argValue << '}';
+        }
+        out << '}';
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+bool Trace::writeChromeTrace(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) return false;
+    writeChromeTrace(out);
+    return static_cast<bool>(out);
+}
+// Only for tests: must not race with record().
+void Trace::clear() {
+    for (Slot& slot : slots) slot.sequence.store(0, std::memory_order_relaxed);
+    head.store(0, std::memory_order_release);
+}
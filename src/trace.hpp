@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifndef ALIACAN_TRACING
+#define ALIACAN_TRACING 1
+#endif
+
+// Completed spans of the last CAPACITY timed operations, from any thread. Recording claims a slot with one
+// atomic increment and publishes it through a per-slot sequence number, so writers never wait on each other or
+// on a reader; a reader skips slots that are mid-write or were overwritten while it copied them. Under extreme
+// contention a span can be dropped, never torn. Span names and
+// argument keys must be string literals: only the pointer is stored.
+// Build with -DALIACAN_TRACING=0 and the TRACE_* macros compile to nothing.
+class Trace {
+public:
+    struct Event {
+        const char* name = nullptr;
+        uint64_t start = 0;
+        uint64_t duration = 0;
+        uint32_t thread = 0;
+        const char* argName = nullptr;
+        uint64_t argValue = 0;
+    };
+    struct Summary {
+        std::string name;
+        size_t count = 0;
+        double lastMs = 0;
+        double meanMs = 0;
+        double maxMs = 0;
+    };
+    static constexpr size_t CAPACITY = 4096;
+    static Trace& instance();
+    static uint64_t now();
+    static uint32_t threadId();
+    static std::string consumeFlag(int& argc, char* argv[]);
+    void record(const Event& event);
+    std::vector<Event> snapshot() const;
+    std::vector<Summary> summarize() const;
+    void writeChromeTrace(std::ostream& out) const;
+    bool writeChromeTrace(const std::string& path) const;
+    void clear();
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> duration{0};
+        std::atomic<uint32_t> thread{0};
+        std::atomic<const char*> argName{nullptr};
+        std::atomic<uint64_t> argValue{0};
+    };
+    Slot slots[CAPACITY];
+    std::atomic<uint64_t> head{0};
+};
+
+// Records the enclosing scope as one span when it ends.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name) { event.name = name; event.start = Trace::now(); }
+    ~TraceSpan() {
+        event.duration = Trace::now() - event.start;
+        event.thread = Trace::threadId();
+        Trace::instance().record(event);
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    void arg(const char* name, uint64_t value) { event.argName = name; event.argValue = value; }
+private:
+    Trace::Event event;
+};
+
+#if ALIACAN_TRACING
+#define TRACE_SCOPE(span, name) TraceSpan span(name)
+#define TRACE_ARG(span, key, value) span.arg(key, static_cast<uint64_t>(value))
+#else
+#define TRACE_SCOPE(span, name) ((void)0)
+#define TRACE_ARG(span, key, value) ((void)0)
+#endif
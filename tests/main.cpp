@@ -1,2 +1,4 @@
+#include <cstdlib>
 #include <iostream>
-void test_shelldetector(); void test_aliasmanager(); void test_confighandler(); int main(){test_shelldetector();test_aliasmanager();test_confighandler();return 0;}
+#include <string>
+void test_shelldetector(); void test_aliasmanager(); void test_aliasstore(); void test_aliassearch(); void test_confighandler(); void test_cli(); void test_fleet(); void test_fish(); void test_sourcegraph(); void test_startup(); void test_trace(); void test_pathindex(); void test_syntaxchecker(); void test_historyusage(); void test_suggestionminer(); int main(){const char* tmp=getenv("TMPDIR");setenv("XDG_CACHE_HOME",(std::string(tmp?tmp:"/tmp")+"/alia-can-test-cache").c_str(),1);test_shelldetector();test_aliasmanager();test_aliasstore();test_aliassearch();test_confighandler();test_cli();test_fleet();test_fish();test_sourcegraph();test_startup();test_trace();test_pathindex();test_syntaxchecker();test_historyusage();test_suggestionminer();return 0;}
@@ -1,10 +1,17 @@
 #include "aliasmanager.hpp"
+#include "aliasscanner.hpp"
 #include "shelldetector.hpp"
 #include <cassert>
 #include <iostream>
+#include <sstream>
 static void testValidateAliasName(){assert(AliasManager::validateAliasName("ll"));assert(AliasManager::validateAliasName("git_log"));assert(!AliasManager::validateAliasName(""));assert(!AliasManager::validateAliasName("with space"));}
 static void testValidateCommand(){assert(AliasManager::validateCommand("ls -la"));assert(!AliasManager::validateCommand(""));}
 static void testFormatAlias(){AliasManager m(ShellDetector::Shell::BASH);Alias a{"ll","ls -la"};auto f=m.formatAlias(a);assert(f.find("alias ll")!=std::string::npos);}
 static void testParseAliasLine(){auto a=AliasManager::parseAliasLine("alias ll='ls -la'");assert(a.name=="ll");assert(a.command=="ls -la");}
 static void testIsAliasLine(){assert(AliasManager::isAliasLine("alias ll='ls'"));assert(!AliasManager::isAliasLine("export X=1"));}
-void test_aliasmanager(){std::cout<<"Running AliasManager tests...\n";testValidateAliasName();testValidateCommand();testFormatAlias();testParseAliasLine();testIsAliasLine();std::cout<<"✓ AliasManager tests passed!\n";}
+static void testScannerMatchesLineParser(){std::string buf="# header alias x='no'\nalias ll='ls -la'\n  alias gs=\"git status\" # c\nexport alias=1\n\talias  la = ls -A # list\nxalias bad='1'\nalias noeq\nalias ='x'\nalias q='unterminated\r\nalias tail=last";std::vector<Alias> expected;std::istringstream in(buf);std::string line;while(std::getline(in,line))if(AliasManager::isAliasLine(line)){auto a=AliasManager::parseAliasLine(line);if(!a.name.empty())expected.push_back(a);}assert(AliasScanner::scanAll(buf)==expected);assert(expected.size()==4);std::vector<size_t> lines;AliasScanner::scan(buf,[&](const ScannedAlias& s){lines.push_back(s.line);assert(buf.compare(s.offset,5,"alias")==0||buf[s.offset]==' '||buf[s.offset]=='\t');});assert((lines==std::vector<size_t>{2,3,9,10}));assert(AliasScanner::scanAll("").empty());}
+static void testShellQuoting(){auto p=[](std::string_view l){return AliasManager::parseAliasLine(l);};assert(p("alias x='it'\\''s'").command=="it's");assert(p("alias a=\"echo \\\"hi\\\"\"").command=="echo \"hi\"");assert(p("alias a=\"$HOME \\$x \\q\"").command=="$HOME $x \\q");assert(p("alias t=$'tab\\there\\x41\\101\\'q'").command=="tab\there" "AA'q");assert(p("alias u=$'\\u00e9'").command=="\xc3\xa9");assert(p("alias p=a\\ b'c'\"d\"").command=="a bcd");assert(p("alias h=b#c # comment").command=="b#c");assert(p("alias -g -- G='| grep'").name=="G");assert(p("alias 'q=quoted whole'").command=="quoted whole");assert(p("alias e=").name=="e"&&p("alias e=").command.empty());assert(p("aliases_dir=/tmp").name.empty());assert(!AliasManager::isAliasLine("aliases_dir=/tmp"));assert(AliasManager::isAliasLine("  alias\tx=1"));assert(p("alias ll").name.empty());}
+static void testMultipleDefinitionsAndContinuations(){std::string buf="alias a=b c='d e' f # tail\nalias x='line one\nline two' \\\n  y=z; echo alias no=1\nalias k=v\r\n";std::vector<ScannedAlias> s;std::vector<Alias> v;AliasScanner::scan(buf,[&](const ScannedAlias& a){s.push_back(a);v.push_back(a.alias.materialize());});assert((v==std::vector<Alias>{{"a","b"},{"c","d e"},{"x","line one\nline two"},{"y","z"},{"k","v"}}));assert(s[0].offset==s[1].offset&&s[0].length==27&&buf.substr(s[1].definitionOffset,s[1].definitionLength)=="c='d e'");assert(s[2].line==2&&s[3].line==2&&s[4].line==5);assert(buf.substr(s[3].offset,s[3].length).ends_with("y=z"));assert(buf.substr(s[0].offset,s[0].prefixLength)=="alias ");}
+static void testFormatRoundTrip(){AliasManager m(ShellDetector::Shell::BASH);for(std::string c:{"ls -la","echo 'hi'","it's \"$HOME\"","a\\b'c","multi\nline","tab\tend","'","\"","$(date) `x` !!",""}){std::string line=m.formatAlias({"n",c});Alias a=AliasManager::parseAliasLine(line);assert(a.name=="n"&&a.command==c);assert(AliasManager::unescapeString(AliasManager::escapeCommand(c))==c);assert(AliasScanner::scanAll(line+"\n")==std::vector<Alias>{a});}assert(m.formatAlias({"ll","ls -la"})=="alias ll='ls -la'");assert(m.formatAlias({"x","echo 'hi'"})=="alias x=\"echo 'hi'\"");assert(AliasManager::extractQuotedString("x='a'\\''b' rest",2)=="a'b");}
+static void testScanManyStatements(){std::string buf;for(int i=0;i<100000;++i)buf+="alias a"+std::to_string(i)+"='ls -la --color=auto /srv/"+std::to_string(i)+"' # n\n";size_t n=AliasScanner::scan(buf,[](const ScannedAlias&){});assert(n==100000);}
+void test_aliasmanager(){std::cout<<"Running AliasManager tests...\n";testValidateAliasName();testValidateCommand();testFormatAlias();testParseAliasLine();testIsAliasLine();testScannerMatchesLineParser();testShellQuoting();testMultipleDefinitionsAndContinuations();testFormatRoundTrip();testScanManyStatements();std::cout<<"✓ AliasManager tests passed!\n";}
@@ -0,0 +1,9 @@
+#include "aliassearch.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+static std::vector<size_t> rowIds(const AliasStore& s){std::vector<size_t> ids;for(const auto& r:s)ids.push_back(r.id);return ids;}
+static void testScore(){assert(AliasSearch::score("git status","gst")>0);assert(AliasSearch::score("git status","xyz")==-1);assert(AliasSearch::score("git status","")==0);assert(AliasSearch::score("git status","gs")<AliasSearch::score("git status","git"));assert(AliasSearch::score("gitstatus","st")<AliasSearch::score("git status","st"));assert(AliasSearch::score("a-b-c ab","ab")>AliasSearch::score("a-b-c","ab"));}
+static void testModesAndRanking(){AliasStore s;s.insert("gs","git status");s.insert("ll","ls -la");s.insert("gst","git stash");s.insert("status","systemctl status");AliasSearch index;index.build(s,rowIds(s));assert(index.size()==4);auto all=index.search("",AliasSearch::Mode::ALL);assert(all.matches.size()==4);auto r=index.search("GST",AliasSearch::Mode::ALL);assert(!r.matches.empty()&&r.matches[0].row==2);auto names=index.search("status",AliasSearch::Mode::NAME);assert(names.matches.size()==1&&names.matches[0].row==3);auto commands=index.search("status",AliasSearch::Mode::COMMAND);assert(commands.matches.size()==2&&commands.matches[0].row==0&&commands.matches[1].row==3);assert(index.search("zzz",AliasSearch::Mode::ALL).matches.empty());}
+static void testIncrementalNarrowing(){AliasStore s;for(int i=0;i<100000;++i)s.insert("a"+std::to_string(i),"cmd --flag="+std::to_string(i*7));AliasSearch index;index.build(s,rowIds(s));auto r1=index.search("a1",AliasSearch::Mode::ALL);auto r2=index.search("a12",AliasSearch::Mode::ALL,&r1);auto r3=index.search("a123",AliasSearch::Mode::ALL,&r2);auto full=index.search("a123",AliasSearch::Mode::ALL);assert(r3.matches.size()==full.matches.size());for(size_t i=0;i<full.matches.size();++i)assert(r3.matches[i].row==full.matches[i].row&&r3.matches[i].score==full.matches[i].score);assert(r2.matches.size()<=r1.matches.size());auto other=index.search("a1234",AliasSearch::Mode::NAME,&r3);assert(other.mode==AliasSearch::Mode::NAME);AliasSearch rebuilt;rebuilt.build(s,{0,1});assert(rebuilt.search("a12",AliasSearch::Mode::ALL,&r1).matches.size()<=2);}
+void test_aliassearch(){std::cout<<"Running AliasSearch tests...\n";testScore();testModesAndRanking();testIncrementalNarrowing();std::cout<<"✓ AliasSearch tests passed!\n";}
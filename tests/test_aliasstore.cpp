@@ -0,0 +1,10 @@
+#include "aliasstore.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+static void testInsertAndFind(){AliasStore s;s.insert("ll","ls -la",3);s.insert("gs","git status",7);assert(s.size()==2);size_t id=s.find("gs");assert(id!=AliasStore::npos);assert(s.command(id)=="git status");assert(s.line(id)==7);assert(!s.contains("nope"));}
+static void testDuplicateKeepsLastDefinition(){AliasStore s;size_t a=s.insert("ll","ls",1);size_t b=s.insert("ll","ls -la",9);assert(a==b);assert(s.size()==1);assert(s.command(a)=="ls -la");assert(s.line(a)==9);}
+static void testUpdateAndRemove(){AliasStore s;s.insert("ll","ls");s.insert("gs","git status");assert(s.update("ll","ls -la"));assert(!s.update("x","y"));assert(s.command(s.find("ll"))=="ls -la");assert(s.remove("ll"));assert(!s.remove("ll"));assert(s.size()==1);assert(!s.contains("ll"));s.insert("ll","ls -A");assert(s.command(s.find("ll"))=="ls -A");}
+static void testIterationOrderSkipsRemoved(){AliasStore s;s.insert("a","1");s.insert("b","2");s.insert("c","3");s.remove("b");std::string names;for(const auto& r:s)names+=r.name;assert(names=="ac");assert((s.toVector()==std::vector<Alias>{{"a","1"},{"c","3"}}));}
+static void testManyAliases(){AliasStore s;s.reserve(100000,2000000);for(int i=0;i<100000;++i)s.insert("a"+std::to_string(i),"cmd "+std::to_string(i),i);for(int i=0;i<100000;i+=2)assert(s.remove("a"+std::to_string(i)));for(int i=0;i<100000;++i)s.update("a"+std::to_string(i),"new");assert(s.size()==50000);for(int i=1;i<100000;i+=2){size_t id=s.find("a"+std::to_string(i));assert(id!=AliasStore::npos&&s.command(id)=="new"&&s.line(id)==(size_t)i);}assert(!s.contains("a0"));}
+void test_aliasstore(){std::cout<<"Running AliasStore tests...\n";testInsertAndFind();testDuplicateKeepsLastDefinition();testUpdateAndRemove();testIterationOrderSkipsRemoved();testManyAliases();std::cout<<"✓ AliasStore tests passed!\n";}
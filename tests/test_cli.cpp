@@ -0,0 +1,20 @@
+#include "cli.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+namespace fs=std::filesystem;
+static std::string cliTestFile(){char* d=getenv("TMPDIR");if(!d)d=const_cast<char*>("/tmp");return std::string(d)+"/alia-can-test-cli";}
+static int runCli(std::vector<std::string> args,std::string& out){std::ostringstream o,e;args.insert(args.begin(),{"--shell","bash","--config",cliTestFile(),"--no-backup"});int rc=Cli::run(args,o,e);out=o.str();return rc;}
+static void testIsCliInvocation(){const char* gui[]={"alia-can"};const char* list[]={"alia-can","--config","/x","list"};const char* other[]={"alia-can","-style","fusion"};assert(!Cli::isCliInvocation(1,const_cast<char**>(gui)));assert(Cli::isCliInvocation(4,const_cast<char**>(list)));assert(!Cli::isCliInvocation(3,const_cast<char**>(other)));}
+static void testJsonString(){assert(Cli::jsonString("a\"b\\c\n")=="\"a\\\"b\\\\c\\n\"");assert(Cli::jsonString(std::string(1,'\x01'))=="\"\\u0001\"");}
+static void testAddListRemove(){fs::remove(cliTestFile());std::ofstream(cliTestFile())<<"export A=1\n";std::string out;assert(runCli({"add","ll","ls -la"},out)==0);assert(out=="{\"ok\":true,\"changed\":1}\n");assert(runCli({"add","ll","ls -la"},out)==0&&out=="{\"ok\":true,\"changed\":0}\n");assert(runCli({"add","bad name","x"},out)==1);assert(out.find("\"ok\":false")!=std::string::npos);assert(runCli({"--format","tsv","list"},out)==0);assert(out=="ll\tls -la\n");assert(runCli({"list"},out)==0);assert(out.find("{\"name\":\"ll\",\"command\":\"ls -la\",\"line\":2,\"file\":")!=std::string::npos);assert(runCli({"rm","ll","gs"},out)==1);assert(runCli({"rm","ll"},out)==0);assert(runCli({"--format","tsv","list"},out)==0&&out.empty());assert(runCli({"rm"},out)==2);}
+static void testImport(){fs::remove(cliTestFile());std::ofstream(cliTestFile())<<"";std::string preset=cliTestFile()+"-preset";std::ofstream(preset)<<"alias gs='git status'\nexport X=1\nalias gd='git diff'\n";std::string out;assert(runCli({"import",preset},out)==0);assert(out=="{\"ok\":true,\"changed\":2}\n");assert(runCli({"--format","tsv","list"},out)==0&&out=="gs\tgit status\ngd\tgit diff\n");fs::remove(preset);fs::remove(cliTestFile());}
+static void testCheck(){fs::remove(cliTestFile());std::ofstream(cliTestFile())<<"alias hi='echo hi'\nalias zq='alia-can-no-such-tool -x'\n";std::string out;assert(runCli({"--format","tsv","check"},out)==0);assert(out=="zq\tmissing\talia-can-no-such-tool\n");assert(runCli({"check"},out)==0);assert(out.starts_with("{\"checked\":2,\"aliases\":[{\"name\":\"zq\",\"status\":\"missing\""));assert(runCli({"check","x"},out)==2);fs::remove(cliTestFile());}
+static void testSyntaxRejected(){fs::remove(cliTestFile());std::ofstream(cliTestFile())<<"";std::string out;assert(runCli({"add","q","echo \"open"},out)==1);assert(out.find("Syntax error in alias q")!=std::string::npos);std::string preset=cliTestFile()+"-preset";std::ofstream(preset)<<"alias ok='ls'\nalias broken='ls |'\n";assert(runCli({"import",preset},out)==1&&out.find("alias broken")!=std::string::npos);assert(runCli({"--format","tsv","list"},out)==0&&out.empty());fs::remove(preset);fs::remove(cliTestFile());}
+static void testUsage(){fs::remove(cliTestFile());std::ofstream(cliTestFile())<<"alias gs='git status'\nalias gd='git diff'\nalias ll='ls -la'\n";std::string history=cliTestFile()+"-history";std::ofstream(history)<<"#1700000000\nll\ngd HEAD\n#1700000500\ngd\n";std::string out;assert(runCli({"--format","tsv","usage",history},out)==0);assert(out=="gd\t2\t1700000500\nll\t1\t1700000000\ngs\t0\t0\n");assert(runCli({"usage",history},out)==0);assert(out.find("\"aliases\":[{\"name\":\"gd\",\"count\":2,\"last_used\":1700000500}")!=std::string::npos);assert(runCli({"usage","a","b"},out)==2);fs::remove(history);fs::remove(cliTestFile());}
+static void testSuggest(){fs::remove(cliTestFile());std::ofstream(cliTestFile())<<"alias ll='ls -la'\n";std::string history=cliTestFile()+"-history";{std::ofstream h(history);for(int i=0;i<4;++i)h<<"ll\nalia-can-deploy --env staging --verbose\n";}std::string out;assert(runCli({"--format","tsv","suggest",history},out)==0);assert(out=="aesv\talia-can-deploy --env staging --verbose\t4\n");assert(runCli({"suggest",history},out)==0);assert(out.find("\"suggestions\":[{\"name\":\"aesv\",\"command\":\"alia-can-deploy --env staging --verbose\",\"count\":4}]")!=std::string::npos);assert(runCli({"suggest","a","b"},out)==2);fs::remove(history);fs::remove(cliTestFile());}
+static void testFleetJobs(){std::string out;for(const char* jobs:{"abc","0","-1","4x",""})assert(runCli({"fleet","--jobs",jobs,"/nonexistent"},out)==2);assert(runCli({"fleet","--jobs","99999","/nonexistent"},out)==1);}
+void test_cli(){std::cout<<"Running CLI tests...\n";testIsCliInvocation();testJsonString();testAddListRemove();testImport();testCheck();testSyntaxRejected();testUsage();testSuggest();testFleetJobs();std::cout<<"✓ CLI tests passed!\n";}
@@ -1,10 +1,15 @@
 #include "configfilehandler.hpp"
 #include "backupmanager.hpp"
+#include "linedelta.hpp"
+#include "compression.hpp"
 #include <cassert>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
 #include <cstdlib>
+#include <chrono>
+#include <limits>
+#include <thread>
 namespace fs=std::filesystem;
 static std::string getTempTestFile(){char* d=getenv("TMPDIR");if(!d)d=const_cast<char*>("/tmp");return std::string(d)+"/alia-can-test-config";}
 static void cleanupTestFile(){std::string f=getTempTestFile();if(fs::exists(f))fs::remove(f);for(const auto&e:fs::directory_iterator(fs::path(f).parent_path())){auto n=e.path().filename().string();if(n.find("alia-can-test-config")!=std::string::npos){try{fs::remove(e.path());}catch(...){} }}}
@@ -15,4 +20,23 @@ static void testMultipleAliases(){cleanupTestFile();ConfigFileHandler h(getTempT
 static void testValidationOnAdd(){cleanupTestFile();ConfigFileHandler h(getTempTestFile(),ShellDetector::Shell::BASH);assert(!h.addAlias({"bad name","ls"}));assert(!h.addAlias({"ll",""}));}
 static void testBackupCreation(){cleanupTestFile();std::string f=getTempTestFile();ConfigFileHandler h(f,ShellDetector::Shell::BASH);BackupManager b(f);h.addAlias({"ll","ls -la"});std::string p=b.createBackup();assert(!p.empty());assert(fs::exists(p));}
 static void testRestoreBackup(){cleanupTestFile();std::string f=getTempTestFile();ConfigFileHandler h(f,ShellDetector::Shell::BASH);BackupManager b(f);h.addAlias({"ll","ls -la"});std::string p=b.createBackup();h.addAlias({"gs","git status"});assert(b.restoreFromBackup(p));auto v=h.loadAliases();assert(v.size()==1);}
-void test_confighandler(){std::cout<<"Running ConfigFileHandler tests...\n";testLoadEmptyFile();testAddAlias();testRemoveAlias();testMultipleAliases();testValidationOnAdd();testBackupCreation();testRestoreBackup();cleanupTestFile();std::cout<<"✓ ConfigFileHandler tests passed!\n";}
+static std::string readFile(const std::string& f){std::ifstream in(f);return std::string(std::istreambuf_iterator<char>(in),{});}
+static void testUpdateReplacesInPlace(){cleanupTestFile();std::string f=getTempTestFile();std::ofstream(f)<<"export A=1\nalias ll='ls'\n# keep\nalias gs='git status'";ConfigFileHandler h(f,ShellDetector::Shell::BASH);assert(h.addAlias({"ll","ls -la"}));assert(readFile(f)=="export A=1\nalias ll='ls -la'\n# keep\nalias gs='git status'");assert(h.addAlias({"gs","git status -sb"}));assert(readFile(f)=="export A=1\nalias ll='ls -la'\n# keep\nalias gs='git status -sb'");assert(h.loadAliases().size()==2);}
+static void testRemoveSplicesOnlyAliasLine(){cleanupTestFile();std::string f=getTempTestFile();std::ofstream(f)<<"# top\nalias ll='ls'\nexport B=2\nalias ll='ls -A'\nalias gs='git status'\n";ConfigFileHandler h(f,ShellDetector::Shell::BASH);assert(h.removeAlias("ll"));assert(readFile(f)=="# top\nexport B=2\nalias gs='git status'\n");assert(!h.removeAlias("ll"));assert(h.addAlias({"la","ls -A"}));assert(readFile(f)=="# top\nexport B=2\nalias gs='git status'\nalias la='ls -A'\n");}
+static void testEditMultipleDefinitionStatement(){cleanupTestFile();std::string f=getTempTestFile();std::ofstream(f)<<"  alias -- a=b c='d e' f=g # three\nalias x=1; echo done\nalias y='it'\''s'";ConfigFileHandler h(f,ShellDetector::Shell::BASH);assert(h.loadAliases().size()==5);assert(h.addAlias({"c","new"}));assert(readFile(f)=="  alias -- a=b\n  alias -- c='new'\n  alias -- f=g # three\nalias x=1; echo done\nalias y='it'\''s'");assert(h.addAlias({"x","2"}));assert(readFile(f).find("alias x='2'; echo done\n")!=std::string::npos);assert(h.addAlias({"y","it's \"q\""}));assert(readFile(f).ends_with("alias y='it'\\''s \"q\"'"));auto s=h.loadAliases();assert(s.size()==5&&s.command(s.find("y"))=="it's \"q\""&&s.command(s.find("a"))=="b");std::ofstream(f,std::ios::trunc)<<"alias a=1 b=2 # three\n";ConfigFileHandler t(f,ShellDetector::Shell::BASH);t.loadAliases();assert(t.addAlias({"a","new"}));assert(readFile(f)=="alias a='new'\nalias b=2 # three\n");std::ofstream(f,std::ios::trunc)<<"alias a=1 b=2 # three\n";ConfigFileHandler u(f,ShellDetector::Shell::BASH);u.loadAliases();assert(u.removeAlias("b"));assert(readFile(f)=="alias a=1 # three\n");}
+static void testEditFollowsSymlink(){cleanupTestFile();std::string f=getTempTestFile();std::string target=f+"-target";std::ofstream(target)<<"alias ll='ls'\n";fs::create_symlink(target,f);ConfigFileHandler h(f,ShellDetector::Shell::BASH);assert(h.addAlias({"gs","git status"}));assert(fs::is_symlink(f));assert(readFile(target)=="alias ll='ls'\nalias gs='git status'\n");}
+static void testCommitKeepsModeAndHardLinks(){cleanupTestFile();std::string f=getTempTestFile();std::string link=f+"-link";std::ofstream(f)<<"alias ll='ls -la'\n";fs::permissions(f,fs::perms::owner_read|fs::perms::owner_write);fs::remove(link);fs::create_hard_link(f,link);ConfigFileHandler h(f,ShellDetector::Shell::BASH);assert(h.addAlias({"gs","git status"}));assert((fs::status(f).permissions()&fs::perms::all)==(fs::perms::owner_read|fs::perms::owner_write));assert(fs::hard_link_count(f)==2&&readFile(link)==readFile(f)&&readFile(f).find("alias gs=")!=std::string::npos);assert(h.removeAlias("ll")&&readFile(link)=="alias gs='git status'\n");fs::remove(link);cleanupTestFile();}
+static void testTransactionCommit(){cleanupTestFile();std::string f=getTempTestFile();std::ofstream(f)<<"alias ll='ls'\nalias gs='git status'\n";ConfigFileHandler h(f,ShellDetector::Shell::BASH);BackupManager b(f);assert(h.beginTransaction(&b));assert(!h.beginTransaction());for(int i=0;i<500;++i)assert(h.stageAdd({"p"+std::to_string(i),"echo "+std::to_string(i)}));assert(h.stageUpdate({"ll","ls -la"}));assert(!h.stageUpdate({"missing","x"}));assert(h.stageRemove("gs"));assert(!h.stageRemove("gs"));assert(!h.stageAdd({"bad name","x"}));assert(readFile(f)=="alias ll='ls'\nalias gs='git status'\n");assert(h.commitTransaction());assert(!h.inTransaction());auto v=h.loadAliases();assert(v.size()==501);assert(v.command(v.find("ll"))=="ls -la");assert(!v.contains("gs"));assert(b.restoreFromBackup(b.getLastBackupPath()));assert(readFile(f)=="alias ll='ls'\nalias gs='git status'\n");}
+static void testTransactionRollback(){cleanupTestFile();std::string f=getTempTestFile();std::ofstream(f)<<"alias ll='ls'\n";ConfigFileHandler h(f,ShellDetector::Shell::BASH);assert(h.beginTransaction());assert(h.stageRemove("ll"));h.rollbackTransaction();assert(!h.commitTransaction());assert(readFile(f)=="alias ll='ls'\n");assert(h.beginTransaction());assert(h.commitTransaction());}
+static void testBackupDeduplication(){cleanupTestFile();std::string f=getTempTestFile();std::string dir=f+"-backups";fs::remove_all(dir);std::ofstream(f)<<"alias ll='ls'\n";BackupManager b(f,dir);std::string p1=b.createBackup();assert(!p1.empty());assert(b.createBackup()==p1);assert(b.listBackups().size()==1);std::ofstream(f,std::ios::app)<<"alias gs='git status'\n";std::string p2=b.createBackup();assert(p2!=p1);std::ofstream(f,std::ios::trunc)<<"alias ll='ls'\n";std::string p3=b.createBackup();assert(p3==p1);auto snaps=b.listSnapshots();assert(snaps.size()==3);assert(snaps[0].path==p1&&snaps[1].path==p2&&snaps[0].timestamp>snaps[1].timestamp);assert(b.getLastBackupPath()==p1);assert(b.restoreFromBackup(p2));assert(readFile(f)=="alias ll='ls'\nalias gs='git status'\n");for(int i=0;i<25;++i){std::ofstream(f,std::ios::app)<<"# "<<i<<"\n";b.createBackup();}auto kept=b.listSnapshots();assert(kept.size()==20);assert(!fs::exists(p2));std::string latest=readFile(f);for(const auto& snap:kept){assert(b.restoreFromBackup(snap.path));assert(readFile(f).size()==snap.size);}assert(b.restoreFromBackup(kept.front().path)&&readFile(f)==latest);fs::remove_all(dir);}
+static void testLineDelta(){std::string base="a long first line\nsecond line here\nthird line is long\nfi\n";std::string target="a long first line\nchanged\nthird line is long\nfi\nappended line\n";std::string out;std::string d=LineDelta::encode(base,target);assert(LineDelta::apply(base,d,out)&&out==target);assert(d.size()<target.size());assert(LineDelta::apply("",LineDelta::encode("","x"),out)&&out=="x");assert(LineDelta::apply(base,LineDelta::encode(base,""),out)&&out.empty());assert(!LineDelta::apply(base,"C 2 9\n",out));assert(!LineDelta::apply(base,"I 99\nabc",out));}
+static void testDeltaHistory(){cleanupTestFile();std::string f=getTempTestFile();std::string dir=f+"-backups";fs::remove_all(dir);std::string body;for(int i=0;i<2000;++i)body+="alias a"+std::to_string(i)+"='echo "+std::to_string(i)+"'\n";std::ofstream(f)<<body;BackupManager b(f,dir);b.setKeyframeInterval(8);std::vector<std::string> versions;std::vector<std::string> paths;for(int i=0;i<19;++i){std::ofstream(f,std::ios::app)<<"alias e"<<i<<"='edit'\n";versions.push_back(readFile(f));paths.push_back(b.createBackup());assert(b.getChainLength(paths.back())==(size_t)(i%8));}size_t bytes=0;for(const auto& e:fs::recursive_directory_iterator(fs::path(dir)/"objects"))if(e.is_regular_file())bytes+=e.file_size();assert(bytes<versions.back().size()*4);for(size_t i=0;i<paths.size();++i){assert(b.restoreFromBackup(paths[i]));assert(readFile(f)==versions[i]);}fs::remove_all(dir);}
+static void testCompressionRoundTrip(){std::string input;for(int i=0;i<500;++i)input+="alias c"+std::to_string(i)+"='echo compressed'\n";std::string packed,out,err;assert(Compression::compress(input,packed,Compression::Codec::XZ,3,err));assert(packed.size()<input.size());assert(Compression::detect(packed)==Compression::Codec::XZ);assert(Compression::decompress(packed,out,Compression::Codec::XZ,err)&&out==input);assert(!Compression::decompress("not xz",out,Compression::Codec::XZ,err));assert(Compression::compress("",packed,Compression::Codec::XZ,0,err)&&Compression::decompress(packed,out,Compression::Codec::XZ,err)&&out.empty());Compression::Codec c;assert(Compression::codecFromName("xz",c)&&c==Compression::Codec::XZ);assert(!Compression::codecFromName("gzip",c));}
+static void testCompressedBackups(){cleanupTestFile();std::string f=getTempTestFile();std::string dir=f+"-backups";fs::remove_all(dir);fs::create_directories(dir);std::string body;for(int i=0;i<300;++i)body+="alias z"+std::to_string(i)+"='echo "+std::to_string(i)+"'\n";std::ofstream(f)<<body;auto now=fs::file_time_type::clock::now();for(int i=0;i<12;++i){std::string legacy=dir+"/"+fs::path(f).filename().string()+".bak_"+std::to_string(i);std::ofstream(legacy)<<body<<"# legacy "<<i<<"\n";fs::last_write_time(legacy,now-std::chrono::hours(100+i));}BackupManager b(f,dir);b.setCompression(Compression::Codec::XZ,1);std::string p1=b.createBackup();std::ofstream(f,std::ios::app)<<"alias extra='true'\n";std::string p2=b.createBackup();BackupManager::waitForBackgroundWork();assert(readFile(p1).find(" xz ")!=std::string::npos);assert(fs::file_size(p1)<body.size());assert(b.getChainLength(p2)==1);assert(b.restoreFromBackup(p1)&&readFile(f)==body);assert(b.restoreFromBackup(p2)&&readFile(f)==body+"alias extra='true'\n");std::string oldest=dir+"/"+fs::path(f).filename().string()+".bak_11";assert(!fs::exists(oldest)&&fs::exists(oldest+".xz"));assert(fs::exists(oldest.substr(0,oldest.size()-3)+"_9"));auto snaps=b.listSnapshots();assert(snaps.size()==14&&snaps.back().path==oldest+".xz"&&snaps.back().codec==Compression::Codec::XZ);assert(snaps[0].path==p2&&snaps[0].codec==Compression::Codec::NONE&&snaps[1].path==p1&&snaps[1].codec==Compression::Codec::XZ);assert(b.restoreFromBackup(oldest+".xz"));assert(readFile(f)==body+"# legacy 11\n");assert(!fs::exists(oldest));for(const auto& e:fs::recursive_directory_iterator(dir))assert(e.path().filename().string().find(".tmp")==std::string::npos);std::ofstream(oldest+".xz.tmp.Ab12Cd")<<"torn";fs::remove(b.getManifestPath());assert(b.listSnapshots().size()==14);BackupManager::waitForBackgroundWork();fs::remove_all(dir);}
+static void testBackupManifest(){cleanupTestFile();std::string f=getTempTestFile();std::string dir=f+"-backups";fs::remove_all(dir);std::ofstream(f)<<"alias ll='ls'\n";BackupManager b(f,dir);b.setCompression(Compression::Codec::NONE);for(int i=0;i<5;++i){std::ofstream(f,std::ios::app)<<"alias m"<<i<<"='echo "<<i<<"'\n";b.createBackup();}std::string manifest=b.getManifestPath();assert(manifest!=dir+"/"+fs::path(f).filename().string()+".manifest");assert(fs::file_size(manifest)==BackupManifest::RECORD_SIZE*6);auto before=b.listSnapshots();assert(before.size()==5&&b.getLastBackupPath()==before.front().path);auto same=[&](const std::vector<BackupManager::Snapshot>& after){if(after.size()!=before.size())return false;for(size_t i=0;i<after.size();++i)if(after[i].path!=before[i].path||after[i].timestamp!=before[i].timestamp||after[i].sourceMtime!=before[i].sourceMtime)return false;return true;};{std::fstream m(manifest,std::ios::in|std::ios::out|std::ios::binary);m.seekp(BackupManifest::RECORD_SIZE*2+5);m.put('x');}assert(same(b.listSnapshots()));fs::remove(manifest);assert(b.getLastBackupPath()==before.front().path);assert(same(b.listSnapshots()));std::ofstream(manifest,std::ios::app)<<"torn";assert(b.getLastBackupPath()==before.front().path);assert(same(b.listSnapshots())&&fs::file_size(manifest)%BackupManifest::RECORD_SIZE==0);BackupManifest::Record r{42,7,9,Compression::Codec::XZ,BackupManifest::Kind::LEGACY,BackupManifest::Op::UPDATE,"x.bak.xz"};BackupManifest::Record d;assert(BackupManifest::decode(BackupManifest::encode(r),d)&&d.timestamp==42&&d.size==7&&d.sourceMtime==9&&d.codec==r.codec&&d.kind==r.kind&&d.op==r.op&&d.name==r.name);fs::remove_all(dir);}
+
+static void testSameNameConfigsShareBackupDirectory(){std::string root=getTempTestFile()+"-samename";fs::remove_all(root);fs::create_directories(root+"/a");fs::create_directories(root+"/b");std::string fa=root+"/a/.bashrc",fb=root+"/b/.bashrc",dir=root+"/backups";std::ofstream(fa)<<"alias a='1'\n";std::ofstream(fb)<<"alias b='2'\n";BackupManager ba(fa,dir),bb(fb,dir);ba.setMaxBackups(2);bb.setMaxBackups(2);assert(ba.getManifestPath()!=bb.getManifestPath());std::string pb=bb.createBackup();for(int i=0;i<4;++i){std::ofstream(fa,std::ios::app)<<"# "<<i<<"\n";ba.createBackup();}assert(ba.listSnapshots().size()==2&&bb.listSnapshots().size()==1);assert(bb.getLastBackupPath()==pb&&fs::exists(pb));fs::remove(bb.getManifestPath());assert(bb.listSnapshots().size()==1&&bb.restoreFromBackup(pb)&&readFile(fb)=="alias b='2'\n");fs::remove_all(root);}
+static void testRestoreKeepsModeAndIsAtomic(){cleanupTestFile();std::string f=getTempTestFile();std::string dir=f+"-backups";fs::remove_all(dir);std::ofstream(f)<<"alias ll='ls'\n";fs::permissions(f,fs::perms::owner_read|fs::perms::owner_write);BackupManager b(f,dir);b.setCompression(Compression::Codec::NONE);std::string p=b.createBackup();std::ofstream(f,std::ios::app)<<"alias gs='git status'\n";assert(b.restoreFromBackup(p)&&readFile(f)=="alias ll='ls'\n");assert((fs::status(f).permissions()&fs::perms::all)==(fs::perms::owner_read|fs::perms::owner_write));for(const auto& e:fs::directory_iterator(fs::path(f).parent_path()))assert(e.path().filename().string().find(".aliacan-")==std::string::npos||e.path().filename().string().find("alia-can-test-config")==std::string::npos);fs::remove_all(dir);cleanupTestFile();}
+static void testCollectionKeepsTemporaryObjects(){cleanupTestFile();std::string f=getTempTestFile();std::string dir=f+"-backups";fs::remove_all(dir);std::ofstream(f)<<"alias ll='ls'\n";BackupManager b(f,dir);b.setCompression(Compression::Codec::NONE);b.setMaxBackups(2);b.setKeyframeInterval(1);std::string first=b.createBackup();std::string pending=first+".tmp.Ab12Cd";std::ofstream(pending)<<"in flight";for(int i=0;i<4;++i){std::ofstream(f,std::ios::app)<<"# "<<i<<"\n";b.createBackup();}assert(!fs::exists(first)&&fs::exists(pending));fs::remove_all(dir);}
+static void testTrimKeepsConcurrentAppends(){cleanupTestFile();std::string f=getTempTestFile();std::string dir=f+"-backups";fs::remove_all(dir);std::ofstream(f)<<"alias ll='ls'\n";BackupManager b(f,dir);b.setCompression(Compression::Codec::NONE);for(int i=0;i<3;++i){std::ofstream(f,std::ios::app)<<"# "<<i<<"\n";b.createBackup();}BackupManifest m(b.getManifestPath());BackupManifest::Record late{std::numeric_limits<int64_t>::max(),1,1,Compression::Codec::NONE,BackupManifest::Kind::LEGACY,BackupManifest::Op::ADD,"late.bak"};std::thread appender;bool sawLate=true;std::vector<BackupManifest::Record> r;assert(m.rewrite([&](std::vector<BackupManifest::Record>& records){appender=std::thread([&]{assert(m.append(late));});std::this_thread::sleep_for(std::chrono::milliseconds(50));records.erase(records.begin());},[&]{m.read(r);sawLate=r.back().name=="late.bak";}));appender.join();assert(!sawLate&&r.size()==2);assert(m.read(r)&&r.size()==3&&r.back().name=="late.bak");for(const auto& e:fs::directory_iterator(dir))assert(e.path().filename().string().find(".manifest.")==std::string::npos);fs::remove_all(dir);}
+void test_confighandler(){std::cout<<"Running ConfigFileHandler tests...\n";testLoadEmptyFile();testAddAlias();testRemoveAlias();testMultipleAliases();testValidationOnAdd();testBackupCreation();testRestoreBackup();testUpdateReplacesInPlace();testRemoveSplicesOnlyAliasLine();testEditMultipleDefinitionStatement();testEditFollowsSymlink();testCommitKeepsModeAndHardLinks();testTransactionCommit();testTransactionRollback();testBackupDeduplication();testLineDelta();testDeltaHistory();testCompressionRoundTrip();testCompressedBackups();testBackupManifest();testSameNameConfigsShareBackupDirectory();testRestoreKeepsModeAndIsAtomic();testCollectionKeepsTemporaryObjects();testTrimKeepsConcurrentAppends();cleanupTestFile();std::cout<<"✓ ConfigFileHandler tests passed!\n";}
@@ -0,0 +1,24 @@
+#include "aliasscanner.hpp"
+#include "backupmanager.hpp"
+#include "configfilehandler.hpp"
+#include "fishfunctions.hpp"
+#include "fishparser.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+namespace fs=std::filesystem;
+static fs::path fishRoot(){char* d=getenv("TMPDIR");if(!d)d=const_cast<char*>("/tmp");return fs::path(d)/"alia-can-test-fish";}
+static std::string readFile(const fs::path& p){std::ifstream f(p);std::stringstream s;s<<f.rdbuf();return s.str();}
+static std::vector<Alias> scanFish(std::string_view text){return AliasScanner::scanAll(text,ShellDetector::Shell::FISH);}
+static void testFishQuoting(){auto v=scanFish("alias ll 'ls -la'\nalias gs=\"git status\"\nalias q 'it\\'s' # c\nalias e \"echo \\$HOME \\\"x\\\"\"\nalias w ls -l --color\n  alias -- dash 'a\\\\b'\nalias raw echo\\ \\x41\\t(date)\n");assert(v.size()==7);assert((v[0]==Alias{"ll","ls -la"}));assert((v[1]==Alias{"gs","git status"}));assert((v[2]==Alias{"q","it's"}));assert((v[3]==Alias{"e","echo $HOME \"x\""}));assert((v[4]==Alias{"w","ls -l --color"}));assert((v[5]==Alias{"dash","a\\b"}));assert((v[6]==Alias{"raw","echo A\t(date)"}));assert(scanFish("# alias x y\necho alias x y\nalias\nalias only\n").empty());assert((scanFish("alias a 'b'; echo c d\nalias p ls | cat\n")==std::vector<Alias>{{"a","b"},{"p","ls"}}));}
+static void testFishAbbr(){auto v=scanFish("abbr -a gco git checkout\nabbr --add --position anywhere L '| less'\nabbr gp 'git push'\nabbr -e gco\nabbr --erase x\nabbr -l\nabbr --function f name\nabbr -a --regex 'x.*' name y\nabbr -a noexp\n");assert(v.size()==3);assert((v[0]==Alias{"gco","git checkout"}));assert((v[1]==Alias{"L","| less"}));assert((v[2]==Alias{"gp","git push"}));}
+static void testFishQuoteRoundTrip(){for(std::string c:{"ls -la","it's","a\\b","$HOME \"x\"","tab\tend","","'","\\'","multi\nline"}){std::string line="alias n "+FishParser::quote(c)+"\n";auto v=scanFish(line);assert(v.size()==1&&v[0].name=="n"&&v[0].command==c);}AliasManager m(ShellDetector::Shell::FISH);assert(m.formatAlias({"ll","ls -la"})=="alias ll 'ls -la'");}
+static void testParseFunction(){Alias a=FishParser::parseFunction("function ll --wraps='ls -la' --description 'alias ll=ls -la'\n    ls -la $argv\nend\n");assert((a==Alias{"ll","ls -la"}));Alias b=FishParser::parseFunction("# saved\nfunction up -d 'alias up=cd ..; ls'\n  cd ..\n  ls\nend\n");assert((b==Alias{"up","cd ..; ls"}));assert(FishParser::parseFunction("function big\n  if test -n \"$x\"\n    echo a\n  end\nend\n").name.empty());assert(FishParser::parseFunction("set -x FOO bar\n").name.empty());for(std::string c:{"git status","echo 'it'\\''s' \"$HOME\"","grep --color=auto"}){Alias f{"n",c};assert(FishParser::parseFunction(FishFunctions::format(f))==f);}assert(FishFunctions::format({"ls","ls --color"}).find("--wraps")==std::string::npos);}
+static void testFunctionsDirectory(){fs::remove_all(fishRoot());fs::path dir=fishRoot()/"functions";fs::create_directories(dir);FishFunctions fns(dir.string());assert(FishFunctions::directoryFor((fishRoot()/"config.fish").string())==dir.string());for(int i=0;i<40;++i)assert(fns.save({"f"+std::to_string(i),"echo "+std::to_string(i)}));std::ofstream(dir/"wrong.fish")<<"function other\n  ls $argv\nend\n";std::ofstream(dir/"notes.txt")<<"function notes\n ls\nend\n";auto v=fns.load();assert(v.size()==40&&v.front().alias.name=="f0"&&v.front().path==(dir/"f0.fish").string());assert(fns.defines("f7")&&!fns.defines("other")&&!fns.defines("missing"));struct stat before;stat((dir/"f3.fish").c_str(),&before);std::ofstream(dir/"f3.fish",std::ios::trunc)<<"function f3 --description 'alias f3=echo changed'\n  echo changed $argv\nend\n";auto w=fns.load();bool seen=false;for(const auto& f:w)if(f.alias.name=="f3"){seen=true;assert(f.alias.command=="echo changed");}assert(seen&&w.size()==40);assert(fns.remove("f3")&&!fns.remove("f3")&&fns.load().size()==39);}
+static void testFishConfigHandler(){fs::remove_all(fishRoot());fs::create_directories(fishRoot()/"functions");fs::path cfg=fishRoot()/"config.fish";std::ofstream(cfg)<<"if status is-interactive\n    abbr -a gco git checkout\nend\nalias ll 'ls -l'\n";FishFunctions fns((fishRoot()/"functions").string());assert(fns.save({"fn","echo function"})&&fns.save({"ll","ls from function"}));ConfigFileHandler h(cfg.string(),ShellDetector::Shell::FISH);auto s=h.loadAliases();assert(s.size()==3);assert(s.command(s.find("ll"))=="ls -l"&&s.command(s.find("fn"))=="echo function"&&s.command(s.find("gco"))=="git checkout");assert(h.addAlias({"gco","git switch"}));assert(readFile(cfg)=="if status is-interactive\n    abbr -a gco 'git switch'\nend\nalias ll 'ls -l'\n");assert(h.addAlias({"fn","echo it's"}));assert(readFile(cfg).find("fn")==std::string::npos);assert(fns.load().size()==2);assert(h.addAlias({"new","echo new"}));assert(readFile(cfg).ends_with("alias new 'echo new'\n"));assert(h.removeAlias("ll")&&!fns.defines("ll"));assert(h.beginTransaction());assert(h.stageUpdate({"fn","echo staged"}));assert(h.stageRemove("new"));assert(!h.stageUpdate({"missing","x"}));assert(h.commitTransaction());s=h.loadAliases();assert(s.size()==2&&s.command(s.find("fn"))=="echo staged"&&!s.contains("new")&&!s.contains("ll"));assert(h.beginTransaction()&&h.stageRemove("fn")&&h.commitTransaction());assert(!fns.defines("fn")&&h.loadAliases().size()==1);fs::remove_all(fishRoot());}
+static void testFunctionEditsAreBackedUp(){fs::remove_all(fishRoot());fs::create_directories(fishRoot()/"functions");fs::path cfg=fishRoot()/"config.fish";std::ofstream(cfg)<<"alias ll 'ls -l'\n";FishFunctions fns((fishRoot()/"functions").string());assert(fns.save({"fn","echo one"})&&fns.save({"gone","echo two"}));std::string saved=readFile(fns.pathFor("gone"));std::string dir=(fishRoot()/"backups").string();ConfigFileHandler h(cfg.string(),ShellDetector::Shell::FISH);BackupManager b(cfg.string(),dir);assert(h.beginTransaction(&b)&&h.stageUpdate({"fn","echo changed"})&&h.stageRemove("gone")&&h.commitTransaction());assert(!fns.defines("gone")&&b.listBackups().empty());BackupManager fb(fns.pathFor("fn"),dir),gb(fns.pathFor("gone"),dir);assert(fb.listBackups().size()==1&&gb.listBackups().size()==1);assert(gb.restoreFromLastBackup()&&readFile(fns.pathFor("gone"))==saved);assert(fb.restoreFromLastBackup()&&fns.read("fn").command=="echo one");fs::remove_all(fishRoot());}
+void test_fish(){std::cout<<"Running fish tests...\n";testFishQuoting();testFishAbbr();testFishQuoteRoundTrip();testParseFunction();testFunctionsDirectory();testFishConfigHandler();testFunctionEditsAreBackedUp();std::cout<<"✓ fish tests passed!\n";}
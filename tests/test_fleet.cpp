@@ -0,0 +1,17 @@
+#include "configfilehandler.hpp"
+#include "fleet.hpp"
+#include "threadpool.hpp"
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+namespace fs=std::filesystem;
+static fs::path fleetRoot(){char* d=getenv("TMPDIR");if(!d)d=const_cast<char*>("/tmp");return fs::path(d)/"alia-can-test-fleet";}
+static void testParallelFor(){ThreadPool pool(4);std::atomic<size_t> sum{0};pool.parallelFor(10000,[&](size_t i){sum+=i;});assert(sum==49995000);pool.parallelFor(0,[](size_t){assert(false);});std::atomic<size_t> nested{0};pool.parallelFor(8,[&](size_t){pool.parallelFor(8,[&](size_t){++nested;});});assert(nested==64);}
+static void testReadHomeList(){std::istringstream in("/home/a\n# comment\n\n  /home/b  \r\n");auto v=Fleet::readHomeList(in);assert((v==std::vector<std::string>{"/home/a","/home/b"}));}
+static void testFleetRun(){fs::remove_all(fleetRoot());std::vector<std::string> homes;for(int i=0;i<6;++i){fs::path h=fleetRoot()/("user"+std::to_string(i));fs::create_directories(h);std::ofstream(h/".bashrc")<<"alias ll='ls'\nalias old='rm -i'\n";homes.push_back(h.string());}homes.push_back((fleetRoot()/"missing").string());fs::create_directories(fleetRoot()/"nocfg");homes.push_back((fleetRoot()/"nocfg").string());FleetOptions o;o.homes=homes;o.additions={{"gs","git status"}};o.removals={"old","absent"};o.jobs=3;FleetReport r=Fleet::run(o);assert(r.results.size()==8);assert(r.succeeded==6&&r.failed==2);assert(r.totalChanged==12&&r.totalAliases==12);for(int i=0;i<6;++i){assert(r.results[i].ok&&r.results[i].aliasCount==2);assert(!fs::is_empty(fs::path(homes[i])/".shellbackup"));}assert(r.results[6].error.find("Home directory")!=std::string::npos);assert(r.results[7].error.find("Config file")!=std::string::npos);o.homes.resize(6);r=Fleet::run(o);assert(r.succeeded==6&&r.totalChanged==0);fs::remove_all(fleetRoot());}
+static void testFleetIgnoresInvokingEnvironment(){fs::remove_all(fleetRoot());fs::path h=fleetRoot()/"users/x",other=fleetRoot()/"admin";auto put=[](const fs::path& p,const std::string& text){fs::create_directories(p.parent_path());std::ofstream(p)<<text;};put(h/".bashrc","source $XDG_CONFIG_HOME/aliases.sh\nsource $DOTFILES/d.sh\nsource ~/y.sh\n");put(h/".config/aliases.sh","alias a=mine\n");put(h/"y.sh","alias y=mine\n");put(other/"aliases.sh","alias a=admin\n");put(other/"d.sh","alias d=admin\n");put(fleetRoot()/"y.sh","alias y=admin\n");std::string savedHome=getenv("HOME")?getenv("HOME"):"";setenv("HOME",fleetRoot().c_str(),1);setenv("XDG_CONFIG_HOME",other.c_str(),1);setenv("DOTFILES",other.c_str(),1);ConfigFileHandler handler((h/".bashrc").string(),ShellDetector::Shell::BASH,h.string());auto s=handler.loadAliases();bool mine=s.size()==2&&s.command(s.find("a"))=="mine"&&s.command(s.find("y"))=="mine";FleetResult r=Fleet::processHome(h.string(),FleetOptions{});setenv("HOME",savedHome.c_str(),1);unsetenv("XDG_CONFIG_HOME");unsetenv("DOTFILES");assert(mine&&r.ok&&r.aliasCount==2);fs::remove_all(fleetRoot());}
+void test_fleet(){std::cout<<"Running Fleet tests...\n";testParallelFor();testReadHomeList();testFleetRun();testFleetIgnoresInvokingEnvironment();std::cout<<"✓ Fleet tests passed!\n";}
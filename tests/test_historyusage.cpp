@@ -0,0 +1,26 @@
+#include "historyusage.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+namespace fs=std::filesystem;
+using Shell=ShellDetector::Shell;
+static std::string historyTestDir(){char* d=getenv("TMPDIR");if(!d)d=const_cast<char*>("/tmp");return std::string(d)+"/alia-can-test-history";}
+static void testCountFormats(){HistoryUsage::Counts bash;HistoryUsage::count("gs\n#1700000100\ngs --short\nls -la\n#1700000050\nFOO=1 gd HEAD\n\n",Shell::BASH,bash);assert(bash["gs"].count==2&&bash["gs"].lastUsed==1700000100);assert(bash["ls"].count==1&&bash["ls"].lastUsed==0);assert(bash["gd"].lastUsed==1700000050);assert(bash.size()==3);
+HistoryUsage::Counts zsh;HistoryUsage::count(": 1700000000:0;gs\n: 1700000200:3;for f in *; do \\\necho $f\\\ndone\ngs -s\n: 1700000300:0;ll | less\n",Shell::ZSH,zsh);assert(zsh["gs"].count==2&&zsh["gs"].lastUsed==1700000000);assert(zsh["for"].count==1&&!zsh.contains("echo")&&!zsh.contains("done"));assert(zsh["ll"].lastUsed==1700000300);
+HistoryUsage::Counts fish;HistoryUsage::count("- cmd: gs\n  when: 1700000000\n- cmd: ll -a\n  when: 1700000500\n  paths:\n    - -a\n- cmd: gs\n  when: 1700000900\n",Shell::FISH,fish);assert(fish["gs"].count==2&&fish["gs"].lastUsed==1700000900&&fish["ll"].count==1&&fish.size()==2);}
+static void testChunkedMatchesSerial(){std::string text;for(int i=0;i<60000;++i){text+="#"+std::to_string(1700000000+i)+"\n";text+=(i%3==0?"gs":i%3==1?"ll -la":"docker ps --all --format '{{.Names}}'")+std::string("\n");}
+std::string dir=historyTestDir();fs::remove_all(dir);fs::create_directories(dir);std::ofstream(dir+"/bash_history")<<text;assert(text.size()>HistoryUsage::CHUNK_SIZE);HistoryUsage usage(Shell::BASH,dir+"/bash_history",dir+"/cache");assert(usage.update());HistoryUsage::Counts serial;HistoryUsage::count(text,Shell::BASH,serial);
+for(const auto& [word,expected]:serial){auto actual=usage.usage(word);assert(actual.count==expected.count&&actual.lastUsed==expected.lastUsed);}assert(usage.wordCount()==serial.size()&&usage.usage("gs").count==20000&&usage.usage("gs").lastUsed==1700059997);fs::remove_all(dir);}
+static void testIncrementalAndCache(){std::string dir=historyTestDir();fs::remove_all(dir);fs::create_directories(dir);std::string history=dir+"/zsh_history",cache=dir+"/cache";std::ofstream(history)<<": 1700000000:0;gs\n: 1700000001:0;ll\n";
+{HistoryUsage usage(Shell::ZSH,history,cache);assert(usage.update()&&usage.usage("gs").count==1);assert(usage.lastScannedBytes()>0);assert(usage.update()&&usage.lastScannedBytes()==0);std::ofstream(history,std::ios::app)<<": 1700000002:0;gs\n: 1700000003:0;g";assert(usage.update()&&usage.usage("gs").count==2&&usage.lastScannedBytes()==std::string(": 1700000002:0;gs\n").size());}
+{HistoryUsage reloaded(Shell::ZSH,history,cache);assert(reloaded.update()&&reloaded.lastScannedBytes()==0);assert(reloaded.usage("gs").count==2&&reloaded.usage("gs").lastUsed==1700000002&&reloaded.usage("ll").count==1);
+AliasStore store;store.insert("gs","git status");store.insert("gd","git diff");auto usages=reloaded.forAliases(store);assert(usages.size()==store.slotCount()&&usages[store.find("gs")].count==2&&usages[store.find("gd")].count==0);
+std::ofstream(history,std::ios::app)<<"s\n";assert(reloaded.update()&&reloaded.usage("gs").count==3&&reloaded.usage("gs").lastUsed==1700000003);}
+std::ofstream(history,std::ios::trunc)<<": 1700000009:0;gd\n";{HistoryUsage rewritten(Shell::ZSH,history,cache);assert(rewritten.update()&&rewritten.usage("gs").count==0&&rewritten.usage("gd").count==1);}
+{HistoryUsage other(Shell::ZSH,dir+"/other_history",cache);assert(other.update()&&other.wordCount()==0);}
+fs::remove(history);{HistoryUsage missing(Shell::ZSH,history,cache);assert(missing.update()&&missing.wordCount()==0);}fs::remove_all(dir);}
+static void testDefaultPaths(){assert(HistoryUsage::defaultHistoryPath(Shell::BASH,"/home/u")=="/home/u/.bash_history");assert(HistoryUsage::defaultHistoryPath(Shell::ZSH,"/home/u")=="/home/u/.zsh_history");assert(HistoryUsage::defaultHistoryPath(Shell::FISH,"/home/u")=="/home/u/.local/share/fish/fish_history");assert(HistoryUsage::defaultCachePath(Shell::ZSH).ends_with("/alia-can/history-zsh"));}
+void test_historyusage(){std::cout<<"Running HistoryUsage tests...\n";testCountFormats();testChunkedMatchesSerial();testIncrementalAndCache();testDefaultPaths();std::cout<<"✓ HistoryUsage tests passed!\n";}
@@ -0,0 +1,22 @@
+#include "pathindex.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+namespace fs=std::filesystem;
+static std::string pathTestDir(){char* d=getenv("TMPDIR");if(!d)d=const_cast<char*>("/tmp");return std::string(d)+"/alia-can-test-path";}
+static void touchExecutable(const std::string& path,bool executable=true){std::ofstream(path)<<"#!/bin/sh\n";chmod(path.c_str(),executable?0755:0644);}
+static void testCommandWord(){assert(PathIndex::commandWord("ls -la")=="ls");assert(PathIndex::commandWord("  FOO=1 BAR=x git log")=="git");assert(PathIndex::commandWord("\\rm -i")=="rm");assert(PathIndex::commandWord("'my tool'")=="'my");assert(PathIndex::commandWord("\"vim\" -p")=="vim");assert(PathIndex::commandWord("cd ..;ls")=="cd");assert(PathIndex::commandWord("A=1").empty()&&PathIndex::commandWord("").empty()&&PathIndex::commandWord("| x").empty());size_t end=0;assert(PathIndex::commandWord("command ls -a",&end)=="command"&&end==7);assert(PathIndex::isBuiltin("cd")&&PathIndex::isBuiltin("[[")&&!PathIndex::isBuiltin("ls"));}
+static void testIndexAndRefresh(){std::string root=pathTestDir();fs::remove_all(root);fs::create_directories(root+"/a");fs::create_directories(root+"/b");touchExecutable(root+"/a/tool");touchExecutable(root+"/b/tool");touchExecutable(root+"/b/other");touchExecutable(root+"/b/plain",false);fs::create_directories(root+"/b/subdir");
+PathIndex index(root+"/a::"+root+"/b:"+root+"/a:"+root+"/missing");index.refresh();assert(index.size()==2);assert(index.find("tool")==root+"/a/tool");assert(index.find("other")==root+"/b/other");assert(index.find("plain").empty()&&index.find("subdir").empty());
+touchExecutable(root+"/b/newtool");index.refresh();assert(index.find("newtool")==root+"/b/newtool");fs::remove(root+"/a/tool");index.refresh();assert(index.find("tool")==root+"/b/tool");
+PathIndex lazy(root+"/b");assert(lazy.check("x","nosuch").status==PathIndex::Status::OK);assert(lazy.find("other")==root+"/b/other");touchExecutable(root+"/b/later");assert(lazy.check("x","later").status==PathIndex::Status::MISSING);lazy.refresh();assert(lazy.check("x","later").status==PathIndex::Status::OK);PathIndex empty("");assert(empty.size()==0&&empty.find("ls").empty());fs::remove_all(root);}
+static void testCheck(){std::string root=pathTestDir();fs::remove_all(root);fs::create_directories(root+"/bin");touchExecutable(root+"/bin/ls");touchExecutable(root+"/bin/git");PathIndex index(root+"/bin");index.refresh();
+auto check=index.check("ls","git status");assert(check.status==PathIndex::Status::SHADOWS&&check.target==root+"/bin/ls");assert(index.check("ls","ls --color").status==PathIndex::Status::OK);assert(index.check("ls","command ls -F").status==PathIndex::Status::OK);assert(index.check("ls","/usr/bin/ls -F").status==PathIndex::Status::OK);
+check=index.check("gx","gitx --all");assert(check.status==PathIndex::Status::MISSING&&check.target=="gitx");assert(index.check("gs","git status").status==PathIndex::Status::OK);assert(index.check("up","cd ..").status==PathIndex::Status::OK);assert(index.check("v","$EDITOR").status==PathIndex::Status::OK);
+assert(index.check("t",root+"/bin/git log").status==PathIndex::Status::OK);assert(index.check("t",root+"/nope").status==PathIndex::Status::MISSING);
+AliasStore store;store.insert("gs","git status");store.insert("gss","gs -s");store.insert("bad","nosuchtool");store.insert("ls","exa");auto checks=index.checkAll(store);assert(checks.size()==store.slotCount());assert(checks[store.find("gs")].status==PathIndex::Status::OK&&checks[store.find("gss")].status==PathIndex::Status::OK);assert(checks[store.find("bad")].status==PathIndex::Status::MISSING);assert(checks[store.find("ls")].status==PathIndex::Status::SHADOWS);fs::remove_all(root);}
+void test_pathindex(){std::cout<<"Running PathIndex tests...\n";testCommandWord();testIndexAndRefresh();testCheck();std::cout<<"✓ PathIndex tests passed!\n";}
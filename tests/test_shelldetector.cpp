@@ -2,9 +2,14 @@
 #include <cassert>
 #include <iostream>
 #include <filesystem>
+#include <fstream>
+#include <string>
+#include <cstdlib>
 namespace fs=std::filesystem;
 static void testShellDetection(){auto s=ShellDetector::detectShell();std::cout<<"  Detected shell: "<<ShellDetector::getShellName(s)<<std::endl;assert(s!=ShellDetector::Shell::UNKNOWN||true);}
 static void testExpandHome(){auto e=ShellDetector::expandHome("~");assert(!e.empty());assert(e[0]!='~');}
 static void testConfigFilePath(){assert(ShellDetector::getConfigFilePath(ShellDetector::Shell::BASH).find(".bashrc")!=std::string::npos);assert(ShellDetector::getConfigFilePath(ShellDetector::Shell::ZSH).find(".zshrc")!=std::string::npos);assert(ShellDetector::getConfigFilePath(ShellDetector::Shell::FISH).find(".config/fish")!=std::string::npos);}
 static void testShellNames(){assert(ShellDetector::getShellName(ShellDetector::Shell::BASH)=="BASH");assert(ShellDetector::getShellName(ShellDetector::Shell::ZSH)=="ZSH");assert(ShellDetector::getShellName(ShellDetector::Shell::FISH)=="FISH");assert(ShellDetector::getShellName(ShellDetector::Shell::UNKNOWN)=="UNKNOWN");}
-void test_shelldetector(){std::cout<<"Running ShellDetector tests...\n";testShellDetection();testExpandHome();testConfigFilePath();testShellNames();std::cout<<"✓ ShellDetector tests passed!\n";}
+static fs::path shellTestDir(){char* d=getenv("TMPDIR");if(!d)d=const_cast<char*>("/tmp");return fs::path(d)/"alia-can-test-shell";}
+static void testDetectShellCached(){const char* oldHome=getenv("HOME");const char* oldShell=getenv("SHELL");std::string savedHome=oldHome?oldHome:"",savedShell=oldShell?oldShell:"";fs::path home=shellTestDir();fs::remove_all(home);fs::create_directories(home/".config/fish");std::ofstream(home/".zshrc")<<"";std::ofstream(home/".config/fish/config.fish")<<"";std::string cache=(home/"cache/shell").string();setenv("HOME",home.c_str(),1);unsetenv("SHELL");assert(ShellDetector::detectShellCached(cache)==ShellDetector::Shell::ZSH);std::ifstream written(cache);std::string line;std::getline(written,line);assert(line==home.string()+"\tzsh");std::ofstream(cache)<<home.string()<<"\tfish\n";assert(ShellDetector::detectShellCached(cache)==ShellDetector::Shell::FISH);fs::remove(home/".config/fish/config.fish");assert(ShellDetector::detectShellCached(cache)==ShellDetector::Shell::ZSH);std::ofstream(cache)<<"/elsewhere\tbash\n";assert(ShellDetector::detectShellCached(cache)==ShellDetector::Shell::ZSH);setenv("SHELL","/usr/bin/fish",1);assert(ShellDetector::detectShellCached(cache)==ShellDetector::Shell::FISH);setenv("HOME",savedHome.c_str(),1);if(oldShell)setenv("SHELL",savedShell.c_str(),1);else unsetenv("SHELL");fs::remove_all(home);}
+void test_shelldetector(){std::cout<<"Running ShellDetector tests...\n";testShellDetection();testExpandHome();testConfigFilePath();testShellNames();testDetectShellCached();std::cout<<"✓ ShellDetector tests passed!\n";}
@@ -0,0 +1,26 @@
+#include "backupmanager.hpp"
+#include "configfilehandler.hpp"
+#include "sourcegraph.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <sstream>
+#include <unistd.h>
+namespace fs=std::filesystem;
+static fs::path graphHome(){char* d=getenv("TMPDIR");if(!d)d=const_cast<char*>("/tmp");return fs::path(d)/"alia-can-test-graph";}
+static std::string readFile(const fs::path& p){std::ifstream f(p);std::stringstream s;s<<f.rdbuf();return s.str();}
+static void writeFile(const fs::path& p,const std::string& text){fs::create_directories(p.parent_path());std::ofstream(p)<<text;}
+static fs::path setupHome(){fs::remove_all(graphHome());fs::path h=graphHome();writeFile(h/".bashrc","alias ll='ls'\n[ -f ~/.bash_aliases ] && . ~/.bash_aliases\nexport DOT=\"$HOME/dotfiles\"\nif [ -d $DOT ]; then\n    source \"$DOT/git.sh\"\nfi\nfor f in ~/.bashrc.d/*.sh; do\n  . \"$f\"\ndone\nsource ~/missing.sh\n. $(dirname x)/y.sh\nalias gs='git status'\n");writeFile(h/".bash_aliases","alias ll='ls -la'\nalias la='ls -A'\n");writeFile(h/"dotfiles/git.sh","alias gs='git st'\nalias gp='git push'\n. ~/.bashrc\n");writeFile(h/".bashrc.d/20-b.sh","alias b=2\n");writeFile(h/".bashrc.d/10-a.sh","alias a=1\nalias b=1\n");writeFile(h/".bashrc.d/notes.txt","alias no=1\n");return h;}
+static void testGraphLoad(){fs::path h=setupHome();SourceGraph g((h/".bashrc").string(),ShellDetector::Shell::BASH);assert(g.load());auto files=g.files();assert(files.size()==5&&files[0]==(h/".bashrc").string());std::vector<std::string> order;for(const auto& d:g.definitions())order.push_back(std::string(d.name)+"@"+fs::path(files[d.file]).filename().string()+":"+std::to_string(d.line));assert((order==std::vector<std::string>{"ll@.bashrc:1","ll@.bash_aliases:1","la@.bash_aliases:2","gs@git.sh:1","gp@git.sh:2","a@10-a.sh:1","b@10-a.sh:2","b@20-b.sh:1","gs@.bashrc:12"}));SourceGraph missing((h/"none").string(),ShellDetector::Shell::BASH);assert(!missing.load()&&!missing.getLastError().empty());}
+static void testGraphFish(){fs::remove_all(graphHome());fs::path c=graphHome()/".config/fish";writeFile(c/"config.fish","alias x 'from config'\nset -gx EXTRA ~/extra\nfor f in $EXTRA/*.fish\n    if test -r $f\n        source $f\n    end\nend\n");writeFile(c/"conf.d/a.fish","alias x 'from confd'\nabbr -a y 'confd abbr'\n");writeFile(graphHome()/"extra/e.fish","alias e 'extra'\n");SourceGraph g((c/"config.fish").string(),ShellDetector::Shell::FISH);assert(g.load()&&g.files().size()==3);auto& d=g.definitions();assert(d.size()==4&&d[0].command=="from confd"&&d[2].command=="from config"&&d[3].name=="e");}
+static void testGraphStatementForms(){fs::remove_all(graphHome());fs::path h=graphHome();std::string rc="echo start; source ~/a.sh\ncommand . ~/b.sh\nls ~/c.sh\nDIR=~/d\nif true; then . $DIR/d.sh; fi\n";writeFile(h/".bashrc",rc);for(std::string n:{"a.sh","b.sh","c.sh","d/d.sh"})writeFile(h/n,"alias x=1\n");SourceGraph g((h/".bashrc").string(),ShellDetector::Shell::BASH);assert(g.load());std::vector<std::string> names;for(const auto& f:g.files())names.push_back(fs::path(f).filename().string());assert((names==std::vector<std::string>{".bashrc","a.sh","b.sh","d.sh"}));fs::remove_all(graphHome());}
+static void testEditsFollowOrigin(){fs::path h=setupHome();fs::path rc=h/".bashrc";ConfigFileHandler handler(rc.string(),ShellDetector::Shell::BASH);auto s=handler.loadAliases();assert(s.size()==6);assert(s.command(s.find("ll"))=="ls -la"&&s.origin(s.find("ll"))==fs::canonical(h/".bash_aliases").string()&&s.line(s.find("ll"))==1);assert(s.command(s.find("gs"))=="git status"&&s.origin(s.find("gs"))==rc.string());assert(s.command(s.find("b"))=="2");std::string rcBefore=readFile(rc);assert(handler.addAlias({"la","ls -Al"}));assert(readFile(h/".bash_aliases")=="alias ll='ls -la'\nalias la='ls -Al'\n"&&readFile(rc)==rcBefore);assert(handler.addAlias({"new","echo new"}));assert(readFile(rc).ends_with("alias new='echo new'\n"));assert(handler.removeAlias("ll"));assert(readFile(h/".bash_aliases")=="alias la='ls -Al'\n"&&readFile(rc).find("alias ll=")==std::string::npos);assert(handler.beginTransaction());assert(handler.stageUpdate({"gp","git push -u"}));assert(handler.stageUpdate({"b","3"}));assert(handler.stageRemove("gs"));assert(!handler.stageUpdate({"nope","x"}));assert(handler.commitTransaction());assert(readFile(h/"dotfiles/git.sh")=="alias gp='git push -u'\n. ~/.bashrc\n");assert(readFile(h/".bashrc.d/20-b.sh")=="alias b='3'\n"&&readFile(h/".bashrc.d/10-a.sh")=="alias a=1\nalias b=1\n");s=handler.loadAliases();assert(!s.contains("gs")&&s.command(s.find("b"))=="3"&&s.command(s.find("gp"))=="git push -u");fs::remove_all(graphHome());}
+static void testSourcedEditsAreBackedUp(){fs::path h=setupHome();fs::path rc=h/".bashrc";std::string dir=(graphHome()/"backups").string();std::string before=readFile(h/".bash_aliases");ConfigFileHandler handler(rc.string(),ShellDetector::Shell::BASH);BackupManager root(rc.string(),dir);assert(handler.beginTransaction(&root)&&handler.stageUpdate({"la","ls -Al"})&&handler.commitTransaction());assert(root.listBackups().empty());BackupManager sourced((h/".bash_aliases").string(),dir);assert(sourced.listBackups().size()==1&&readFile(h/".bash_aliases")!=before);assert(sourced.restoreFromLastBackup()&&readFile(h/".bash_aliases")==before);fs::remove_all(graphHome());}
+static void testSystemFilesAreOverridden(){fs::path h=setupHome();fs::path system=graphHome().string()+"-system";fs::remove_all(system);writeFile(system/"colorls.sh","alias ll='ls -l --color'\nalias la='ls -A'\n");const std::string systemText=readFile(system/"colorls.sh");fs::path rc=h/".bashrc";writeFile(rc,"alias la='mine'\nsource "+(system/"colorls.sh").string()+"\nalias gs='git status'\n");ConfigFileHandler handler(rc.string(),ShellDetector::Shell::BASH);assert(handler.addAlias({"ll","ls -la"}));assert(readFile(system/"colorls.sh")==systemText&&readFile(rc).ends_with("alias gs='git status'\nalias ll='ls -la'\n"));assert(handler.addAlias({"la","ls -Al"}));assert(readFile(rc).find("alias la='mine'")==std::string::npos&&readFile(rc).ends_with("alias la='ls -Al'\n"));auto s=handler.loadAliases();assert(s.command(s.find("ll"))=="ls -la"&&s.command(s.find("la"))=="ls -Al");assert(handler.removeAlias("ll"));assert(readFile(system/"colorls.sh")==systemText&&readFile(rc).ends_with("unalias ll 2>/dev/null\n"));s=handler.loadAliases();assert(!s.contains("ll")&&s.contains("la"));assert(handler.addAlias({"ll","ls -F"}));assert(readFile(rc).ends_with("unalias ll 2>/dev/null\nalias ll='ls -F'\n"));s=handler.loadAliases();assert(s.command(s.find("ll"))=="ls -F");if(geteuid()==0){fs::path other=h/".bash_aliases";writeFile(rc,"source ~/.bash_aliases\n");assert(chown(other.c_str(),65534,65534)==0);const std::string otherText=readFile(other);assert(handler.removeAlias("la"));assert(readFile(other)==otherText&&readFile(rc)=="source ~/.bash_aliases\nunalias la 2>/dev/null\n");}writeFile(system/"x.fish","alias x 'sys'\n");fs::path fish=h/".config/fish/config.fish";writeFile(fish,"source "+(system/"x.fish").string()+"\n");ConfigFileHandler fishHandler(fish.string(),ShellDetector::Shell::FISH);assert(fishHandler.removeAlias("x")&&readFile(fish).ends_with("\nfunctions --erase x\n")&&!fishHandler.loadAliases().contains("x"));fs::remove_all(system);fs::remove_all(graphHome());}
+static std::vector<std::string> definitionList(const SourceGraph& g){std::vector<std::string> v;for(const auto& d:g.definitions())v.push_back(std::string(d.name)+"="+std::string(d.command)+"@"+std::to_string(d.file)+":"+std::to_string(d.line));return v;}
+static void testParseCache(){fs::path h=setupHome();fs::path cachePath=graphHome()/"cache/parse-cache";std::string rc=(h/".bashrc").string();ParseCache cold(cachePath.string());assert(!cold.open()&&cold.size()==0);SourceGraph first(rc,ShellDetector::Shell::BASH);assert(first.load(&cold)&&first.cachedFileCount()==0);auto expected=definitionList(first);ParseCache warm(cachePath.string());assert(warm.open()&&warm.size()==5);SourceGraph second(rc,ShellDetector::Shell::BASH);assert(second.load(&warm)&&second.cachedFileCount()==5&&definitionList(second)==expected);ParseCache::Stamp stamp;assert(ParseCache::stampOf(rc,stamp));ParseCache::Entry entry;assert(warm.lookup(rc,stamp,entry)&&entry.aliases.size()==2&&entry.includes.size()==4);++stamp.mtime;assert(!warm.lookup(rc,stamp,entry));std::ofstream(h/".bash_aliases",std::ios::app)<<"alias fresh='yes'\n";writeFile(h/".bashrc.d/30-c.sh","alias c=3\n");ParseCache third(cachePath.string());assert(third.open());SourceGraph g3(rc,ShellDetector::Shell::BASH);assert(g3.load(&third)&&g3.files().size()==6&&g3.cachedFileCount()==4);auto v3=definitionList(g3);assert(std::find(v3.begin(),v3.end(),"fresh=yes@1:3")!=v3.end()&&std::find(v3.begin(),v3.end(),"c=3@5:1")!=v3.end());ParseCache fourth(cachePath.string());assert(fourth.open()&&fourth.size()==6);SourceGraph g4(rc,ShellDetector::Shell::BASH);assert(g4.load(&fourth)&&g4.cachedFileCount()==6&&definitionList(g4)==v3);std::string bytes=readFile(cachePath);for(size_t cut:{size_t(0),size_t(10),bytes.size()/2}){std::ofstream(cachePath,std::ios::trunc)<<bytes.substr(0,cut);ParseCache broken(cachePath.string());assert(!broken.open());SourceGraph g(rc,ShellDetector::Shell::BASH);assert(g.load(&broken)&&g.cachedFileCount()==0&&definitionList(g)==v3);}std::string garbage=bytes;for(size_t i=40;i<garbage.size();i+=7)garbage[i]=static_cast<char>(garbage[i]*31+7);std::ofstream(cachePath,std::ios::trunc)<<garbage;ParseCache scrambled(cachePath.string());scrambled.open();SourceGraph g5(rc,ShellDetector::Shell::BASH);assert(g5.load(&scrambled));fs::remove_all(graphHome());}
+static void testParseCacheFollowsEnvironment(){fs::remove_all(graphHome());fs::path h=graphHome();std::string rc=(h/".bashrc").string();writeFile(rc,"D=$ALIACAN_TEST_DOTS\nsource $D/a.sh\n");writeFile(h/"d1/a.sh","alias x=one\n");writeFile(h/"d2/a.sh","alias x=two\n");std::string cachePath=(h/"cache/parse-cache").string();auto commandWith=[&](const char* dots){if(dots)setenv("ALIACAN_TEST_DOTS",(h/dots).c_str(),1);else unsetenv("ALIACAN_TEST_DOTS");ParseCache cache(cachePath);cache.open();SourceGraph g(rc,ShellDetector::Shell::BASH);assert(g.load(&cache));return g.definitions().empty()?std::string("none"):std::string(g.definitions()[0].command)+(g.cachedFileCount()>0?"+cached":"");};assert(commandWith("d1")=="one");assert(commandWith("d1")=="one+cached");assert(commandWith("d2")=="two");assert(commandWith(nullptr)=="none");assert(commandWith("d1")=="one+cached");unsetenv("ALIACAN_TEST_DOTS");fs::remove_all(graphHome());}
+void test_sourcegraph(){std::cout<<"Running SourceGraph tests...\n";testGraphLoad();testGraphFish();testGraphStatementForms();testEditsFollowOrigin();testSourcedEditsAreBackedUp();testSystemFilesAreOverridden();testParseCache();testParseCacheFollowsEnvironment();std::cout<<"✓ SourceGraph tests passed!\n";}
@@ -0,0 +1,11 @@
+#include "startuptrace.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+static void testConsumeFlag(){char a0[]="alia-can",a1[]="--startup-trace",a2[]="-style";char* argv[]={a0,a1,a2,nullptr};int argc=3;assert(StartupTrace::consumeFlag(argc,argv));assert(argc==2&&std::strcmp(argv[1],"-style")==0&&argv[2]==nullptr);assert(!StartupTrace::consumeFlag(argc,argv)&&argc==2);}
+static void testMarksAndReport(){StartupTrace& trace=StartupTrace::instance();trace.mark("ignored");assert(!trace.isEnabled()&&trace.marks().empty());trace.start();assert(trace.isEnabled());trace.mark("ui-built");trace.mark(StartupTrace::FIRST_PAINT);assert(!trace.complete());trace.mark(StartupTrace::FIRST_PAINT);trace.mark(StartupTrace::INTERACTIVE);assert(trace.complete());
+auto marks=trace.marks();assert(marks.size()==4&&marks[0].phase=="main"&&marks[1].phase=="ui-built"&&marks[2].phase=="first-paint"&&marks[3].phase=="interactive");for(size_t i=1;i<marks.size();++i)assert(marks[i].milliseconds>=marks[i-1].milliseconds);
+std::ostringstream out;bool ok=trace.report(out);assert(ok==trace.withinBudget());std::string text=out.str();assert(text.starts_with("phase\tat_ms\tdelta_ms\n"));assert(text.find("\nui-built\t")!=std::string::npos);assert(text.find("first-paint budget\t250.0\t")!=std::string::npos&&text.find("interactive budget\t750.0\t")!=std::string::npos);}
+void test_startup(){std::cout<<"Running StartupTrace tests...\n";testConsumeFlag();testMarksAndReport();std::cout<<"✓ StartupTrace tests passed!\n";}
@@ -0,0 +1,30 @@
+#include "suggestionminer.hpp"
+#include "aliasmanager.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+namespace fs=std::filesystem;
+using Shell=ShellDetector::Shell;
+static std::string minerTestDir(){char* d=getenv("TMPDIR");if(!d)d=const_cast<char*>("/tmp");return std::string(d)+"/alia-can-test-miner";}
+static void testSpaceSaving(){SuggestionMiner::SpaceSaving sketch(3);for(int i=0;i<10;++i)sketch.add("a");for(int i=0;i<5;++i)sketch.add("b");sketch.add("c");sketch.add("d");assert(sketch.size()==3);auto top=sketch.top();assert(top[0].key=="a"&&top[0].count==10&&top[0].error==0);assert(top[1].key=="b"&&top[1].count==5);assert(top[2].key=="d"&&top[2].count==2&&top[2].error==1);
+std::mt19937 rng(7);std::map<std::string,uint64_t> exact;SuggestionMiner::SpaceSaving left(64),right(64);for(int i=0;i<40000;++i){std::string key=rng()%4==0?"hot"+std::to_string(rng()%5):"cold"+std::to_string(rng()%20000);++exact[key];(i%2?left:right).add(key);}left.merge(right);assert(left.size()<=64);
+for(const auto& counter:left.top()){assert(counter.count>=exact[counter.key]&&counter.count-counter.error<=exact[counter.key]);}auto merged=left.top();for(int h=0;h<5;++h)assert(std::any_of(merged.begin(),merged.begin()+5,[&](const auto& c){return c.key=="hot"+std::to_string(h);}));}
+static void testWordsAndNames(){auto w=SuggestionMiner::words("  git   log --oneline  --graph",3);assert(w.size()==3&&w[0]=="git"&&w[2]=="--oneline");w=SuggestionMiner::words("grep -rn 'foo bar' src | less",10);assert(w.size()==4&&w[2]=="'foo bar'");assert(SuggestionMiner::words("echo \"open",5).size()==1);assert(SuggestionMiner::words("ls $(pwd) x",5).size()==1);assert(SuggestionMiner::words("make; make install",5).size()==1);assert(SuggestionMiner::words("# comment",5).empty());
+auto none=[](std::string_view){return false;};assert(SuggestionMiner::suggestName("git log --oneline",none)=="glo");assert(SuggestionMiner::suggestName("kubectl",none)=="ku");assert(SuggestionMiner::suggestName("docker compose up -d",none)=="dcud");assert(SuggestionMiner::suggestName("git log",[](std::string_view n){return n=="gl"||n=="gl2";})=="gl3");}
+static void testMine(){std::string dir=minerTestDir();fs::remove_all(dir);fs::create_directories(dir+"/bin");std::ofstream(dir+"/bin/dcu")<<"#!/bin/sh\n";chmod((dir+"/bin/dcu").c_str(),0755);PathIndex executables(dir+"/bin");
+std::string history;for(int i=0;i<50;++i){history+="git log --oneline --graph --all\n";history+="docker compose up -d --build\n";history+="gs\n";if(i%10==0)history+="git status --short\n";history+="vim notes"+std::to_string(i)+".txt\n";}
+AliasStore aliases;aliases.insert("gs","git status --short");aliases.insert("glog","git log --oneline --graph --all --decorate");SuggestionMiner miner(Shell::BASH);auto suggestions=miner.mine(history,aliases,executables);
+assert(suggestions.size()==3);assert(suggestions[0].command=="git log --oneline --graph"&&suggestions[0].count==50&&suggestions[0].name=="glog2");assert(suggestions[1].command=="docker compose up -d"&&suggestions[1].name=="dcud");assert(suggestions[2].command=="git status"&&suggestions[2].count==5&&suggestions[2].name=="gs2");
+for(const auto& s:suggestions)assert(AliasManager::validateAliasName(s.name)&&!aliases.contains(s.name));
+SuggestionMiner::Options few;few.maxWords=3;auto short3=SuggestionMiner(Shell::BASH,few).mine(history,aliases,executables);assert(short3[0].command=="docker compose up"&&short3[0].name=="dcu2");
+std::ofstream(dir+"/history")<<history;std::vector<SuggestionMiner::Suggestion> fromFile;assert(miner.mineFile(dir+"/history",aliases,executables,fromFile)&&fromFile.size()==3);assert(miner.mineFile(dir+"/missing",aliases,executables,fromFile)&&fromFile.empty());fs::remove_all(dir);}
+static void testTopKWithLongTail(){std::mt19937 rng(3);std::string history;uint64_t kubectl=0,terraform=0;for(int line=0;line<20000;++line){unsigned pick=rng()%100;history+=": "+std::to_string(1700000000+line)+":0;";if(pick<6){history+="kubectl get pods -n production";++kubectl;}else if(pick<9){history+="terraform plan -var-file=prod.tfvars";++terraform;}else history+="tool"+std::to_string(line)+" --id "+std::to_string(rng());history+='\n';}
+PathIndex executables("");AliasStore aliases;SuggestionMiner::Options small;small.capacity=256;auto suggestions=SuggestionMiner(Shell::ZSH,small).mine(history,aliases,executables);assert(suggestions.size()==2);for(const auto& s:suggestions){uint64_t exact=s.command=="kubectl get pods -n"?kubectl:s.command=="terraform plan -var-file=prod.tfvars"?terraform:0;assert(exact>0&&s.count<=exact&&s.count>=exact/2);}assert(suggestions[0].command!=suggestions[1].command);}
+void test_suggestionminer(){std::cout<<"Running SuggestionMiner tests...\n";testSpaceSaving();testWordsAndNames();testMine();testTopKWithLongTail();std::cout<<"✓ SuggestionMiner tests passed!\n";}
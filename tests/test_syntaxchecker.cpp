@@ -0,0 +1,28 @@
+#include "syntaxchecker.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+namespace fs=std::filesystem;
+using Verdict=SyntaxChecker::Verdict;
+static void testEncodeAndClean(){assert(SyntaxChecker::encode("ls -la")=="ls -la\n");assert(SyntaxChecker::encode("a\\b\nc")=="a\\0134b\\0012c\n");assert(SyntaxChecker::encode("\xc3\xa9")=="\\0303\\0251\n");assert(SyntaxChecker::cleanMessage("bash: eval: line 7: syntax error: unexpected end of file\tbash: eval: line 7: `x'")=="syntax error: unexpected end of file");assert(SyntaxChecker::cleanMessage("(eval):2: parse error near `)'")=="parse error near `)'");assert(SyntaxChecker::cleanMessage("")=="syntax error");}
+static void testBash(){SyntaxChecker checker(ShellDetector::Shell::BASH);checker.warmUp();assert(checker.processCount()==1);
+assert(checker.check(Alias{"ll","ls -la | grep -v '^total'"}).verdict==Verdict::VALID);assert(checker.check(Alias{"q","echo \"it's\" && for f in *; do echo \"$f\"; done"}).verdict==Verdict::VALID);
+auto result=checker.check(Alias{"b","echo \"hi"});assert(result.verdict==Verdict::INVALID&&result.message.find("matching")!=std::string::npos);assert(checker.check(Alias{"p","ls |"}).verdict==Verdict::INVALID);assert(checker.check(Alias{"c","ls )"}).verdict==Verdict::INVALID);
+std::string marker=std::string(getenv("TMPDIR")?getenv("TMPDIR"):"/tmp")+"/alia-can-test-syntax-ran";fs::remove(marker);assert(checker.check(Alias{"x","touch "+marker+"; set +n; touch "+marker+"; $(touch "+marker+")"}).verdict==Verdict::VALID);assert(checker.check(Alias{"y","exit 3"}).verdict==Verdict::VALID);assert(!fs::exists(marker));
+assert(checker.check(Alias{"u","printf '\xc3\xa9\\n' \\\n  | cat"}).verdict==Verdict::VALID);
+for(int i=0;i<50;++i){assert(checker.check(Alias{"ll","ls -la"+std::string(i,'a')},SyntaxChecker::BULK_TIMEOUT).verdict==Verdict::VALID);}assert(checker.processCount()==1);}
+static void testCheckAll(){SyntaxChecker checker(ShellDetector::Shell::BASH,"",3);std::vector<Alias> aliases;for(int i=0;i<40;++i)aliases.push_back(Alias{"a"+std::to_string(i),i%7==3?"echo 'open":"git log -"+std::to_string(i)});auto results=checker.checkAll(aliases);assert(results.size()==aliases.size());for(size_t i=0;i<results.size();++i)assert(results[i].verdict==(i%7==3?Verdict::INVALID:Verdict::VALID));assert(checker.processCount()<=3);assert(checker.checkAll({}).empty());}
+static void testUnavailable(){SyntaxChecker missing(ShellDetector::Shell::BASH,"/nonexistent/alia-can-bash");auto result=missing.check(Alias{"ll","ls"});assert(result.verdict==Verdict::UNKNOWN&&!result.message.empty());assert(missing.checkAll({Alias{"a","b"}})[0].verdict==Verdict::UNKNOWN);SyntaxChecker fish(ShellDetector::Shell::FISH);assert(!fish.isSupported()&&fish.check(Alias{"ll","ls ("}).verdict==Verdict::UNKNOWN&&fish.processCount()==0);
+SyntaxChecker slow(ShellDetector::Shell::BASH);assert(slow.check(Alias{"ll","ls"},std::chrono::milliseconds(0)).verdict==Verdict::UNKNOWN);assert(slow.processCount()==0);assert(slow.check(Alias{"ll","ls"},SyntaxChecker::BULK_TIMEOUT).verdict==Verdict::VALID);}
+static std::string scratch(const std::string& name){return std::string(getenv("TMPDIR")?getenv("TMPDIR"):"/tmp")+"/alia-can-test-"+name;}
+static void writeScript(const std::string& path,const std::string& text){std::ofstream(path)<<text;fs::permissions(path,fs::perms::owner_all);}
+static void testStartupOutputIsIgnored(){std::string env=scratch("bash-env");std::ofstream(env)<<"echo from bash_env\n";setenv("BASH_ENV",env.c_str(),1);setenv("BASH_FUNC_printf%%","() { echo hijacked; }",1);SyntaxChecker checker(ShellDetector::Shell::BASH);const auto t=SyntaxChecker::BULK_TIMEOUT;bool ok=checker.check(Alias{"ll","ls -la"},t).verdict==Verdict::VALID&&checker.check(Alias{"b","echo \"hi"},t).verdict==Verdict::INVALID&&checker.check(Alias{"gs","git status"},t).verdict==Verdict::VALID;unsetenv("BASH_ENV");unsetenv("BASH_FUNC_printf%%");fs::remove(env);assert(ok);
+std::string noisy=scratch("noisy-shell");writeScript(noisy,"#!/bin/bash\necho startup\nwhile IFS= read -r line; do printf 'noise'; printf '%s 1 bash: eval: line 1: stray\\n' \"${line%% *}\"; done\n");SyntaxChecker framed(ShellDetector::Shell::BASH,noisy,1);for(int i=0;i<3;++i){auto r=framed.check(Alias{"ll","ls"},t);assert(r.verdict==Verdict::INVALID&&r.message=="stray");}fs::remove(noisy);}
+static void testKeystrokeDoesNotWaitForBulk(){std::string slow=scratch("slow-shell");writeScript(slow,"#!/bin/bash\nwhile IFS= read -r line; do sleep 0.3; printf '%s 0 \\n' \"${line%% *}\"; done\n");SyntaxChecker checker(ShellDetector::Shell::BASH,slow,1);std::vector<SyntaxChecker::Result> bulk;std::thread worker([&]{bulk=checker.checkAll({Alias{"a","1"},Alias{"b","2"},Alias{"c","3"}});});while(checker.processCount()==0)std::this_thread::yield();auto r=checker.check(Alias{"ll","ls"});assert(r.verdict==Verdict::UNKNOWN&&r.message=="syntax check timed out");worker.join();assert(bulk.size()==3);for(const auto& result:bulk)assert(result.verdict==Verdict::VALID);fs::remove(slow);}
+static void testZsh(){if(std::system("command -v zsh >/dev/null 2>&1")!=0){std::cout<<"  zsh not installed, skipped\n";return;}SyntaxChecker checker(ShellDetector::Shell::ZSH);const auto t=SyntaxChecker::BULK_TIMEOUT;assert(checker.check(Alias{"ll","ls -la | grep -v '^total'"},t).verdict==Verdict::VALID);assert(checker.check(Alias{"g","noglob git log --format='%h %s'"},t).verdict==Verdict::VALID);assert(checker.check(Alias{"b","echo \"hi"},t).verdict==Verdict::INVALID);assert(checker.check(Alias{"p","ls |"},t).verdict==Verdict::INVALID);std::string marker=scratch("zsh-ran");fs::remove(marker);assert(checker.check(Alias{"x","touch "+marker+"; setopt exec; touch "+marker},t).verdict==Verdict::VALID);assert(!fs::exists(marker));assert(checker.check(Alias{"u","printf '\xc3\xa9\\n' \\\n  | cat"},t).verdict==Verdict::VALID);assert(checker.processCount()==1);}
+void test_syntaxchecker(){std::cout<<"Running SyntaxChecker tests...\n";testEncodeAndClean();testBash();testCheckAll();testUnavailable();testStartupOutputIsIgnored();testKeystrokeDoesNotWaitForBulk();testZsh();std::cout<<"✓ SyntaxChecker tests passed!\n";}
@@ -0,0 +1,16 @@
+#include "trace.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+// Background work left over from other tests may record spans too; only ours are checked.
+static std::vector<Trace::Event> ours(){std::vector<Trace::Event> events;for(const auto& e:Trace::instance().snapshot())if(std::strncmp(e.name,"test::",6)==0)events.push_back(e);return events;}
+static void testSpansAndSummary(){Trace& t=Trace::instance();t.clear();{TRACE_SCOPE(a,"test::outer");TRACE_ARG(a,"items",42);{TRACE_SCOPE(b,"test::inner");}{TRACE_SCOPE(c,"test::inner");}}auto events=ours();assert(events.size()==3);assert(std::strcmp(events[0].name,"test::outer")==0&&std::strcmp(events[0].argName,"items")==0&&events[0].argValue==42);assert(events[1].start>=events[0].start&&events[1].start+events[1].duration<=events[0].start+events[0].duration);auto summary=t.summarize();std::erase_if(summary,[](const Trace::Summary& x){return !x.name.starts_with("test::");});assert(summary.size()==2&&summary[0].name=="test::inner"&&summary[0].count==2&&summary[1].count==1);assert(summary[0].maxMs>=summary[0].meanMs&&summary[0].meanMs>=0);}
+static void testWrapAround(){Trace& t=Trace::instance();t.clear();for(size_t i=0;i<Trace::CAPACITY+100;++i)t.record(Trace::Event{"test::wrap",i,1,1,"i",i});auto events=t.snapshot();assert(events.size()==Trace::CAPACITY);assert(events.front().argValue==100&&events.back().argValue==Trace::CAPACITY+99);}
+static void testConcurrentWriters(){Trace& t=Trace::instance();t.clear();std::vector<std::thread> threads;for(int w=0;w<4;++w)threads.emplace_back([]{for(int i=0;i<5000;++i){TRACE_SCOPE(s,"test::concurrent");TRACE_ARG(s,"i",i);}});size_t seen=0;for(int r=0;r<50;++r){for(const auto& e:ours()){assert(std::strcmp(e.name,"test::concurrent")==0&&e.argValue<5000&&e.thread!=0);++seen;}}for(auto& th:threads)th.join();auto events=ours();assert(!events.empty()&&events.size()<=Trace::CAPACITY);for(const auto& e:events)assert(e.argValue<5000&&std::strcmp(e.argName,"i")==0);for(size_t i=1;i<events.size();++i)assert(events[i].start>=events[i-1].start);(void)seen;}
+static void testChromeTrace(){Trace& t=Trace::instance();t.clear();t.record(Trace::Event{"load \"rc\"",1000000,2500000,3,"aliases",7});t.record(Trace::Event{"plain",2000000,500,1,nullptr,0});std::ostringstream out;out<<std::scientific;t.writeChromeTrace(out);std::string j=out.str();assert(j.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));assert(j.find("{\"name\":\"load \\\"rc\\\"\",\"cat\":\"alia-can\",\"ph\":\"X\",\"ts\":0.000,\"dur\":2500.000,")!=std::string::npos);assert(j.find(",\"tid\":3,\"args\":{\"aliases\":7}}")!=std::string::npos);assert(j.find("\"name\":\"plain\",\"cat\":\"alia-can\",\"ph\":\"X\",\"ts\":1000.000,\"dur\":0.500,")!=std::string::npos);assert(j.ends_with("\n]}\n"));assert(out.flags()&std::ios::scientific);t.clear();std::ostringstream empty;t.writeChromeTrace(empty);assert(empty.str()=="{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n]}\n");}
+static void testConsumeFlag(){char a0[]="alia-can",a1[]="--trace",a2[]="out.json",a3[]="list";char* argv[]={a0,a1,a2,a3,nullptr};int argc=4;assert(Trace::consumeFlag(argc,argv)=="out.json");assert(argc==2&&std::strcmp(argv[1],"list")==0&&argv[2]==nullptr);char b0[]="alia-can",b1[]="--trace=t.json";char* argv2[]={b0,b1,nullptr};int argc2=2;assert(Trace::consumeFlag(argc2,argv2)=="t.json"&&argc2==1);assert(Trace::consumeFlag(argc2,argv2).empty());}
+void test_trace(){std::cout<<"Running Trace tests...\n";testSpansAndSummary();testWrapAround();testConcurrentWriters();testChromeTrace();testConsumeFlag();std::cout<<"✓ Trace tests passed!\n";}